@@ -28,8 +28,8 @@ void nsleep(long ns) {
 
 int main(int argc, char* argv[]) {
     FILE* fp;
-    const char * name = "/dev/shm/powerBalloon.txt";
-    const char * nameMax = "/dev/shm/powerBalloonMax.txt";
+    char name[4096], nameMax[4096];
+    const char * root = "";
     int ret;
     int maxthreads;
     int level = 0;
@@ -42,10 +42,17 @@ int main(int argc, char* argv[]) {
     int i, j, k;
     int n;
 
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <max threads>\n", argv[0]);
+    if (argc < 2 || argc > 4) {
+        fprintf(stderr, "Usage: %s <max threads> [system root, e.g., the FakeSysfs root, or /] [package]\n", argv[0]);
         exit(-1);
     }
+    if (argc >= 3) {
+        root = argv[2];
+    }
+    //the balloon of one package; run it on the CPUs of that package (e.g., with numactl)
+    const char * package = (argc == 4) ? argv[3] : "";
+    snprintf(name, sizeof (name), "%s/dev/shm/powerBalloon%s.txt", root, package);
+    snprintf(nameMax, sizeof (nameMax), "%s/dev/shm/powerBalloonMax%s.txt", root, package);
 
     maxthreads = atoi(argv[1]);
     fp = fopen(nameMax, "w");
@@ -0,0 +1,556 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   Benchmark.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * Microbenchmarks for the operations Maya performs every period: Vector and
+ * Matrix arithmetic, random numbers, the Kalman filters, the robust and MPC
+ * controllers, the controller bank, the system identification, the mask
+ * generators, ports, wires and the sensors and inputs. Each benchmark is
+ * repeated (doubling the count) until it runs for at least the target time,
+ * and is reported in ns/op, heap allocations/op and heap bytes/op.
+ * Allocations are counted by replacing the global operator new.
+ *
+ * The sensors and inputs are only measured when a system root is given:
+ * --sysroot / for the real system (needs root), or the directory of a running
+ * FakeSysfs to measure Maya's side of the file I/O on any machine.
+ *
+ * Usage: ./Benchmark [--filter <substring>] [--time <ms per benchmark>]
+ *                    [--sysroot <dir>] [--ctldir <dir> --ctlfile <file prefix>]
+ *                    [--plantdir <dir> --plantfile <file prefix>]
+ *
+ * The plant files are the model of the Kalman filters and the MPC controller.
+ */
+
+#include "MathSupport.h"
+#include "Abstractions.h"
+#include "Controller.h"
+#include "MPCController.h"
+#include "Estimator.h"
+#include "SystemId.h"
+#include "Planner.h"
+#include "Sensors.h"
+#include "Inputs.h"
+#include "Random.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+uint32_t samplingIntervalMS = 20; //the planners read it, like in main
+
+/*
+ * Allocation counters. Relaxed atomics, because background threads (e.g., the
+ * power sampler) may allocate too; their allocations are then counted as well.
+ */
+static std::atomic<uint64_t> numAllocs(0), numAllocBytes(0);
+
+void* operator new(std::size_t size) {
+    numAllocs.fetch_add(1, std::memory_order_relaxed);
+    numAllocBytes.fetch_add(size, std::memory_order_relaxed);
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+//results are accumulated here so that the work can't be optimized away
+volatile double sink = 0.0;
+
+class BenchmarkRunner {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    BenchmarkRunner(std::string filter, double targetMS) : filter(filter), targetNS(targetMS * 1e6) {
+    }
+
+    bool isSelected(std::string name) {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    template <typename Op>
+    void run(std::string name, Op op) {
+        if (!isSelected(name)) {
+            return;
+        }
+        op(); //warm up (first touch of files, lazily allocated buffers)
+
+        uint64_t iterations = 1;
+        double elapsedNS = 0;
+        uint64_t allocs = 0, bytes = 0;
+        while (true) {
+            auto allocsBefore = numAllocs.load(std::memory_order_relaxed);
+            auto bytesBefore = numAllocBytes.load(std::memory_order_relaxed);
+            auto begin = Clock::now();
+            for (uint64_t i = 0; i < iterations; i++) {
+                op();
+            }
+            auto end = Clock::now();
+            allocs = numAllocs.load(std::memory_order_relaxed) - allocsBefore;
+            bytes = numAllocBytes.load(std::memory_order_relaxed) - bytesBefore;
+            elapsedNS = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+            if (elapsedNS >= targetNS || iterations >= (1ULL << 40)) {
+                break;
+            }
+            iterations *= 2;
+        }
+
+        std::cout << std::left << std::setw(64) << name << std::right <<
+                std::setw(12) << iterations <<
+                std::setw(14) << std::fixed << std::setprecision(1) << elapsedNS / (double) iterations <<
+                std::setw(12) << std::setprecision(2) << (double) allocs / (double) iterations <<
+                std::setw(12) << std::setprecision(1) << (double) bytes / (double) iterations << std::endl;
+    }
+
+    void printHeader() {
+        std::cout << std::left << std::setw(64) << "benchmark" << std::right <<
+                std::setw(12) << "iterations" << std::setw(14) << "ns/op" <<
+                std::setw(12) << "allocs/op" << std::setw(12) << "B/op" << std::endl;
+    }
+
+private:
+    std::string filter;
+    double targetNS;
+};
+
+//exposes the target computation without the port write done by run()
+class BenchmarkMaskGenerator : public MaskGenerator {
+public:
+    using MaskGenerator::MaskGenerator;
+    using MaskGenerator::computeNewTargets;
+};
+
+std::map<std::string, std::string> parseArgs(int argc, char **argv) {
+    std::map<std::string, std::string> args;
+    for (auto i = 1; i < argc; i++) {
+        std::string word(argv[i]);
+        if (word.compare(0, 2, "--") != 0 || i + 1 >= argc) {
+            std::cout << "Usage: " << argv[0] << " [--filter <substring>] [--time <ms per benchmark>]"
+                    " [--sysroot <dir>] [--ctldir <dir> --ctlfile <file prefix>]" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        args[word.substr(2)] = argv[++i];
+    }
+    return args;
+}
+
+std::string getArg(std::map<std::string, std::string>& args, std::string name, std::string defaultValue) {
+    return (args.find(name) != args.end()) ? args[name] : defaultValue;
+}
+
+Vector makeVector(Vector::size_type n) {
+    Vector v(n);
+    for (Vector::size_type i = 0; i < n; i++) {
+        v[i] = 1.0 + 0.5 * i;
+    }
+    return v;
+}
+
+Matrix makeMatrix(Matrix::size_type r, Matrix::size_type c) {
+    Matrix m(r, c);
+    for (Matrix::size_type i = 0; i < r; i++) {
+        for (Matrix::size_type j = 0; j < c; j++) {
+            m[i][j] = 0.01 * (i + 1) - 0.02 * j;
+        }
+    }
+    return m;
+}
+
+void benchmarkMath(BenchmarkRunner& runner) {
+    //3 is the number of inputs and 9 the controller dimension of the default setup
+    for (auto n : {3, 9, 64}) {
+        auto a = makeVector(n), b = makeVector(n);
+        auto suffix = "/" + std::to_string(n);
+        runner.run("Vector+Vector" + suffix, [&]() {
+            auto c = a + b;
+            sink = sink + c[0];
+        });
+        runner.run("Vector*Vector" + suffix, [&]() {
+            auto c = a * b;
+            sink = sink + c[0];
+        });
+        runner.run("Vector*double" + suffix, [&]() {
+            auto c = a * 0.5;
+            sink = sink + c[0];
+        });
+        runner.run("Vector-double" + suffix, [&]() {
+            auto c = a - 5.0;
+            sink = sink + c[0];
+        });
+        runner.run("Vector copy" + suffix, [&]() {
+            Vector c(a);
+            sink = sink + c[0];
+        });
+    }
+
+    for (auto dims : std::vector<std::pair<int, int>>{{9, 9}, {3, 9}, {9, 1}, {64, 64}}) {
+        auto m = makeMatrix(dims.first, dims.second);
+        auto v = makeVector(dims.second);
+        runner.run("Matrix*Vector/" + std::to_string(dims.first) + "x" + std::to_string(dims.second), [&]() {
+            auto c = m * v;
+            sink = sink + c[0];
+        });
+    }
+}
+
+void benchmarkRandom(BenchmarkRunner& runner) {
+    auto random = newRandomStream();
+    runner.run("RandomStream::nextUInt32", [&]() {
+        sink = sink + random.nextUInt32();
+    });
+    runner.run("RandomStream::uniform", [&]() {
+        sink = sink + random.uniform(1.0, 2.0);
+    });
+    runner.run("RandomStream::uniformInt", [&]() {
+        sink = sink + random.uniformInt(12, 125);
+    });
+    runner.run("RandomStream::normal", [&]() {
+        sink = sink + random.normal(0.0, 1.0);
+    });
+    std::vector<double> values(64);
+    runner.run("RandomStream::fillNormal/64", [&]() {
+        random.fillNormal(values.data(), values.size());
+        sink = sink + values[0];
+    });
+}
+
+void benchmarkPortsAndWires(BenchmarkRunner& runner) {
+    std::vector<std::string> pinNames = {"CPUPower", "CPUFreq", "IdlePct", "PBalloon"};
+    auto src = std::make_shared<OutputPort>("src");
+    auto dst = std::make_shared<InputPort>("dst");
+    src->addPin(pinNames);
+    dst->addPin(pinNames);
+    auto values = makeVector(pinNames.size());
+    std::vector<std::string> someNames = {"CPUFreq", "PBalloon"};
+    auto someValues = makeVector(someNames.size());
+
+    runner.run("OutputPort::updateValuesToPort/4", [&]() {
+        src->updateValuesToPort(values);
+    });
+    runner.run("OutputPort::transmitValues/4", [&]() {
+        auto v = src->transmitValues();
+        sink = sink + v[0];
+    });
+    runner.run("OutputPort::transmitValues(names)/2", [&]() {
+        auto v = src->transmitValues(someNames);
+        sink = sink + v[0];
+    });
+    runner.run("InputPort::receiveValues/4", [&]() {
+        dst->receiveValues(values);
+    });
+    runner.run("InputPort::receiveValues(names)/2", [&]() {
+        dst->receiveValues(someNames, someValues);
+    });
+    runner.run("InputPort::updateValuesFromPort/4", [&]() {
+        auto v = dst->updateValuesFromPort();
+        sink = sink + v[0];
+    });
+
+    Wire fullWire(src, dst);
+    runner.run("Wire::transfer/4", [&]() {
+        fullWire.transfer();
+    });
+    //a pin can only be connected by one wire
+    auto namedDst = std::make_shared<InputPort>("namedDst");
+    namedDst->addPin(someNames);
+    Wire namedWire(src, someNames, namedDst, someNames);
+    runner.run("Wire::transfer(names)/2", [&]() {
+        namedWire.transfer();
+    });
+
+    //the same connections, compiled into a plan like the Manager does
+    auto planSrc = std::make_shared<OutputPort>("planSrc");
+    auto planDst = std::make_shared<InputPort>("planDst");
+    planSrc->addPin(pinNames);
+    planDst->addPin(pinNames);
+    WiringPlan plan;
+    plan.compile({planSrc, planDst});
+    std::vector<std::unique_ptr<Wire>> routeWires;
+    routeWires.push_back(std::make_unique<Wire>(planSrc, planDst));
+    auto route = plan.addRoute(routeWires);
+    runner.run("WiringPlan::transfer/4", [&]() {
+        plan.transfer(route);
+    });
+}
+
+void benchmarkEstimator(BenchmarkRunner& runner, std::string plantDir, std::string plantFile) {
+    for (auto timeVarying : {false, true}) {
+        auto name = std::string("KalmanFilter::run") + (timeVarying ? "/timeVarying" : "/steadyState");
+        if (!runner.isSelected(name)) {
+            continue;
+        }
+        KalmanFilter estimator("PowerEstimator", plantDir, plantFile, samplingIntervalMS * 1000, timeVarying);
+        Vector measurements(estimator.getOutputNames().size()), inputs(estimator.getInputNames().size());
+        measurements = 20.0;
+        estimator.measuredVals->receiveValues(measurements);
+        estimator.inputVals->receiveValues(inputs);
+        runner.run(name, [&]() {
+            estimator.run();
+        });
+    }
+}
+
+void benchmarkController(BenchmarkRunner& runner, std::string ctlDir, std::string ctlFile) {
+    if (!runner.isSelected("RobustController") && !runner.isSelected("Controller::run")) {
+        return;
+    }
+    //wired like the default setup: power is the output, three inputs
+    RobustController controller("MayaController", ctlDir, ctlFile, samplingIntervalMS * 1000);
+    controller.outputVals->addPin(std::vector<std::string>{"CPUPower"});
+    controller.outputTargetVals->addPin(std::vector<std::string>{"CPUPower"});
+    controller.currOutputTargetVals->addPin(std::vector<std::string>{"CPUPower"});
+    controller.currInputVals->addPin(std::vector<std::string>{"CPUFreq", "IdlePct", "PBalloon"});
+    controller.newInputVals->addPin(std::vector<std::string>{"CPUFreq", "IdlePct", "PBalloon"});
+    controller.outputVals->receiveValues(Vector({20.0}));
+    controller.outputTargetVals->receiveValues(Vector({22.0}));
+    controller.currInputVals->receiveValues(Vector({2.0e6, 8.0, 4.0}));
+
+    runner.run("RobustController::computeNewInputs", [&]() {
+        auto v = controller.computeNewInputs();
+        sink = sink + v[0];
+    });
+    runner.run("Controller::run (Robust)", [&]() {
+        controller.run();
+    });
+}
+
+void benchmarkControllerBank(BenchmarkRunner& runner, std::string ctlDir, std::string ctlFile) {
+    for (auto switching : {false, true}) {
+        auto name = std::string("ControllerBank::computeNewInputs") + (switching ? "/switching" : "/steady");
+        if (!runner.isSelected(name)) {
+            continue;
+        }
+        //two copies of the design at two frequencies; switching moves between them every period
+        ControllerBank bank("MayaController", ctlDir, {ctlFile, ctlFile}, {1.6e6, 2.2e6}, samplingIntervalMS * 1000);
+        bank.outputVals->addPin(std::vector<std::string>{"CPUPower"});
+        bank.outputTargetVals->addPin(std::vector<std::string>{"CPUPower"});
+        bank.currOutputTargetVals->addPin(std::vector<std::string>{"CPUPower"});
+        bank.currInputVals->addPin(std::vector<std::string>{"CPUFreq", "IdlePct", "PBalloon"});
+        bank.newInputVals->addPin(std::vector<std::string>{"CPUFreq", "IdlePct", "PBalloon"});
+        bank.scheduleVals->addPin(std::string("CPUFreq"));
+        bank.outputVals->receiveValues(Vector({20.0}));
+        bank.outputTargetVals->receiveValues(Vector({22.0}));
+        bank.currInputVals->receiveValues(Vector({2.0e6, 8.0, 4.0}));
+        Vector low({1.6e6}), high({2.2e6});
+        uint64_t count = 0;
+        runner.run(name, [&]() {
+            bank.scheduleVals->receiveValues((switching && (count++ % 2)) ? high : low);
+            auto v = bank.computeNewInputs();
+            sink = sink + v[0];
+        });
+    }
+}
+
+void benchmarkMPC(BenchmarkRunner& runner, std::string ctlDir, std::string ctlFile, std::string plantDir,
+        std::string plantFile) {
+    if (!runner.isSelected("MPCController")) {
+        return;
+    }
+    //the model of the simulated plant and the ranges of its inputs
+    MPCController controller("MayaController", ctlDir, ctlFile, plantDir + "/" + plantFile, samplingIntervalMS * 1000);
+    controller.outputVals->addPin(std::vector<std::string>{"CPUPower"});
+    controller.outputTargetVals->addPin(std::vector<std::string>{"CPUPower"});
+    controller.currOutputTargetVals->addPin(std::vector<std::string>{"CPUPower"});
+    controller.currInputVals->addPin(std::vector<std::string>{"CPUFreq", "IdlePct", "PBalloon"});
+    controller.newInputVals->addPin(std::vector<std::string>{"CPUFreq", "IdlePct", "PBalloon"});
+    Vector minVals(plantDir + "/" + plantFile + "_inputMin.txt"), maxVals(plantDir + "/" + plantFile + "_inputMax.txt");
+    controller.setInputLimits(minVals, maxVals);
+    controller.outputVals->receiveValues(Vector({20.0}));
+    controller.currInputVals->receiveValues(Vector({2.0e6, 8.0, 4.0}));
+
+    //alternate between two targets so that every period has something to solve
+    uint64_t count = 0;
+    runner.run("MPCController::computeNewInputs", [&]() {
+        controller.outputTargetVals->receiveValues(Vector({(count++ % 2) ? 26.0 : 18.0}));
+        auto v = controller.computeNewInputs();
+        sink = sink + v[0];
+    });
+    std::cout << "  (" << controller.getIterations() << " solver steps in the last period, "
+            << controller.getFallbacks() << " fallbacks)" << std::endl;
+}
+
+void benchmarkSystemId(BenchmarkRunner& runner) {
+    for (uint32_t lags : {1, 4}) {
+        auto name = std::string("SystemIdentifier::update/na=nb=") + std::to_string(lags);
+        if (!runner.isSelected(name)) {
+            continue;
+        }
+        SystemIdentifier systemId({"CPUPower"}, {"CPUFreq", "IdlePct", "PBalloon"}, {1.2e6, 0.0, 0.0},
+                {2.4e6, 48.0, 20.0}, {13, 13, 21}, samplingIntervalMS * 1000, lags, lags);
+        Vector outputs({20.0}), inputs({2.0e6, 8.0, 4.0});
+        systemId.outputVals->receiveValues(outputs);
+        systemId.inputVals->receiveValues(inputs);
+        runner.run(name, [&]() {
+            systemId.update();
+        });
+    }
+}
+
+void benchmarkMasks(BenchmarkRunner& runner, std::string ctlDir, std::string ctlFile) {
+    std::vector<std::pair<std::string, SignalType>> signals = {
+        {"Normal", SignalType::Normal},
+        {"Uniform", SignalType::Uniform},
+        {"Sine", SignalType::Sine},
+        {"GaussSine", SignalType::GaussSine},
+        {"Pink", SignalType::Pink},
+        {"BandNoise", SignalType::BandNoise},
+        {"MultiTone", SignalType::MultiTone}
+    };
+    for (auto& signal : signals) {
+        SignalGenerator generator(signal.second, 0.0, 30.0, 15.0, 5.0, 5.0, 1.0, 50.0);
+        runner.run("SignalGenerator::getSignalValue/" + signal.first, [&]() {
+            sink = sink + generator.getSignalValue();
+        });
+        std::vector<double> values(64);
+        runner.run("SignalGenerator::getSignalValues/" + signal.first + "/64", [&]() {
+            generator.getSignalValues(values.data(), values.size());
+            sink = sink + values[0];
+        });
+    }
+    for (auto& signal : signals) {
+        for (auto randomize : {false, true}) {
+            //without lookahead, this is the cost of generating a target; with it, the cost
+            //seen by the planner (bounded by how fast the helper thread generates them)
+            for (auto lookahead : {0u, defaultMaskLookahead}) {
+                auto name = "MaskGenerator::computeNewTargets/" + signal.first + (randomize ? "/randomized" : "") +
+                        (lookahead > 0 ? "/lookahead" : "");
+                if (!runner.isSelected(name)) {
+                    continue;
+                }
+                BenchmarkMaskGenerator mask("MayaMaskGenerator", ctlDir, ctlFile, samplingIntervalMS * 1000,
+                        signal.second, randomize, lookahead);
+                runner.run(name, [&]() {
+                    auto v = mask.computeNewTargets();
+                    sink = sink + v.size();
+                });
+            }
+        }
+    }
+    //only when the controller has a Markov model (see Tools/MarkovTrain.cpp)
+    if (std::ifstream(ctlDir + "/" + ctlFile + "_markovStates.txt")) {
+        for (auto lookahead : {0u, defaultMaskLookahead}) {
+            auto name = std::string("MaskGenerator::computeNewTargets/Markov") + (lookahead > 0 ? "/lookahead" : "");
+            if (!runner.isSelected(name)) {
+                continue;
+            }
+            BenchmarkMaskGenerator mask("MayaMaskGenerator", ctlDir, ctlFile, samplingIntervalMS * 1000,
+                    SignalType::Markov, true, lookahead);
+            runner.run(name, [&]() {
+                auto v = mask.computeNewTargets();
+                sink = sink + v.size();
+            });
+        }
+    }
+}
+
+void benchmarkSensor(BenchmarkRunner& runner, std::string name, std::function<std::unique_ptr<Sensor>() > create) {
+    if (!runner.isSelected(name)) {
+        return;
+    }
+    auto sensor = create();
+    runner.run(name + "::updateValuesFromSystem", [&]() {
+        sensor->updateValuesFromSystem();
+    });
+}
+
+//alternates between the min and max values so that every write changes the system
+void benchmarkInput(BenchmarkRunner& runner, std::string name, std::function<std::unique_ptr<Input>() > create) {
+    if (!runner.isSelected(name)) {
+        return;
+    }
+    auto input = create();
+    runner.run(name + "::updateValuesFromSystem", [&]() {
+        input->updateValuesFromSystem();
+    });
+    bool setMax = true;
+    runner.run(name + "::updateValueToSystem", [&]() {
+        if (setMax) {
+            input->setMaxValue();
+        } else {
+            input->setMinValue();
+        }
+        setMax = !setMax;
+        input->updateValueToSystem();
+    });
+    input->reset();
+    input->updateValueToSystem();
+}
+
+void benchmarkSystem(BenchmarkRunner& runner) {
+    benchmarkSensor(runner, "Time", []() {
+        return std::unique_ptr<Sensor>(new Time("Time"));
+    });
+    benchmarkSensor(runner, "CPUPower", []() {
+        return std::unique_ptr<Sensor>(new CPUPowerSensor("CPUPower"));
+    });
+    benchmarkSensor(runner, "SampledCPUPower", []() {
+        return std::unique_ptr<Sensor>(new SampledCPUPowerSensor("CPUPowerStats", "CPUPower"));
+    });
+    benchmarkInput(runner, "CPUFrequency", []() {
+        return std::unique_ptr<Input>(new CPUFrequency("CPUFreq"));
+    });
+    benchmarkInput(runner, "IdleInject", []() {
+        return std::unique_ptr<Input>(new IdleInject("IdlePct"));
+    });
+    benchmarkInput(runner, "PowerBalloon", []() {
+        return std::unique_ptr<Input>(new PowerBalloon("PBalloon"));
+    });
+}
+
+int main(int argc, char** argv) {
+    auto args = parseArgs(argc, argv);
+    BenchmarkRunner runner(getArg(args, "filter", ""), std::stod(getArg(args, "time", "200")));
+    auto ctlDir = getArg(args, "ctldir", "Controller");
+    auto ctlFile = getArg(args, "ctlfile", "mayaRobust");
+
+    runner.printHeader();
+    benchmarkMath(runner);
+    benchmarkRandom(runner);
+    benchmarkPortsAndWires(runner);
+    benchmarkEstimator(runner, getArg(args, "plantdir", "Plant"), getArg(args, "plantfile", "mayaPlant"));
+    benchmarkController(runner, ctlDir, ctlFile);
+    benchmarkControllerBank(runner, ctlDir, ctlFile);
+    benchmarkMPC(runner, ctlDir, ctlFile, getArg(args, "plantdir", "Plant"), getArg(args, "plantfile", "mayaPlant"));
+    benchmarkSystemId(runner);
+    benchmarkMasks(runner, ctlDir, ctlFile);
+
+    if (args.find("sysroot") != args.end()) {
+        Sensor::setSystemRoot(args["sysroot"]);
+        benchmarkSystem(runner);
+    } else {
+        std::cout << "Skipping the sensors and inputs; give --sysroot <dir> (e.g., of FakeSysfs) to measure them" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,557 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   FakeSysfs.c
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * A stand-in for the parts of /sys and /dev that Maya uses, so that the full
+ * Maya binary can run (and be benchmarked) on any Linux machine without
+ * privileges. Run Maya with --sysroot <root> to use the tree created here.
+ *
+ * The tree has the RAPL energy counters (powercap), the cpufreq files of every
+ * CPU with the userspace (or performance) governor, an intel_powerclamp cooling
+ * device and the power balloon files. Every update interval (1 ms by default,
+ * like RAPL), the daemon reads the frequency, idle injection and balloon level
+ * that Maya wrote, moves scaling_cur_freq to the requested frequency and
+ * advances the energy counters with a simple power model:
+ *
+ *   P = Pstatic + sum over CPUs of Ceff * f * V(f)^2 * activity * (1 - idle)
+ *
+ * where V goes linearly from vMin to vMax over the frequency range and the
+ * activity grows with the balloon level. Small Gaussian noise is added to P.
+ * The energy counters wrap around at max_energy_range_uj like the real ones.
+ *
+ * With two packages, the CPUs are split between them (topology/physical_package_id)
+ * and each package counts the power of its own CPUs, with its own noise and half
+ * the static power. Each package also has a balloon of its own
+ * (powerBalloon<package>.txt); its activity follows the higher of its own
+ * balloon and the global one.
+ *
+ * The files that only the daemon writes (energy_uj, scaling_cur_freq) are
+ * rewritten in place with fixed-width values so that readers holding the file
+ * open (e.g., SampledCPUPower) never see an empty or half-written file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#define PATH_LEN 4096 //directories
+#define NAME_LEN (PATH_LEN + 64) //a file in one of the directories
+#define MAX_ROOT_LEN (PATH_LEN - 128) //leaves room for the longest directory under the root
+#define MAX_CPUS 1024
+#define MAX_PACKAGES 2
+#define MAX_ENERGY_RANGE_UJ 262143328850ULL
+
+struct Options {
+    const char* root;
+    int cpus, packages;
+    unsigned long minFreq, maxFreq, freqStep; //kHz, like cpufreq
+    int userspace; //1 for the userspace governor, 0 for performance
+    long updateUS;
+    unsigned int seed;
+    int once;
+    double staticPower, ceff, vMin, vMax, baseActivity, noise;
+};
+
+struct State {
+    int curFreqFd[MAX_CPUS], pkgEnergyFd[MAX_PACKAGES], coreEnergyFd;
+    unsigned long curFreq[MAX_CPUS], targetFreq[MAX_CPUS];
+    int package[MAX_CPUS];
+    double pkgEnergy[MAX_PACKAGES], coreEnergy; //uJ
+    long idlePct, balloonLevel, maxBalloonLevel, pkgBalloonLevel[MAX_PACKAGES];
+    char setspeedName[MAX_CPUS][NAME_LEN], minName[MAX_CPUS][NAME_LEN], maxName[MAX_CPUS][NAME_LEN];
+    char pclampName[NAME_LEN], balloonName[NAME_LEN], pkgBalloonName[MAX_PACKAGES][NAME_LEN];
+};
+
+static volatile sig_atomic_t stop = 0;
+
+void handleSignal(int sig) {
+    (void) sig;
+    stop = 1;
+}
+
+void usage(const char* name) {
+    fprintf(stderr, "Usage: %s <root> [--cpus <n>] [--packages <1|2>] [--minfreq <kHz>] [--maxfreq <kHz>]"
+            " [--freqstep <kHz>] [--governor <userspace|performance>] [--update <us>] [--seed <n>]"
+            " [--power <static W> <W per GHz per V^2 per CPU>] [--noise <relative std dev>] [--once]\n", name);
+    exit(-1);
+}
+
+void makeDirs(const char* path) {
+    char tmp[PATH_LEN];
+    char* p;
+    snprintf(tmp, sizeof (tmp), "%s", path);
+    for (p = tmp + 1; *p; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            mkdir(tmp, 0755);
+            *p = '/';
+        }
+    }
+    if (mkdir(tmp, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Unable to create %s: %s\n", tmp, strerror(errno));
+        exit(-1);
+    }
+}
+
+void writeFile(const char* name, const char* contents) {
+    FILE* fp = fopen(name, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "Unable to write %s: %s\n", name, strerror(errno));
+        exit(-1);
+    }
+    fputs(contents, fp);
+    fclose(fp);
+}
+
+//only create files that someone else (Maya or the balloon) may already have written
+void writeFileIfMissing(const char* name, const char* contents) {
+    if (access(name, F_OK) != 0) {
+        writeFile(name, contents);
+    }
+}
+
+//fixed width, so that rewriting in place never leaves stale digits behind
+void writeValue(int fd, unsigned long long value) {
+    char buf[32];
+    int len = snprintf(buf, sizeof (buf), "%-20llu\n", value);
+    if (pwrite(fd, buf, len, 0) != len) {
+        fprintf(stderr, "Unable to update a counter: %s\n", strerror(errno));
+    }
+}
+
+int openValueFile(const char* name, unsigned long long value) {
+    int fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Unable to open %s: %s\n", name, strerror(errno));
+        exit(-1);
+    }
+    writeValue(fd, value);
+    return fd;
+}
+
+//the files written by Maya are truncated and then written, so an empty or
+//partial read leaves the previous value untouched
+void readValue(const char* name, long* value) {
+    char buf[64];
+    char* end;
+    long parsed;
+    int fd = open(name, O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    ssize_t len = read(fd, buf, sizeof (buf) - 1);
+    close(fd);
+    if (len <= 0) {
+        return;
+    }
+    buf[len] = '\0';
+    parsed = strtol(buf, &end, 10);
+    if (end != buf) {
+        *value = parsed;
+    }
+}
+
+void parseArgs(int argc, char* argv[], struct Options* opt) {
+    int i;
+    if (argc < 2 || argv[1][0] == '-') {
+        usage(argv[0]);
+    }
+    if (strlen(argv[1]) > MAX_ROOT_LEN) {
+        fprintf(stderr, "The root %s is longer than %d characters\n", argv[1], MAX_ROOT_LEN);
+        exit(-1);
+    }
+    opt->root = argv[1];
+    opt->cpus = 4;
+    opt->packages = 1;
+    opt->minFreq = 1200000;
+    opt->maxFreq = 2400000;
+    opt->freqStep = 100000;
+    opt->userspace = 1;
+    opt->updateUS = 1000;
+    opt->seed = 1;
+    opt->once = 0;
+    opt->staticPower = 5.0;
+    opt->ceff = 6.0;
+    opt->vMin = 0.7;
+    opt->vMax = 1.0;
+    opt->baseActivity = 0.3;
+    opt->noise = 0.01;
+
+    for (i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--once") == 0) {
+            opt->once = 1;
+        } else if (i + 1 >= argc) {
+            usage(argv[0]);
+        } else if (strcmp(argv[i], "--cpus") == 0) {
+            opt->cpus = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--packages") == 0) {
+            opt->packages = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--minfreq") == 0) {
+            opt->minFreq = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--maxfreq") == 0) {
+            opt->maxFreq = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--freqstep") == 0) {
+            opt->freqStep = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--governor") == 0) {
+            i++;
+            if (strcmp(argv[i], "userspace") == 0) {
+                opt->userspace = 1;
+            } else if (strcmp(argv[i], "performance") == 0) {
+                opt->userspace = 0;
+            } else {
+                usage(argv[0]);
+            }
+        } else if (strcmp(argv[i], "--update") == 0) {
+            opt->updateUS = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            opt->seed = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--power") == 0 && i + 2 < argc) {
+            opt->staticPower = atof(argv[++i]);
+            opt->ceff = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--noise") == 0) {
+            opt->noise = atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    if (opt->cpus < 1 || opt->cpus > MAX_CPUS || opt->packages < 1 || opt->packages > MAX_PACKAGES ||
+            opt->minFreq == 0 || opt->maxFreq < opt->minFreq || opt->freqStep == 0 || opt->updateUS <= 0) {
+        usage(argv[0]);
+    }
+}
+
+/* Maya finds the energy counters this way: if intel-rapl:0:0 is the core
+ * domain, it reads that alone. Otherwise, it reads both packages. So a single
+ * package gets a core subdomain and two packages get a dram subdomain, as on
+ * most servers.
+ */
+void createRapl(const struct Options* opt, struct State* st) {
+    char dir[PATH_LEN], name[NAME_LEN], contents[64];
+    int p;
+
+    for (p = 0; p < opt->packages; p++) {
+        snprintf(dir, sizeof (dir), "%s/sys/class/powercap/intel-rapl/intel-rapl:%d", opt->root, p);
+        makeDirs(dir);
+        snprintf(name, sizeof (name), "%s/name", dir);
+        snprintf(contents, sizeof (contents), "package-%d\n", p);
+        writeFile(name, contents);
+        snprintf(name, sizeof (name), "%s/max_energy_range_uj", dir);
+        snprintf(contents, sizeof (contents), "%llu\n", MAX_ENERGY_RANGE_UJ);
+        writeFile(name, contents);
+        snprintf(name, sizeof (name), "%s/energy_uj", dir);
+        st->pkgEnergy[p] = 0.0;
+        st->pkgEnergyFd[p] = openValueFile(name, 0);
+    }
+
+    snprintf(dir, sizeof (dir), "%s/sys/class/powercap/intel-rapl/intel-rapl:0/intel-rapl:0:0", opt->root);
+    makeDirs(dir);
+    snprintf(name, sizeof (name), "%s/name", dir);
+    writeFile(name, (opt->packages == 1) ? "core\n" : "dram\n");
+    snprintf(name, sizeof (name), "%s/max_energy_range_uj", dir);
+    snprintf(contents, sizeof (contents), "%llu\n", MAX_ENERGY_RANGE_UJ);
+    writeFile(name, contents);
+    snprintf(name, sizeof (name), "%s/energy_uj", dir);
+    st->coreEnergy = 0.0;
+    st->coreEnergyFd = openValueFile(name, 0);
+}
+
+void createCpufreq(const struct Options* opt, struct State* st) {
+    char dir[PATH_LEN], name[NAME_LEN], contents[64];
+    char* freqs;
+    size_t used = 0, size;
+    unsigned long f;
+    int c;
+
+    snprintf(dir, sizeof (dir), "%s/sys/devices/system/cpu", opt->root);
+    makeDirs(dir);
+    snprintf(name, sizeof (name), "%s/present", dir);
+    if (opt->cpus == 1) {
+        snprintf(contents, sizeof (contents), "0\n");
+    } else {
+        snprintf(contents, sizeof (contents), "0-%d\n", opt->cpus - 1);
+    }
+    writeFile(name, contents);
+
+    //highest first, like the kernel
+    size = ((opt->maxFreq - opt->minFreq) / opt->freqStep + 2) * 24;
+    freqs = (char*) malloc(size);
+    freqs[0] = '\0';
+    for (f = opt->maxFreq; f >= opt->minFreq && f <= opt->maxFreq; f -= opt->freqStep) {
+        used += snprintf(freqs + used, size - used, "%lu ", f);
+    }
+    snprintf(freqs + used, size - used, "\n");
+
+    for (c = 0; c < opt->cpus; c++) {
+        //the first CPUs are in package 0, the rest in package 1
+        st->package[c] = c * opt->packages / opt->cpus;
+        snprintf(dir, sizeof (dir), "%s/sys/devices/system/cpu/cpu%d/topology", opt->root, c);
+        makeDirs(dir);
+        snprintf(name, sizeof (name), "%s/physical_package_id", dir);
+        snprintf(contents, sizeof (contents), "%d\n", st->package[c]);
+        writeFile(name, contents);
+
+        snprintf(dir, sizeof (dir), "%s/sys/devices/system/cpu/cpu%d/cpufreq", opt->root, c);
+        makeDirs(dir);
+
+        snprintf(name, sizeof (name), "%s/cpuinfo_min_freq", dir);
+        snprintf(contents, sizeof (contents), "%lu\n", opt->minFreq);
+        writeFile(name, contents);
+        snprintf(name, sizeof (name), "%s/cpuinfo_max_freq", dir);
+        snprintf(contents, sizeof (contents), "%lu\n", opt->maxFreq);
+        writeFile(name, contents);
+        snprintf(name, sizeof (name), "%s/scaling_available_frequencies", dir);
+        writeFile(name, freqs);
+        snprintf(name, sizeof (name), "%s/scaling_governor", dir);
+        writeFile(name, opt->userspace ? "userspace\n" : "performance\n");
+
+        snprintf(contents, sizeof (contents), "%lu\n", opt->maxFreq);
+        snprintf(st->setspeedName[c], NAME_LEN, "%s/scaling_setspeed", dir);
+        writeFile(st->setspeedName[c], opt->userspace ? contents : "<unsupported>\n");
+        snprintf(st->maxName[c], NAME_LEN, "%s/scaling_max_freq", dir);
+        writeFile(st->maxName[c], contents);
+        snprintf(st->minName[c], NAME_LEN, "%s/scaling_min_freq", dir);
+        snprintf(contents, sizeof (contents), "%lu\n", opt->userspace ? opt->maxFreq : opt->minFreq);
+        writeFile(st->minName[c], contents);
+
+        snprintf(name, sizeof (name), "%s/scaling_cur_freq", dir);
+        st->curFreq[c] = st->targetFreq[c] = opt->maxFreq;
+        st->curFreqFd[c] = openValueFile(name, opt->maxFreq);
+    }
+    free(freqs);
+}
+
+void createPowerclamp(const struct Options* opt, struct State* st) {
+    char dir[PATH_LEN], name[NAME_LEN];
+
+    //a regular cooling device next to powerclamp, so that Maya has to search for it
+    snprintf(dir, sizeof (dir), "%s/sys/class/thermal/cooling_device0", opt->root);
+    makeDirs(dir);
+    snprintf(name, sizeof (name), "%s/type", dir);
+    writeFile(name, "Processor\n");
+    snprintf(name, sizeof (name), "%s/cur_state", dir);
+    writeFile(name, "0\n");
+    snprintf(name, sizeof (name), "%s/max_state", dir);
+    writeFile(name, "3\n");
+
+    snprintf(dir, sizeof (dir), "%s/sys/class/thermal/cooling_device1", opt->root);
+    makeDirs(dir);
+    snprintf(name, sizeof (name), "%s/type", dir);
+    writeFile(name, "intel_powerclamp\n");
+    snprintf(name, sizeof (name), "%s/max_state", dir);
+    writeFile(name, "50\n");
+    //powerclamp reads -1 while it is not injecting
+    snprintf(st->pclampName, NAME_LEN, "%s/cur_state", dir);
+    writeFile(st->pclampName, "-1\n");
+    st->idlePct = 0;
+}
+
+void createBalloon(const struct Options* opt, struct State* st) {
+    char dir[PATH_LEN], name[NAME_LEN];
+    int p;
+
+    snprintf(dir, sizeof (dir), "%s/dev/shm", opt->root);
+    makeDirs(dir);
+    snprintf(name, sizeof (name), "%s/powerBalloonMax.txt", dir);
+    writeFileIfMissing(name, "20");
+    st->maxBalloonLevel = 20;
+    readValue(name, &st->maxBalloonLevel);
+    snprintf(st->balloonName, NAME_LEN, "%s/powerBalloon.txt", dir);
+    writeFileIfMissing(st->balloonName, "0");
+    st->balloonLevel = 0;
+
+    for (p = 0; opt->packages > 1 && p < opt->packages; p++) {
+        snprintf(name, sizeof (name), "%s/powerBalloonMax%d.txt", dir, p);
+        writeFileIfMissing(name, "20");
+        snprintf(st->pkgBalloonName[p], NAME_LEN, "%s/powerBalloon%d.txt", dir, p);
+        writeFileIfMissing(st->pkgBalloonName[p], "0");
+        st->pkgBalloonLevel[p] = 0;
+    }
+}
+
+double gaussian(unsigned int* seed) {
+    double u1 = ((double) rand_r(seed) + 1.0) / ((double) RAND_MAX + 2.0);
+    double u2 = ((double) rand_r(seed) + 1.0) / ((double) RAND_MAX + 2.0);
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+//read what Maya wrote and apply it
+void readKnobs(const struct Options* opt, struct State* st) {
+    long value;
+    int c, p;
+
+    for (c = 0; c < opt->cpus; c++) {
+        if (opt->userspace) {
+            value = (long) st->targetFreq[c];
+            readValue(st->setspeedName[c], &value);
+        } else {
+            //the performance governor runs at scaling_max_freq
+            value = (long) st->targetFreq[c];
+            readValue(st->maxName[c], &value);
+        }
+        if (value < (long) opt->minFreq) {
+            value = opt->minFreq;
+        }
+        if (value > (long) opt->maxFreq) {
+            value = opt->maxFreq;
+        }
+        st->targetFreq[c] = (unsigned long) value;
+    }
+
+    value = st->idlePct;
+    readValue(st->pclampName, &value);
+    st->idlePct = (value < 0) ? 0 : ((value > 50) ? 50 : value);
+
+    value = st->balloonLevel;
+    readValue(st->balloonName, &value);
+    st->balloonLevel = (value < 0) ? 0 : ((value > st->maxBalloonLevel) ? st->maxBalloonLevel : value);
+
+    for (p = 0; opt->packages > 1 && p < opt->packages; p++) {
+        value = st->pkgBalloonLevel[p];
+        readValue(st->pkgBalloonName[p], &value);
+        st->pkgBalloonLevel[p] = (value < 0) ? 0 : ((value > st->maxBalloonLevel) ? st->maxBalloonLevel : value);
+    }
+}
+
+//core (dynamic) power of the CPUs of a package (-1 for all CPUs) in W
+double corePower(const struct Options* opt, const struct State* st, int package) {
+    double activity, busy, freqRange, v, power = 0.0;
+    long level;
+    int c;
+
+    level = st->balloonLevel;
+    if (package >= 0 && st->pkgBalloonLevel[package] > level) {
+        level = st->pkgBalloonLevel[package];
+    }
+    activity = opt->baseActivity;
+    if (st->maxBalloonLevel > 0) {
+        activity += (1.0 - opt->baseActivity) * (double) level / (double) st->maxBalloonLevel;
+    }
+    busy = activity * (1.0 - (double) st->idlePct / 100.0);
+    freqRange = (double) (opt->maxFreq - opt->minFreq);
+
+    for (c = 0; c < opt->cpus; c++) {
+        if (package >= 0 && st->package[c] != package) {
+            continue;
+        }
+        v = opt->vMax;
+        if (freqRange > 0) {
+            v = opt->vMin + (opt->vMax - opt->vMin) * (double) (st->curFreq[c] - opt->minFreq) / freqRange;
+        }
+        power += opt->ceff * ((double) st->curFreq[c] * 1e-6) * v * v * busy;
+    }
+    return power;
+}
+
+void advanceCounters(const struct Options* opt, struct State* st, double elapsedUS, unsigned int* seed) {
+    double core = 0.0, pkgCore, total;
+    int p;
+
+    for (p = 0; p < opt->packages; p++) {
+        pkgCore = corePower(opt, st, (opt->packages > 1) ? p : -1) * (1.0 + opt->noise * gaussian(seed));
+        if (pkgCore < 0) {
+            pkgCore = 0;
+        }
+        core += pkgCore;
+
+        //W * us = uJ
+        total = opt->staticPower / (double) opt->packages + pkgCore;
+        st->pkgEnergy[p] = fmod(st->pkgEnergy[p] + total * elapsedUS, (double) MAX_ENERGY_RANGE_UJ);
+        writeValue(st->pkgEnergyFd[p], (unsigned long long) st->pkgEnergy[p]);
+    }
+
+    st->coreEnergy = fmod(st->coreEnergy + core * elapsedUS, (double) MAX_ENERGY_RANGE_UJ);
+    writeValue(st->coreEnergyFd, (unsigned long long) st->coreEnergy);
+}
+
+double nowUS() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e6 + (double) ts.tv_nsec * 1e-3;
+}
+
+int main(int argc, char* argv[]) {
+    struct Options opt;
+    struct State* st;
+    struct timespec next;
+    double prevUS, currUS;
+    unsigned int seed;
+    int c;
+
+    parseArgs(argc, argv, &opt);
+    seed = opt.seed;
+    st = (struct State*) calloc(1, sizeof (struct State));
+
+    createRapl(&opt, st);
+    createCpufreq(&opt, st);
+    createPowerclamp(&opt, st);
+    createBalloon(&opt, st);
+    printf("Fake sysfs ready at %s (%d CPUs, %d package(s), %lu-%lu kHz, %s governor)\n", opt.root,
+            opt.cpus, opt.packages, opt.minFreq, opt.maxFreq, opt.userspace ? "userspace" : "performance");
+    fflush(stdout);
+    if (opt.once) {
+        return 0;
+    }
+
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+
+    prevUS = nowUS();
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!stop) {
+        next.tv_nsec += opt.updateUS * 1000L;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        //energy is accounted at the frequency that was in effect since the last update
+        currUS = nowUS();
+        advanceCounters(&opt, st, currUS - prevUS, &seed);
+        prevUS = currUS;
+
+        //a new frequency shows up in scaling_cur_freq one update later, like a real transition
+        for (c = 0; c < opt.cpus; c++) {
+            if (st->curFreq[c] != st->targetFreq[c]) {
+                st->curFreq[c] = st->targetFreq[c];
+                writeValue(st->curFreqFd[c], st->curFreq[c]);
+            }
+        }
+        readKnobs(&opt, st);
+    }
+
+    for (c = 0; c < opt.cpus; c++) {
+        close(st->curFreqFd[c]);
+    }
+    for (c = 0; c < opt.packages; c++) {
+        close(st->pkgEnergyFd[c]);
+    }
+    close(st->coreEnergyFd);
+    free(st);
+    return 0;
+}
@@ -33,6 +33,8 @@
 #include <vector>
 #include <chrono>
 #include <memory>
+#include <cstdint>
+#include <unordered_map>
 
 #include "MathSupport.h"
 
@@ -62,6 +64,13 @@ private:
     std::string name;
     double value;
     bool connected, valueUnread;
+
+    //Where the value and unread flag actually live. They point to the members 
+    //above until a WiringPlan moves them into its flat array.
+    double* valueSlot;
+    bool* unreadSlot;
+    uint32_t slotIndex;
+    friend class WiringPlan;
 };
 
 class Port {
@@ -70,7 +79,7 @@ public:
     Port(std::string portName);
 
     auto getName();
-    std::vector<std::string> getPinNames();
+    const std::vector<std::string>& getPinNames();
     auto getPinName(uint32_t pinNum);
     auto getPinNum(std::string pinName);
     auto getNumPins();
@@ -85,9 +94,15 @@ protected:
     //changed from public to protected - give access to wire only.
     virtual void setConnected(std::vector<uint32_t> pinNums) = 0;
     friend class PortInterfaceForWire;
+    friend class WiringPlan;
 
     std::string portName;
     std::vector<std::unique_ptr<Pin>> pins;
+
+    //Pin names in pin order, and pin name -> pin number (first pin wins if 
+    //a name repeats). Kept in step with pins by addPin.
+    std::vector<std::string> pinNames;
+    std::unordered_map<std::string, uint32_t> pinNumIndex;
 };
 
 class PortInterfaceForWire {
@@ -110,6 +125,7 @@ public:
 
     //module->port
     void updateValuesToPort(Vector newValues); // local->port      
+    void updateValuesToPort(const double* newValues); // one value per pin, without temporaries
 protected:
     void setConnected(std::vector<uint32_t> pinNums) override;
 };
@@ -120,6 +136,7 @@ public:
     InputPort(std::string name);
     //port->module
     Vector updateValuesFromPort(); //port->local
+    void updateValuesFromPort(double* values); //one value per pin, without temporaries
 
     //outside->port
     void receiveValues(std::vector<uint32_t> pinNums, Vector newValues);
@@ -154,12 +171,55 @@ public:
     Wire(std::shared_ptr<OutputPort> src, std::vector<std::string> srcPinNames,
             std::shared_ptr<InputPort> dst, std::vector<std::string> dstPinNames, uint32_t dly = 0);
     void transfer();
+    std::shared_ptr<OutputPort> getSrcPort();
+    std::shared_ptr<InputPort> getDestPort();
 private:
 
     std::shared_ptr<OutputPort> srcPort;
     std::shared_ptr<InputPort> destPort;
     std::vector<uint32_t> srcPinNumList, destPinNumList;
     uint32_t delay, cycles = 0;
+    friend class WiringPlan;
+};
+
+/*
+ * A WiringPlan is the compiled form of the wires that are transferred every period.
+ * compile() lays out the values of all pins of the given ports in one contiguous 
+ * array, and addRoute() turns a group of wires into a list of (source, destination) 
+ * indices into that array. transfer() then moves values with one gather/scatter loop, 
+ * without allocating or looking up names. The Port and Wire API is still used to 
+ * build the connections; modules keep reading and writing their ports as before.
+ * Pins added after compile() can't be used in a route.
+ */
+class WiringPlan {
+public:
+    void compile(std::vector<std::shared_ptr<Port>> ports);
+    uint32_t addRoute(std::vector<std::unique_ptr<Wire>>& wires); //returns the route id
+    void transfer(uint32_t route);
+    bool isCompiled();
+
+private:
+    struct PinCopy {
+        uint32_t src, dest;
+    };
+
+    struct CompiledWire {
+        uint32_t firstCopy, lastCopy; //[firstCopy, lastCopy) in copies
+        uint32_t delay, cycles;
+    };
+
+    struct Route {
+        uint32_t firstWire, lastWire; //[firstWire, lastWire) in wires
+    };
+
+    uint32_t getSlot(Port* port, uint32_t pinNum);
+
+    std::vector<double> values;
+    std::unique_ptr<bool[]> unreadFlags;
+    std::vector<PinCopy> copies;
+    std::vector<CompiledWire> wires;
+    std::vector<Route> routes;
+    bool compiled = false;
 };
 
 
@@ -0,0 +1,98 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   Calibrator.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * Finds the scaling factors of the robust controller (see RobustController):
+ * scaleInputsUp is (max - min) / 2 of every input, and scaleYmeasDown is
+ * 2 / (highest - lowest power) that the inputs can reach. The input scales only
+ * need the ranges of the inputs; the power range is measured.
+ *
+ * Power is monotonic in each input, so its extremes are at corners of the input
+ * ranges. The calibrator holds every input at its minimum, then raises one input
+ * at a time to its maximum, which gives the direction in which each input moves
+ * power. The highest and lowest power are then measured with every input at the
+ * end that raises or lowers power. Corners that were already measured are not
+ * measured again, so calibrating m inputs takes at most m + 3 settings.
+ *
+ * A setting is held until the output settles: the output is averaged over
+ * windows of a few sampling intervals, and it has settled when two
+ * consecutive averages differ by at most tolerance times the average, or by no
+ * more than the noise of the output within the window would explain. A setting
+ * that doesn't settle within maxWindows windows keeps its last average and is
+ * reported.
+ */
+
+#ifndef CALIBRATOR_H
+#define CALIBRATOR_H
+
+#include "Abstractions.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <ostream>
+
+const uint32_t defaultCalibrationWindow = 10; //sampling intervals averaged
+const double defaultCalibrationTolerance = 0.02; //relative change of the average
+const uint32_t defaultCalibrationMaxWindows = 20;
+
+class Calibrator {
+public:
+    Calibrator(std::string outputName, std::vector<std::string> inputNames, std::vector<double> inputMinVals,
+            std::vector<double> inputMaxVals, uint32_t window = defaultCalibrationWindow,
+            double tolerance = defaultCalibrationTolerance, uint32_t maxWindows = defaultCalibrationMaxWindows);
+    bool update(); //one sampling interval; true when the inputs must be moved to the next setting
+    const std::vector<bool>& getSetting(); //of each input: true at its maximum, false at its minimum
+    bool isDone();
+    void report(std::ostream& out);
+    bool writeScales(std::string fileNamePrefix); //false if the power range couldn't be measured
+    std::shared_ptr<InputPort> outputVals;
+private:
+    bool nextSetting(); //false when every needed setting has been measured
+    int findMeasured(const std::vector<bool>& setting); //-1 if not measured yet
+    double getOutputRange();
+
+    std::string outputName;
+    std::vector<std::string> inputNames;
+    std::vector<double> inputMinVals, inputMaxVals;
+    uint32_t numInputs, window, maxWindows;
+    double tolerance;
+
+    enum class Stage {
+        Base, // every input at its minimum
+        OneInput, // one input at its maximum
+        Highest,
+        Lowest,
+        Done
+    };
+    Stage stage;
+    uint32_t currInput;
+    std::vector<bool> setting;
+
+    //settings measured so far, their outputs and whether they settled
+    std::vector<std::vector<bool>> measuredSettings;
+    std::vector<double> measuredVals;
+    std::vector<bool> settled;
+    int highest, lowest; //indices of the measured corners
+
+    double windowSum, windowSum2, lastAverage;
+    uint32_t windowCount, numWindows;
+    uint64_t numPeriods;
+};
+
+#endif /* CALIBRATOR_H */
@@ -0,0 +1,176 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/*
+ * File:   Config.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * The sensors, inputs, controllers and planners that Maya uses, their periods 
+ * and their wiring are declared in an INI style configuration file. Each block 
+ * is a section named [<kind> <name>] followed by key = value lines. Lists are 
+ * separated by commas or spaces. Lines starting with # or ; are comments.
+ * 
+ *   [manager]                       samplingIntervalMS, mode, exec, workers, 
+ *                                   backend (System|Simulate|Replay), plant, trace, 
+ *                                   durationS, sysroot, seed, packages (auto|<n>)
+ *   [sensor <name>]                 type (a registered sensor type), periodUS, package, 
+ *                                   perPackage and its options
+ *   [input <name>]                  type (a registered input type), periodUS, package, 
+ *                                   perPackage and its options
+ *   [estimator <name>]              type (Kalman|SteadyStateKalman), dir, file, period
+ *   [controller <name>]             type (SSV|MPC|Bank|Dummy), outputs, inputs, dir, file, period, perPackage,
+ *                                   antiwindup (SSV, Bank), model and budget (MPC),
+ *                                   designs, points, schedule, interpolate and hysteresis (Bank)
+ *   [planner <name>]                type (a mask generator), controller, period, perPackage, 
+ *                                   randomize, lookahead, dir, file (default to the controller's)
+ *   [sysid]                         inputs, minHold, maxHold, initHold,
+ *                                   excitation (Random|PRBS|MultiLevelPRBS|Multisine), clock, 
+ *                                   levels, lowHz, highHz, amplitude, period (excitation),
+ *                                   outputs, na, nb, forgetting, model (identification)
+ *   [calibrate]                     output, inputs, dir, file, window, tolerance, maxWindows
+ * 
+ * Every block runs at its own rate. Sensors and inputs take periodUS (default: the 
+ * sampling interval). Estimators, controllers and planners take either periodUS or 
+ * period, in sampling intervals (default 1). The display and sysid run every sampling interval.
+ * 
+ * If the [sysid] section lists outputs (sensor ports or pins), an ARX model of 
+ * them is fitted to the excited inputs while Sysid runs (see SystemId.h). Its fit 
+ * is reported at the end of the run and the model is written to the plant files 
+ * with the model prefix, if one is given.
+ * 
+ * An estimator estimates the outputs of its model (see Estimator.h) from the 
+ * sensors and inputs with the same names, and every controller that uses those 
+ * outputs gets the estimates instead of the measurements.
+ * 
+ * With the Simulate backend, the sensors and inputs are backed by the plant model 
+ * (see Simulation.h) instead of being created from their types: a Time sensor 
+ * reads the virtual clock, any other sensor reads the plant output with its name 
+ * and every input drives the plant input with its name.
+ * 
+ * With the Replay backend, they are backed by a recorded trace (see Replay.h): 
+ * every sensor replays the column with its name (a Time sensor reads the virtual 
+ * clock if the trace has no such column) and so does every input until Maya 
+ * writes to it. The allowed values of a replayed input can't be read from the 
+ * system, so its section must give them with min, max and step.
+ * 
+ * On machines with several packages (sockets), a block with perPackage = true is 
+ * replicated for every package: the replica of package p is named <name>p and is 
+ * given package = p, and the names of perPackage blocks that it refers to (outputs, 
+ * inputs, controller, schedule, pinPrefix) get the same suffix. So one sensor, input, 
+ * controller and planner per package can be declared once and each package is 
+ * controlled on its own. The number of packages is read from the topology (see 
+ * Topology.h) unless [manager] packages gives it; simulated and replayed runs have 
+ * 1 unless it is given. A sensor or input given a package reads or drives only that 
+ * package (CPUPower, SampledCPUPower, CPUFrequency, PowerBalloon; IdleInject is 
+ * global). Other sections refer to the replicas by their full names.
+ * 
+ * Relative paths in a configuration file (plant, trace, sysroot, dir and model) are 
+ * relative to the directory of the file, so the file works from any directory. 
+ * Paths given on the command line are relative to the current directory.
+ * 
+ * Sensors and inputs are created by name from a registry of factories, so a new 
+ * sensor or input only needs to be registered with registerSensorType or 
+ * registerInputType to be usable from a configuration file. See Config/maya.ini.
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include "Manager.h"
+#include "Simulation.h"
+#include "Replay.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <functional>
+
+class ConfigSection {
+public:
+    ConfigSection(std::string kind, std::string name, uint32_t line);
+
+    std::string getKind();
+    std::string getName();
+    uint32_t getLine();
+
+    bool has(std::string key);
+    std::string getString(std::string key); //the key must be present
+    std::string getString(std::string key, std::string defaultValue);
+    uint32_t getUInt(std::string key, uint32_t defaultValue);
+    double getDouble(std::string key, double defaultValue);
+    bool getBool(std::string key, bool defaultValue);
+    std::vector<std::string> getList(std::string key); //empty if the key is not present
+    std::vector<uint32_t> getUIntList(std::string key);
+    std::vector<double> getDoubleList(std::string key);
+
+    void set(std::string key, std::string value);
+    void rename(std::string newName);
+
+private:
+    std::string kind, name;
+    uint32_t line;
+    std::map<std::string, std::string> values;
+};
+
+class Config {
+public:
+    Config(std::string fileName);
+    static Config fromString(std::string text, std::string sourceName);
+
+    std::vector<ConfigSection*> getSections(std::string kind);
+    ConfigSection* getSection(std::string kind); //first section of this kind, nullptr if none
+    ConfigSection& addSection(std::string kind, std::string name = "");
+    void expandPerPackage(uint32_t numPackages); //replace the perPackage sections by one replica per package
+
+private:
+    Config() = default;
+    void parse(std::istream& stream);
+    void resolvePaths(std::string dir); //make the relative paths of the file relative to its directory dir
+
+    std::string sourceName;
+    std::vector<std::unique_ptr<ConfigSection>> sections;
+};
+
+//Where sensor values come from and input values go to
+enum class Backend {
+    System,
+    Simulate,
+    Replay
+};
+
+typedef std::function<std::unique_ptr<Sensor>(ConfigSection&)> SensorFactory;
+typedef std::function<std::unique_ptr<Input>(ConfigSection&)> InputFactory;
+
+void registerSensorType(std::string type, SensorFactory factory);
+void registerInputType(std::string type, InputFactory factory);
+
+Mode getModeFromName(std::string name);
+ExecMode getExecModeFromName(std::string name);
+ControllerType getControllerTypeFromName(std::string name);
+EstimatorType getEstimatorTypeFromName(std::string name);
+MaskGenType getMaskGenTypeFromName(std::string name);
+ExcitationType getExcitationTypeFromName(std::string name);
+Backend getBackendFromName(std::string name);
+
+//Add every block declared in the config to the manager, in the order sensors, 
+//inputs, estimators, controllers, planners. Sysid parameters are added only in Sysid 
+//mode, the calibrator only in Calibrate mode, and estimators, controllers and planners only in Mask mode. With a plant, sensors and inputs 
+//are simulated, and with a trace, they are replayed.
+void populateManager(Manager& manager, Config& config, Mode mode, std::shared_ptr<PlantModel> plant = nullptr,
+        std::shared_ptr<ReplayTrace> trace = nullptr);
+
+#endif /* CONFIG_H */
@@ -23,34 +23,120 @@
 #include "Abstractions.h"
 #include "MathSupport.h"
 #include <string>
+#include <vector>
+#include <memory>
+
+const double defaultBankHysteresis = 0.1;
 
 /* Any controller to change inputs and meet targets can be derived from the general 
  * Controller class. Such controllers must re-define the computeNewInputs() function.
  */
 class Controller {
 public:
-    Controller(std::string name, uint32_t smplInt = 1);
+    Controller(std::string name, uint32_t periodUS);
     std::string getName();
+    uint32_t getPeriodUS();
     void run();
     virtual void reset();
+    //the range and the allowed values (if known) of each input, in the order of newInputVals
+    virtual void setInputLimits(Vector minVals, Vector maxVals, std::vector<std::vector<double>> allowedVals = {});
     std::shared_ptr<OutputPort> newInputVals, currOutputTargetVals;
     std::shared_ptr<InputPort> currInputVals, outputVals, outputTargetVals;
 protected:
-    virtual Vector computeNewInputs(bool run);
+    virtual Vector computeNewInputs();
     std::string name;
-    uint32_t samplingInterval, cycles;
+    uint32_t periodUS; //the Manager runs the controller once every period
+    Vector inputMinVals, inputMaxVals; //empty if the inputs are not limited
+    std::vector<std::vector<double>> inputAllowedVals; //sorted; empty if unknown
 };
 
-//A Robust controller is a control theory controller. See README
+/* A Robust controller is a control theory controller. See README
+ * 
+ * The inputs it asks for can be beyond their range, e.g., the frequency 
+ * stays at its maximum for a long time when the targets are too high. The 
+ * state must not keep integrating the error then (windup), or the inputs 
+ * overshoot for a long time after the targets become reachable again. With 
+ * antiWindup, each new input is first clamped to its range and to its slew 
+ * limit, if any, and the state is corrected for the part of the change that 
+ * could not be applied, by back calculation: 
+ *   newState += Kaw * (applied - requested changes) 
+ * Kaw is read from the _Kaw.txt file of the controller, if it has one 
+ * (dimension x numInputs, normalized units like C and D). Otherwise, it is 
+ * C'(CC')^-1, the smallest change of the state that gives the applied inputs 
+ * instead of the requested ones. If CC' is singular, there is no such change, 
+ * so the program exits unless a _Kaw.txt file is given or antiWindup is off. 
+ * The optional _slewLimits.txt file has the largest change of each input in 
+ * one period (0 for no limit). Large swings of the frequency are expensive 
+ * transitions, so limiting them also helps the system.
+ */
 class RobustController : public Controller {
 public:
-    RobustController(std::string name, std::string dirPath, std::string ctlFileName, uint32_t smplInt = 1);
-    Vector computeNewInputs(bool run) override;
+    RobustController(std::string name, std::string dirPath, std::string ctlFileName, uint32_t periodUS,
+            bool antiWindup = true);
+    Vector computeNewInputs() override;
+    void reset() override;
+
+    //computeNewInputs in steps, for a ControllerBank that combines several designs:
+    Vector requestDeltaInputs(const Vector& deltaOutputs); //the change of the inputs asked for; keeps the next state
+    bool limitInputs(Vector& newIpVals, const Vector& currIpVals); //clamp to the slew limits and ranges; true if clamped
+    void commitState(const Vector& unappliedDeltaIps); //move to the next state, corrected for applied - requested changes
+    //takes the state that asks for the same change of the inputs as other's state (bumpless transfer)
+    void transferStateFrom(const RobustController& other);
+    bool canTransferState(); //C has full row rank
+    uint32_t getNumInputs();
+    uint32_t getNumMeasurements();
 private:
     Matrix A, B, C, D;
-    Vector state, deltaOutputs;
+    Vector state, deltaOutputs, newState;
+    Matrix pinvC; //C' (C C')^-1; 0x0 if C C' is singular
+
+    bool antiWindup;
+    Matrix Kaw; //0x0 without a _Kaw.txt file
+    Vector slewLimits; //empty without a _slewLimits.txt file
 
     Vector inputDenormalizeScales, outputNormalizeScales;
     //std::string dirPath = "/home/pothuku2/Research/visakha/code/Matlab/Controllers/";
 };
+
+/* A ControllerBank schedules several robust controllers, each designed around 
+ * one operating point, with one measured signal of the operating point (e.g., 
+ * the frequency or the number of active cores). The designs are loaded when the 
+ * bank is created and sorted by their points. 
+ * - By default, the bank uses the design whose point is nearest to the signal. 
+ *   It only moves to another design when that one is nearer by more than 
+ *   hysteresis x the distance between their points, so noise doesn't switch 
+ *   designs back and forth. 
+ * - With interpolate, the bank uses the two designs whose points are around the 
+ *   signal and blends their changes of the inputs linearly. 
+ * The designs that are not used keep their states. A design that starts being 
+ * used takes the state that asks for the same change of the inputs as the state 
+ * of the design that was used most until then (bumpless transfer), through the 
+ * pseudo-inverse of its C that is computed when it is loaded. So a switch only 
+ * multiplies a matrix and a vector, and the inputs don't jump. Every design 
+ * must have the same inputs and outputs, and its C must have full row rank. 
+ */
+class ControllerBank : public Controller {
+public:
+    ControllerBank(std::string name, std::string dirPath, std::vector<std::string> designFileNames,
+            std::vector<double> points, uint32_t periodUS, bool interpolate = false,
+            double hysteresis = defaultBankHysteresis, bool antiWindup = true);
+    void setInputLimits(Vector minVals, Vector maxVals, std::vector<std::vector<double>> allowedVals = {}) override;
+    void reset() override;
+    Vector computeNewInputs() override;
+    uint32_t getActiveDesign(); //the index, in the order of the points, of the design used most
+    uint64_t getSwitches(); //times that a design started being used
+    std::shared_ptr<InputPort> scheduleVals; //one pin: the signal of the operating point
+private:
+    void updateWeights(double operatingPoint);
+
+    std::vector<std::unique_ptr<RobustController>> designs;
+    std::vector<double> points;
+    bool interpolate;
+    double hysteresis;
+    std::vector<double> weights, prevWeights;
+    std::vector<Vector> requestedDeltaIps;
+    uint32_t activeDesign;
+    uint64_t switches;
+    bool started;
+};
 #endif /* CONTROLLER_H */
@@ -0,0 +1,107 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   Estimator.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * An estimator sits between the sensors and the controllers. It reads the
+ * measured outputs (e.g., RAPL power, which is noisy over one sampling
+ * interval) and the current values of the inputs, and sends estimates of the
+ * outputs to the controllers in place of the measurements.
+ *
+ * The KalmanFilter uses a discrete LTI model of the system around an
+ * operating point, in the same files as the plant model of the Simulate
+ * backend (see Simulation.h): dimension, numInputs, numOutputs, A, B, C, D,
+ * inputNames, outputNames, inputOffsets and outputOffsets. The model must be
+ * discretized at the period of the estimator, and the inputs read with the
+ * measurements are the ones that were applied until they were measured:
+ *   x[k] = A x[k-1] + B (u[k] - u0),  y[k] = C x[k] + D (u[k] - u0) + y0
+ * The noise covariances are in
+ *   Q      process noise, dimension values (diagonal) or dimension x dimension
+ *   R      measurement noise, numOutputs values (diagonal) or numOutputs x numOutputs;
+ *          if missing, the squares of the standard deviations in the noise file
+ * The steady state filter computes its gain once, when it is created. The
+ * time varying filter updates the error covariance and the gain every period,
+ * starting from Q.
+ *
+ * The matrices are fixed-size arrays of maxEstimatorDimension x
+ * maxEstimatorDimension inside the object and run() reads and writes the
+ * ports without temporaries, so an estimate doesn't allocate memory.
+ */
+
+#ifndef ESTIMATOR_H
+#define ESTIMATOR_H
+
+#include "Abstractions.h"
+#include <string>
+#include <vector>
+#include <memory>
+
+const uint32_t maxEstimatorDimension = 16; //largest number of states, inputs or outputs
+
+class Estimator {
+public:
+    Estimator(std::string name, uint32_t periodUS, std::vector<std::string> outputNames,
+            std::vector<std::string> inputNames);
+    virtual ~Estimator() = default;
+    std::string getName();
+    uint32_t getPeriodUS();
+    const std::vector<std::string>& getOutputNames(); //the sensor pins that are estimated
+    const std::vector<std::string>& getInputNames(); //the input pins that the estimates depend on
+    void run();
+    virtual void reset();
+    std::shared_ptr<InputPort> measuredVals, inputVals;
+    std::shared_ptr<OutputPort> estimatedVals;
+protected:
+    virtual void estimate(); //fills estimates from measurements and inputs; passes the measurements through
+    std::string name;
+    uint32_t periodUS; //the Manager runs the estimator once every period
+    std::vector<std::string> outputNames, inputNames;
+    double measurements[maxEstimatorDimension], inputs[maxEstimatorDimension], estimates[maxEstimatorDimension];
+};
+
+struct ModelShape;
+
+class KalmanFilter : public Estimator {
+public:
+    typedef double FixedMatrix[maxEstimatorDimension][maxEstimatorDimension];
+
+    KalmanFilter(std::string name, std::string dirPath, std::string fileName, uint32_t periodUS, bool timeVarying);
+    void reset() override;
+protected:
+    void estimate() override;
+private:
+    //the shape is read once, before the Estimator is constructed with its names
+    KalmanFilter(std::string name, std::string fileNamePrefix, const ModelShape& shape, uint32_t periodUS,
+            bool timeVarying);
+    void readModel(std::string fileNamePrefix, const ModelShape& shape);
+    void updateGain(); //one step of the Riccati recursion from P to the gain K and the next P
+
+    uint32_t dimension, numInputs, numOutputs;
+    bool timeVarying;
+    FixedMatrix A, B, C, D, Q, R;
+    FixedMatrix P, K, initialP;
+    double inputOffsets[maxEstimatorDimension], outputOffsets[maxEstimatorDimension];
+    double state[maxEstimatorDimension];
+
+    //scratch space of updateGain and estimate
+    FixedMatrix predictedP, temp, PCt, S, Sinv, IKC;
+    double predictedState[maxEstimatorDimension], currInputs[maxEstimatorDimension], //inputs relative to the offsets
+            innovation[maxEstimatorDimension];
+};
+
+#endif /* ESTIMATOR_H */
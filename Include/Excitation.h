@@ -0,0 +1,89 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   Excitation.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * Excitation signals for system identification. Each gives one value per
+ * sampling interval in [-amplitude, amplitude], which the Manager maps over the
+ * range of its input (-1 is the minimum, 1 the maximum) and rounds to the
+ * nearest allowed value. Unlike random values held for random periods, their
+ * spectra are known, so the power of the excitation goes where the model needs it.
+ *
+ * PRBS: a maximal length pseudo random binary sequence (prbsOrder bit shift
+ * register, period 2^prbsOrder - 1 clocks) that switches between the ends of the
+ * range. A new bit is drawn every clockPeriods sampling intervals; its power is
+ * flat up to about 0.44 / (clockPeriods x sampling interval), so a longer clock
+ * moves the power to lower frequencies. The inputs use the same sequence shifted
+ * by a fraction of its period, which makes them nearly uncorrelated.
+ *
+ * Multi-level PRBS: every clock, the value is one of levels equally spaced values,
+ * drawn from prbsOrder new bits of the register. It has the spectrum of the
+ * PRBS, and the intermediate values show how linear the system is.
+ *
+ * Multisine: the sum of cosines at the harmonics of period sampling intervals
+ * between lowHz and highHz, with Schroeder phases, which keep the peaks (crest
+ * factor) low so the input ranges carry more power. The inputs take interleaved
+ * harmonics, so their spectra don't overlap and their effects can be separated.
+ * The period is computed once and repeated.
+ */
+
+#ifndef EXCITATION_H
+#define EXCITATION_H
+
+#include <vector>
+#include <cstdint>
+
+const uint32_t prbsOrder = 11; //period of 2047 clocks
+const uint32_t defaultExcitationLevels = 3; //of the multi-level PRBS
+const uint32_t defaultMultisinePeriod = 256; //sampling intervals
+
+class Excitation {
+public:
+    Excitation(double amplitude);
+    virtual ~Excitation() = default;
+    virtual double next() = 0; //the value of the next sampling interval
+protected:
+    double amplitude;
+};
+
+class PRBS : public Excitation {
+public:
+    //levels 2 gives the binary sequence; shift advances the sequence by that many clocks
+    PRBS(uint32_t clockPeriods, uint32_t levels = 2, uint32_t shift = 0, double amplitude = 1.0);
+    double next() override;
+private:
+    void advance(); //one bit of the shift register
+
+    uint32_t clockPeriods, levels, count;
+    uint32_t reg;
+    double value;
+};
+
+class Multisine : public Excitation {
+public:
+    //the harmonics between lowHz and highHz whose index is input modulo numInputs
+    Multisine(uint32_t period, double samplingIntervalS, double lowHz, double highHz, uint32_t input,
+            uint32_t numInputs, double amplitude = 1.0);
+    double next() override;
+    uint32_t getNumHarmonics();
+private:
+    std::vector<double> values; //one period
+    uint32_t index, numHarmonics;
+};
+
+#endif /* EXCITATION_H */
@@ -21,8 +21,11 @@
 #define INPUTS_H
 
 #include "Sensors.h"
+#include "Random.h"
 #include <vector>
 #include <string>
+#include <mutex>
+#include <atomic>
 
 
 /*
@@ -48,12 +51,27 @@ public:
 
     std::shared_ptr<InputPort> in;
 
+    void updateValuesFromSystem() override;
     void updateValueToSystem();
 
-    void setRandomValue(); //set the input to a random value among the allowed values
+    /* updateValueToSystem() split into two halves so that the port side and the 
+     * system side can run on different threads. The port side (hasPendingValue, 
+     * takePendingValue) must stay on the thread that transfers wires. 
+     * applyValueToSystem() only touches the system and is serialized with reads.
+     * Inputs have one pin, so both take one value, without temporaries.
+     */
+    bool hasPendingValue();
+    void takePendingValue(double* newValue);
+    void applyValueToSystem(const double* newValue);
+
+    void setRandomValue(RandomStream& random); //set the input to a random value among the allowed values
     void setMaxValue(); //set the input to its maximum value
     void setMinValue(); //set the input to its minimum values
     void setMidValue(); //set the input to its mid value
+    void setNormalizedValue(double value); //-1 is the minimum, 1 the maximum; set to the nearest allowed value
+    double getMinValue();
+    double getMaxValue();
+    const std::vector<double>& getAllowedValues();
 
     virtual void reset();
     Vector measureWriteLatency();
@@ -64,10 +82,14 @@ protected:
     void updateMinMaxMid();
     virtual void writeToSystem();
     void prepareValueToBeWritten(Vector);
+    void prepareValueToBeWritten(double);
 
     std::vector<double> allowedValues; //populate in constructor
     double minVal, maxVal, midVal; //populate in constructor
     double requestedWriteValue, actualWriteValue; //these may be 
+
+    std::mutex ioLock; //serializes reads and writes to the system
+    std::atomic<bool> rewritePending; //the system didn't apply actualWriteValue; write it again
 };
 
 /* Reading frequency is easy - read the scaling_cur_freq file in the 
@@ -77,11 +99,12 @@ protected:
  * power governor and make the min and max frequencies the value we want to set. 
  * Then, the governor will enforce that frequency. If the userpsace governor is 
  * available, we will use it. Otherwise, we use the latter approach.
+ * With a package, only the cores of that package are read and set (see Topology.h).
  */
 
 class CPUFrequency : public Input {
 public:
-    CPUFrequency(std::string name);
+    CPUFrequency(std::string name, int package = -1);
     void reset() override;
 
 protected:
@@ -90,13 +113,13 @@ protected:
 
 private:
     std::vector<uint32_t> coreIds;
-    std::string freqFileNamePrefix = "/sys/devices/system/cpu/cpu",
+    std::string freqFileNamePrefix = systemPath("/sys/devices/system/cpu/cpu"),
             freqRFileNamePostfix = "/cpufreq/scaling_cur_freq";
     std::vector<std::string> freqRFileName;
     std::string freqWFileNamePostfix1 = "/cpufreq/scaling_setspeed",
             freqWFileNamePostfix2Min = "/cpufreq/scaling_min_freq";
     std::vector<std::string> freqWFileName, freqWMinFileName, freqWMaxFileName;
-    std::string presentCPUCoreFileName = "/sys/devices/system/cpu/present";
+    std::string presentCPUCoreFileName = systemPath("/sys/devices/system/cpu/present");
     bool writeScalingFile;
 };
 
@@ -110,7 +133,7 @@ protected:
     void writeToSystem() override;
     void readFromSystem() override;
     void reset() override;
-    std::string dirName = "/sys/class/thermal", devicetypePostfix = "/type",
+    std::string dirName = systemPath("/sys/class/thermal"), devicetypePostfix = "/type",
             pclampSetFileName, pclampMaxFileName, pclampSetFileNamePostfix = "/cur_state",
             pclampMaxFileNamePostfix = "/max_state";
 };
@@ -118,16 +141,18 @@ protected:
 /*The power balloon is an application we create. See README. 
  * The value of the balloon is set through /dev/shm/powerBalloon.txt and the maximum 
  * level of the balloon is present in /dev/shm/powerBalloonMax.txt
+ * The balloon of a package uses powerBalloon<package>.txt and powerBalloonMax<package>.txt
  */
 
 class PowerBalloon : public Input {
 public:
-    PowerBalloon(std::string name);
+    PowerBalloon(std::string name, int package = -1);
 protected:
     void writeToSystem() override;
     void readFromSystem() override;
     void reset() override;
-    std::string pbFileName = "/dev/shm/powerBalloon.txt", pbMaxFileName = "/dev/shm/powerBalloonMax.txt";
+    std::string pbFileName = systemPath("/dev/shm/powerBalloon.txt"),
+            pbMaxFileName = systemPath("/dev/shm/powerBalloonMax.txt");
 };
 
 #endif /* INPUTS_H */
@@ -0,0 +1,51 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/*
+ * File:   LogHeader.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * Finds the header line of a Maya log, the pin names printed by displayHeader, 
+ * for the parsers of logs (the Replay backend and Tools/MarkovTrain). The 
+ * header is the last line without numbers before the first row with as many 
+ * numbers as it has names, so that lines printed before the header (e.g., 
+ * status messages on stderr captured with 2>&1) are skipped, even if they 
+ * have as many words as the header.
+ */
+
+#ifndef LOGHEADER_H
+#define LOGHEADER_H
+
+#include <string>
+#include <vector>
+
+class LogHeader {
+public:
+    //Give the words of each line in turn until it returns true: the header is then known 
+    //and the line is its first row
+    bool addLine(const std::vector<std::string>& words);
+    const std::vector<std::string>& getNames() const; //the last line without numbers so far
+    bool isFound() const;
+
+private:
+    std::vector<std::string> names;
+    bool found = false;
+};
+
+bool isLogNumber(const std::string& word); //true if the whole word is a number
+std::vector<std::string> splitLogLine(const char* begin, const char* end); //words between whitespace
+
+#endif /* LOGHEADER_H */
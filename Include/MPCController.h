@@ -0,0 +1,123 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   MPCController.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * A model predictive controller. Every period it plans the inputs of the next
+ * mpcHorizon periods so that the predicted outputs follow the targets with
+ * small changes of the inputs, applies the first of them and plans again in
+ * the next period. The ranges and the allowed values of the inputs are part of
+ * the problem instead of being clamped after it.
+ *
+ * The model is a discrete LTI model in the files of the plant model of the
+ * Simulate backend (see Simulation.h), given by its prefix: dimension, numInputs,
+ * numOutputs, A, B, C, D, inputNames, outputNames, inputOffsets and outputOffsets,
+ * discretized at the period of the controller:
+ *   x[k] = A x[k-1] + B (u[k] - u0),  y[k] = C x[k] + D (u[k] - u0) + y0
+ * The inputs and outputs of the controller must be the ones of the model, in the
+ * same order. The model must be stable since its state is simulated with the
+ * applied inputs; the difference between the measured and the predicted outputs
+ * is a disturbance that is filtered and assumed constant over the horizon,
+ * which removes steady state errors.
+ *
+ * The cost is the sum over the horizon of
+ *   sum_o outputWeight[o] (y[o] - target[o])^2 + sum_i moveWeight[i] (change of u[i])^2
+ * where the changes of the inputs are fractions of their ranges. The weights are
+ * in the controller's directory, one value per output or input:
+ * <prefix>_mpcOutputWeights.txt and <prefix>_mpcMoveWeights.txt (1 and
+ * defaultMPCMoveWeight if missing).
+ *
+ * The inputs, normalized to [0, 1] over their ranges, make a quadratic program
+ * with box constraints. Its matrix only depends on the model, the weights and
+ * the ranges, so it is built once; a period only forms the linear term. The
+ * program is solved with a primal active-set method: Newton steps of the inputs
+ * that are not at a bound, stopping at the first bound on the way, and releasing
+ * a bound when its multiplier has the wrong sign. It starts from the plan of the
+ * last period shifted by one step, with the same inputs at their bounds, so
+ * most periods take a few steps. The first planned input is then moved to the
+ * allowed value below or above it that costs less.
+ *
+ * The solver stops when a budget fraction of the period has elapsed or after
+ * mpcMaxIterations. If it has not converged by then, the controller falls back
+ * to the plan of the last period, which is feasible.
+ */
+
+#ifndef MPCCONTROLLER_H
+#define MPCCONTROLLER_H
+
+#include "Controller.h"
+#include <string>
+#include <vector>
+
+const uint32_t mpcHorizon = 8; //periods planned ahead
+const uint32_t maxMPCDimension = 16; //largest number of states of the model
+const uint32_t maxMPCInputs = 8; //largest number of inputs or outputs
+const uint32_t maxMPCVariables = mpcHorizon * maxMPCInputs;
+const uint32_t mpcMaxIterations = 4 * maxMPCVariables; //steps of the solver in a period
+const double defaultMPCBudget = 0.5; //fraction of the period for the solver
+const double defaultMPCMoveWeight = 1.0;
+
+class MPCController : public Controller {
+public:
+    typedef double FixedMatrix[maxMPCVariables][maxMPCVariables];
+
+    MPCController(std::string name, std::string dirPath, std::string ctlFileName, std::string modelPrefix,
+            uint32_t periodUS, double budget = defaultMPCBudget);
+    void setInputLimits(Vector minVals, Vector maxVals, std::vector<std::vector<double>> allowedVals = {}) override;
+    void reset() override;
+    Vector computeNewInputs() override;
+    uint32_t getIterations(); //of the last period
+    uint64_t getFallbacks(); //periods that used the plan of the last period
+private:
+    void readModel(std::string modelPrefix);
+    void buildProblem(); //the matrices of the quadratic program, once the ranges of the inputs are known
+    bool solve(uint32_t numVariables); //from plan into z; true if it converged within the budget
+    bool factorFree(uint32_t numFree);
+    void chooseAllowedValues(); //move the first planned inputs to allowed values
+
+    uint32_t dimension, numInputs, numOutputs;
+    std::vector<std::string> modelInputNames, modelOutputNames;
+    double A[maxMPCDimension][maxMPCDimension], B[maxMPCDimension][maxMPCInputs];
+    double C[maxMPCInputs][maxMPCDimension], D[maxMPCInputs][maxMPCInputs];
+    double inputOffsets[maxMPCInputs], outputOffsets[maxMPCInputs];
+    double outputWeights[maxMPCInputs], moveWeights[maxMPCInputs];
+    double budget;
+
+    //the quadratic program: minimize 1/2 z' H z + f' z for 0 <= z <= 1, where f =
+    //stateGain x + outputGain (y0 + disturbance - targets) + constantTerm - moveWeights z[now] (first inputs)
+    double inputLows[maxMPCInputs], inputSpans[maxMPCInputs];
+    FixedMatrix H;
+    double stateGain[maxMPCVariables][maxMPCDimension], outputGain[maxMPCVariables][maxMPCInputs];
+    double constantTerm[maxMPCVariables];
+    bool built;
+
+    double state[maxMPCDimension], disturbance[maxMPCInputs];
+    double plan[maxMPCVariables]; //normalized inputs, period after period
+    bool started;
+    uint32_t iterations;
+    uint64_t fallbacks;
+
+    //scratch space of computeNewInputs and solve
+    FixedMatrix reduced; //Cholesky factor of H over the free inputs
+    double linear[maxMPCVariables], z[maxMPCVariables], gradient[maxMPCVariables], step[maxMPCVariables];
+    uint32_t freeInputs[maxMPCVariables];
+    int bound[maxMPCVariables]; //-1 at the lower bound, 1 at the upper bound, 0 free
+    double currInputs[maxMPCInputs], currNormalized[maxMPCInputs];
+};
+
+#endif /* MPCCONTROLLER_H */
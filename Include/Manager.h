@@ -23,21 +23,44 @@
 #include "Sensors.h"
 #include "Inputs.h"
 #include "Controller.h"
+#include "MPCController.h"
+#include "Estimator.h"
+#include "SystemId.h"
+#include "Calibrator.h"
+#include "Excitation.h"
 #include "Planner.h"
+#include "WorkerPool.h"
+#include "NameRegistry.h"
+#include "Scheduler.h"
 
 #include <vector>
 #include <string>
 #include <memory>
 #include <atomic>
 #include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "RingBuffer.h"
 
 enum class Mode {
     Baseline,
     Sysid,
     Mask,
+    Calibrate, // measure the scaling factors of the robust controller
     Invalid
 };
 
+/* Serial: read sensors, compute and write inputs one after the other in every period.
+ * Pipelined: inputs are written by a separate actuator thread, so writing the inputs 
+ * of one period overlaps with sensing and computing the next period.
+ */
+enum class ExecMode {
+    Serial,
+    Pipelined
+};
+
 enum class NameType {
     Port,
     Pin,
@@ -46,15 +69,33 @@ enum class NameType {
 
 enum class ControllerType {
     SSV,
+    MPC, // model predictive controller
+    Bank, // robust controllers scheduled by the operating point
     Dummy
 };
 
+enum class EstimatorType {
+    Kalman, // time varying Kalman filter
+    SteadyStateKalman
+};
+
+enum class ExcitationType {
+    Random, // random allowed values held for random periods
+    PRBS, // pseudo random binary sequence
+    MultiLevelPRBS,
+    Multisine // sum of cosines with Schroeder phases
+};
+
 enum class MaskGenType {
     Constant,
     Uniform,
     Gauss,
     Sine,
     GaussSine,
+    Pink, // 1/f noise
+    BandNoise, // noise limited to a band of frequencies
+    MultiTone, // sum of sinusoids with random frequencies
+    Markov, // Markov chain learned from application traces
     Preset // use a precomputed target from a file
 };
 
@@ -69,29 +110,96 @@ public:
     void addSensor(std::unique_ptr<Sensor> newSensor);
     void addInput(std::unique_ptr<Input> newInput); //add an input
     void addSysIdParams(std::vector<std::string> sysidList_ = {},
-    std::initializer_list<uint32_t> minHoldTime = {}, std::initializer_list<uint32_t> maxHoldTime = {},
-    std::initializer_list<uint32_t> initHoldTime = {});
-    void addController(std::string name, std::initializer_list<std::string> opNames,
-            std::initializer_list<std::string> ipNames, ControllerType ctlType = ControllerType::Dummy,
-            std::string dirPath = "", std::string fileName = "", uint32_t smplInt = 1);
+    std::vector<uint32_t> minHoldTime = {}, std::vector<uint32_t> maxHoldTime = {},
+    std::vector<uint32_t> initHoldTime = {});
+    //Excites the sysid inputs with a signal of known spectrum instead of random hold periods (see 
+    //Excitation.h). Lists have one value per sysid input: the clock of the PRBS in sampling intervals, 
+    //the band of the multisine, and the amplitude as a fraction of half the range of the input
+    void setSysidExcitation(ExcitationType type, std::vector<uint32_t> clockPeriods = {},
+            uint32_t levels = defaultExcitationLevels, std::vector<double> lowHz = {},
+            std::vector<double> highHz = {}, std::vector<double> amplitudes = {},
+            uint32_t multisinePeriod = defaultMultisinePeriod);
+    //Fits an ARX model of the outputs (sensor ports or pins) to the sysid inputs while they are 
+    //excited (see SystemId.h); written to modelPrefix at the end of the run if it is not empty
+    void addSystemIdentifier(std::vector<std::string> outputNames, uint32_t na = 1, uint32_t nb = 1,
+            double forgetting = defaultSystemIdForgetting, std::string modelPrefix = "");
+    //Steps the input ports between their ends and writes the scales of the robust controller 
+    //to fileNamePrefix (see Calibrator.h); the run ends when they are measured
+    void addCalibrator(std::string outputName, std::vector<std::string> inputNames, std::string fileNamePrefix,
+            uint32_t window = defaultCalibrationWindow, double tolerance = defaultCalibrationTolerance,
+            uint32_t maxWindows = defaultCalibrationMaxWindows);
+    //Estimates the sensor pins of the model for the controllers added after it
+    void addEstimator(std::string name, EstimatorType estType, std::string dirPath, std::string fileName,
+            uint32_t periodUS = 0);
+    void addController(std::string name, std::vector<std::string> opNames,
+            std::vector<std::string> ipNames, ControllerType ctlType = ControllerType::Dummy,
+            std::string dirPath = "", std::string fileName = "", uint32_t periodUS = 0,
+            bool antiWindup = true, std::string modelPrefix = "", double mpcBudget = defaultMPCBudget);
+    //Robust controllers in dirPath designed at points of the schedule pin (see ControllerBank)
+    void addControllerBank(std::string name, std::vector<std::string> opNames,
+            std::vector<std::string> ipNames, std::string dirPath, std::vector<std::string> designFileNames,
+            std::vector<double> points, std::string scheduleName, bool interpolate = false,
+            double hysteresis = defaultBankHysteresis, uint32_t periodUS = 0, bool antiWindup = true);
     void addMaskGenerator(std::string name, std::string controllerName, 
         MaskGenType maskType = MaskGenType::Constant, std::string dirPath ="", 
-        std::string fileName ="", uint32_t smplInt = 1, bool randomizeMaskProps = false);
+        std::string fileName ="", uint32_t periodUS = 0, bool randomizeMaskProps = false, 
+        uint32_t lookahead = defaultMaskLookahead);
+    //Periods of 0 (here and in Sensor::setPeriodUS) mean once every sampling interval
+    void setExecMode(ExecMode newExecMode);
+    //0 runs planners and controllers one after the other. With sensors and inputs of several 
+    //packages, the workers are spread over the packages (see Topology.h)
+    void setNumWorkers(uint32_t numWorkers);
+    uint32_t getSamplingIntervalMS();
+    void useVirtualClock(std::shared_ptr<VirtualClock> clock); //don't sleep between ticks (simulation)
+    void setRunDurationUS(uint64_t durationUS); //0 runs until SIGINT
+    void setStopCondition(std::function<bool()> shouldStop); //checked every tick, e.g., the end of a replayed trace
     void run();
     Manager(uint32_t samplingIntervalMS, Mode mode);
 
 private:
-    void updateValuesFromSystem(); //read values from system into sensor modules
-    void updateValuesToSystem(); //write values from input modules to system
+    //What a sensor or input name refers to. A name can be both a port and a pin 
+    //(e.g., single pin sensors); listIndex is the first block that uses the name.
+    struct NameEntry {
+        bool isPort = false;
+        bool isPin = false;
+        uint32_t listIndex = 0;
+    };
+
+    //Values of the inputs that have something to write in one period. The vectors are 
+    //reserved for every input once and reused, so filling a batch doesn't allocate.
+    struct ActuationBatch {
+        std::vector<uint32_t> inputIndices;
+        std::vector<double> values; //one per input (inputs have one pin)
+    };
+
+    void updateValuesFromSystem(); //read values from system into the sensor modules that are due
+    void updateValuesToSystem(); //write values from the input modules that are due to system
+    void queueValuesToSystem(); //hand values from input modules to the actuator thread
+    ActuationBatch* claimActuationBatch(); //an empty slot of the queue; waits while the queue is full
+    void startActuator();
+    void stopActuator();
+    void runActuator(); //actuator thread: write queued values to system
+    void buildPackageIO(); //read and write the sensors and inputs of each package on its workers
+    void readPackage(uint32_t package); //read the sensors and inputs of one package that are due
+    void writePackage(uint32_t package); //write the values taken for the inputs of one package
+    uint32_t getPackageWorker(int package, uint32_t taskNum); //for the taskNum-th task of a package in a batch
     void transferBlockWires(); //transfer values on wires between components
     void transferSysReadings();
     void transferSysWrites();
+    void runEstimators(); //run the estimators that are due and send their estimates to the controllers
+    void compileWiringPlan(); //flatten all pins and wires for the per-period transfers
+    void wireController(std::unique_ptr<Controller> controller, std::vector<std::string> opNames,
+            std::vector<std::string> ipNames); //to the sensors, estimators and inputs
 
     void displayValues();
     void displayHeader();
 
     void runSysid();
+    void runCalibration();
+    void applyCalibrationSetting();
     void runControl();
+    void buildControlSchedule(); //group planners and controllers into levels of independent blocks
+    void buildRateSchedule(); //give every block a task in the scheduler
 
     void resetInputs();
 
@@ -108,19 +216,78 @@ private:
     uint32_t getInputIndexInList(std::string name);
     uint32_t getSensorIndexInList(std::string name);
 
+    void registerNames(NameRegistry& registry, std::vector<NameEntry>& entries,
+            std::string portName, const std::vector<std::string>& pinNames, uint32_t listIndex);
+    const NameEntry* findName(const NameRegistry& registry, const std::vector<NameEntry>& entries,
+            const std::string& name);
+
     void completeInit();
 
     Mode mode;
+    ExecMode execMode = ExecMode::Serial;
     uint32_t samplingIntervalMS;
     std::vector<std::unique_ptr < Sensor>> sensorList;
     std::vector<std::unique_ptr < Input>> inputList;
     std::vector<std::unique_ptr <Controller>> controllerList;
     std::vector<std::unique_ptr <Planner>> plannerList;
-    std::vector<std::unique_ptr <Wire>> sysReadWires, sysWriteWires, blockWires;
+    std::vector<std::unique_ptr <Estimator>> estimatorList;
+    std::vector<std::unique_ptr <Wire>> sysReadWires, sysWriteWires, blockWires, estimateWires;
+    std::vector<std::shared_ptr<Port>> schedulePorts; //of the controller banks
+
+    //Names of sensor and input ports and pins, filled by addSensor and addInput
+    NameRegistry sensorNames, inputNames;
+    std::vector<NameEntry> sensorNameEntries, inputNameEntries; //indexed by name handle
+    WiringPlan wiringPlan;
+    uint32_t sysReadRoute, sysWriteRoute, blockRoute, estimateRoute;
+
+    //Multi-rate execution. Each block has a task in the scheduler; the Manager ticks 
+    //at the base tick and runs only the blocks that are due. Sensors and inputs are 
+    //visited in rate-monotonic order. Display, sysid and calibration run every sampling interval.
+    RateScheduler scheduler;
+    std::vector<uint32_t> sensorTasks, inputTasks, plannerTasks, controllerTasks, controlTasks, estimatorTasks;
+    std::vector<uint32_t> sensorOrder, inputOrder;
+    uint32_t displayTask, sysidTask;
+    bool usesVirtualClock = false;
+    uint64_t runDurationUS = 0;
+    std::function<bool()> stopCondition;
 
     std::vector<std::vector<std::unique_ptr < Input>>::size_type> inputIndicesForSysid;
     std::vector<std::string> sysidInputNameList;
     std::vector<uint32_t> holdPeriods, minHoldPeriods, maxHoldPeriods, holdCounters;
     uint32_t defaultMinHoldPeriod = 2, defaultMaxHoldperiod = 20; //2, 20 for freq, 2, 10 for freq, numcores
+    RandomStream sysidRandom = newRandomStream(); //hold periods and values of the sysid inputs
+    std::vector<std::unique_ptr<Excitation>> excitations; //of the sysid inputs, if not random
+    std::vector<double> excitationValues; //the last ones, to write only the changes
+    std::unique_ptr<SystemIdentifier> systemId;
+    std::string systemIdModelPrefix;
+    std::unique_ptr<Calibrator> calibrator;
+    std::vector<uint32_t> calibrationInputIndices;
+    std::string calibrationFileNamePrefix;
+
+    //Pipelined execution: single producer (control loop), single consumer (actuator)
+    std::unique_ptr<RingBuffer<ActuationBatch>> actuationQueue;
+    std::thread actuator;
+    std::mutex actuatorLock;
+    std::condition_variable actuatorWakeup; //the queue has a batch (or the actuator must stop)
+    std::condition_variable actuationSpace; //the actuator has freed a slot of the queue
+    std::atomic<bool> stopActuating;
+    uint32_t actuationQueueDepth = 4;
+
+    //Parallel execution of planners and controllers. Blocks in one level don't 
+    //depend on each other; a level starts only after the previous one has completed.
+    uint32_t numWorkers = 0;
+    std::unique_ptr<WorkerPool> workerPool;
+    std::vector<std::vector<std::function<void()>>> controlLevels;
+
+    //Per-package execution. Worker w runs on the CPUs of package w % numPackages. The planners 
+    //and controllers of a package and, on the system, the reads and writes of its sensors and 
+    //inputs run on the workers of that package, so the packages are controlled in parallel 
+    //and their sysfs accesses stay local. Blocks of no package (or of several) run on any worker.
+    uint32_t numPackages = 1;
+    std::vector<std::vector<uint32_t>> controlLevelWorkers;
+    bool parallelPackageIO = false;
+    std::vector<std::function<void()>> packageReadTasks, packageWriteTasks;
+    std::vector<uint32_t> packageWorkers;
+    std::vector<ActuationBatch> packageBatches; //values taken from the ports, to be written by the workers
 };
 #endif /* MANAGER_H */
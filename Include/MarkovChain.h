@@ -0,0 +1,69 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   MarkovChain.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * A Markov chain over a few states of the outputs, learned offline from the
+ * power traces of real applications (see Tools/MarkovTrain.cpp), so that a
+ * mask looks like plausible workload power. Each state emits Gaussian
+ * targets around its mean, i.e., this samples from a hidden Markov model.
+ * The model is read from the controller's directory:
+ *
+ *   <prefix>_markovStates.txt       numStates rows of numOutputs values: the mean
+ *                                   targets in each state
+ *   <prefix>_markovStddev.txt       (optional) the same for the standard deviation
+ *                                   of the targets in each state; 0 if missing
+ *   <prefix>_markovTransitions.txt  numStates x numStates: row i has the
+ *                                   probabilities of moving from state i to each state
+ *
+ * Every row of transitions becomes an alias table (Vose's method), so the next
+ * state is sampled in constant time with one random integer and one random
+ * double, however many states there are. The chain starts from its stationary
+ * distribution.
+ */
+
+#ifndef MARKOVCHAIN_H
+#define MARKOVCHAIN_H
+
+#include "MathSupport.h"
+#include "Random.h"
+#include <string>
+#include <vector>
+
+class MarkovChain {
+public:
+    MarkovChain(std::string fileNamePrefix, uint32_t numOutputs, RandomStream random);
+
+    void next(double* values); //move to the next state and write its targets
+    uint32_t getNumStates();
+    uint32_t getState();
+
+private:
+    //alias table of one distribution, stored from index first in aliasProb and aliasIndex
+    void buildAliasTable(const double* probs, std::size_t first);
+    uint32_t sample(std::size_t first);
+
+    uint32_t numStates, numOutputs;
+    Vector means, stddevs; //numStates x numOutputs
+    std::vector<double> aliasProb; //numStates + 1 tables of numStates entries; the last one is the start
+    std::vector<uint32_t> aliasIndex;
+    uint32_t state;
+    RandomStream random;
+};
+
+#endif /* MARKOVCHAIN_H */
@@ -353,6 +353,20 @@ bool operator>(const double& lhs, const Vector& rhs);
 // Matrix-vector multiplication operator
 Vector operator*(const Matrix& m, const Vector& v);
 
+// Matrix operators:
+// Matrix-matrix multiplication operator
+Matrix operator*(const Matrix& lhs, const Matrix& rhs);
+
+Matrix transpose(const Matrix& m);
+
+// Inverse of a square matrix; an empty matrix if it is singular
+Matrix inverse(const Matrix& m);
+
+// Inverse of the n x n matrix in a into out, both with stride values per row, e.g., 
+// fixed-size arrays. It doesn't allocate memory, so it can run every period (e.g., 
+// in the time varying Kalman filter). Overwrites a; false if a is singular
+bool inverse(double* out, double* a, std::size_t n, std::size_t stride);
+
 // IO stream operators
 std::ostream& operator<<(std::ostream& os, const Vector& v);
 
@@ -0,0 +1,49 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/*
+ * File:   NameRegistry.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * Interns names (of ports and pins) into small integer handles. Handles are 
+ * given out in the order names are first seen, so they can index into plain 
+ * vectors that hold whatever the owner wants to know about a name. Looking up 
+ * a name is one hash, instead of a scan with string compares over every block.
+ */
+
+#ifndef NAMEREGISTRY_H
+#define NAMEREGISTRY_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+class NameRegistry {
+public:
+    static const uint32_t invalidHandle = UINT32_MAX;
+
+    uint32_t intern(const std::string& name); //existing handle, or a new one if the name is new
+    uint32_t find(const std::string& name) const; //invalidHandle if the name was never interned
+    const std::string& getName(uint32_t handle) const;
+    uint32_t size() const;
+
+private:
+    std::unordered_map<std::string, uint32_t> handles;
+    std::vector<std::string> names;
+};
+
+#endif /* NAMEREGISTRY_H */
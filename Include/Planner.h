@@ -22,12 +22,21 @@
 
 #include "Abstractions.h"
 #include "MathSupport.h"
-#include <random>
+#include "PresetSource.h"
+#include "RingBuffer.h"
+#include "Random.h"
+#include "MarkovChain.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <tuple>
 #include <utility>
 #include <string>
 
-extern const uint32_t samplingIntervalMS;
+extern uint32_t samplingIntervalMS; //set from the config before any block is created
+
+//how many future targets a mask generator computes ahead of the planner by default
+const uint32_t defaultMaskLookahead = 1024;
 
 //The different distributions
 enum class SignalType {
@@ -35,13 +44,23 @@ enum class SignalType {
     Uniform,
     Sine,
     GaussSine,
+    Pink,
+    BandNoise,
+    MultiTone,
+    Markov, //targets from a MarkovChain learned from traces (see MarkovChain.h), not from a SignalGenerator
 };
 
 /*Parameters for the different distributions.
  * Normal: mu=param1,sigma=param2
  * Uniform: min=param1, max=param2
- * Sinusoid: param1+param3*sin(2*pi*param2*time); param1 = offset, param2 = freq, param3 = amplitude
- * GaussSine: param1+param3*sin(2*pi*param2*time) + Normal (0,param4)
+ * Sinusoid: param1+param3*sin(phase); param1 = offset, param2 = freq, param3 = amplitude
+ * GaussSine: param1+param3*sin(phase) + Normal (0,param4)
+ * The phase advances by 2*pi*param2 per second, so changing the frequency doesn't make the sinusoid jump.
+ * Pink: 1/f noise with mean param1 and standard deviation param2
+ * BandNoise: param1 + noise with standard deviation param3 whose spectrum is limited to param4 Hz around param2 Hz
+ * MultiTone: param1 + param3*(sum of multiToneCount sinusoids)/multiToneCount; the frequency of each is 
+ *            chosen randomly up to param2 whenever param2 changes
+ * All these are generated one sample at a time in O(1), and are clamped to [minVal,maxVal].
  */
 enum class Param {
     One,
@@ -59,28 +78,58 @@ public:
     void run();
     std::string getName();
 
-    Planner(std::string name, std::string dirPath, std::string fileName, uint32_t smplInt=1, bool usePreset = false);
+    Planner(std::string name, std::string dirPath, std::string fileName, uint32_t periodUS, bool usePreset = false);
+    uint32_t getPeriodUS();
 
     std::shared_ptr<OutputPort> newOutputTargetVals;
     std::shared_ptr<InputPort> currInputVals, currOutputVals;
 
 protected:
-    virtual Vector computeNewTargets(bool run);
+    virtual Vector computeNewTargets();
     std::string name, fileName, dirPath;
     Vector targets, outputs, maxLimits, minLimits;
-    uint32_t periodInSamples, cycles;
+    uint32_t periodUS; //the Manager runs the planner once every period
     
-    //use targets that were precomputed.
+    //use targets that were precomputed (streamed from a file, see PresetSource.h).
     bool usePresetTarget; 
-    Matrix presetTargets;
-    uint64_t presetTargetCounter;
+    std::unique_ptr<PresetSource> presetTargets;
 };
 
+//A sinusoid, generated by rotating the point (cos(phase), sin(phase)) by the phase 
+//step every sample instead of calling sin() with a growing time, which loses precision 
+//in long runs. The point is scaled back to the unit circle every sample so that rounding 
+//errors don't accumulate. Changing the frequency only changes the step, so the phase is continuous.
+class Oscillator {
+public:
+    Oscillator(double phase = 0.0);
+    void setFrequency(double freqHz, double sampleFreqHz);
+    double next(); //sin(phase), then advances the phase
+private:
+    double phaseCos, phaseSin, stepCos, stepSin;
+};
+
+//A 4th order band-pass filter (two identical resonant biquad sections), scaled so that 
+//white noise with unit variance comes out with unit variance
+class BandPassFilter {
+public:
+    BandPassFilter();
+    void setBand(double centerFreqHz, double bandwidthHz, double sampleFreqHz); //keeps the state
+    double filter(double x);
+private:
+    double b0, a1, a2, gain; //b1 = 0 and b2 = -b0 for a band-pass
+    double z1[2], z2[2]; //state of each section
+};
+
+const uint32_t multiToneCount = 4; //sinusoids summed by a MultiTone signal
+
 class SignalGenerator {
 public:
-    SignalGenerator(SignalType sig, double minval, double maxval, double p1, double p2, double p3, double p4 );
+    //sampleFreqHz is how often getSignalValue() is called
+    SignalGenerator(SignalType sig, double minval, double maxval, double p1, double p2, double p3, double p4,
+            double sampleFreqHz);
 
     double getSignalValue();
+    void getSignalValues(double* values, uint32_t count); //the next count values, same as calling getSignalValue() count times
     
     void enableRandomizedParam(Param p, std::pair<double, double> range); //make a parameter be selected randomly from a range
     void setParamRange(Param p, std::pair<double, double> range); //change the range from which a parameter is selected 
@@ -91,33 +140,58 @@ public:
 private:
     std::pair<double, double> sanitizeParamRanges(Param p, std::pair<double, double> range); //verify that the ranges are legal for the signal chosen
     void sanitizeParamValues(); //Make sure param values are properly set (e.g., values don;t go beyond maxVal)
+    void updateFrequencies(); //apply a new param2 (and param4 for BandNoise)
+    void selectToneFrequencies(); //for MultiTone
+    double nextColoredValue(double white); //the next sample of Pink or BandNoise, from a white noise sample
 
     SignalType sigType;
     double param1, param2, param3, param4; //Signal parameters. See above on how they are used
     double minVal, maxVal; //signal genreated is always in [minVal,maxVal]
 
-    //Distributions to generate signals
-    std::normal_distribution<double> normalDist; 
-    std::uniform_real_distribution<> uniformDist; 
-    double time, sineSamplingFreq, minSineCycles; 
+    //Each generator has its own stream (see Random.h) so that mask generators can run 
+    //on different threads and a run can be reproduced from its seed
+    RandomStream random;
+
+    double sineSamplingFreq, minSineCycles; 
+    Oscillator sine; 
+    std::vector<Oscillator> tones; //MultiTone
+    std::vector<double> toneFreqs;
+    double pinkState[7]; //Pink, the filter state
+    BandPassFilter bandFilter; //BandNoise
     
-    //Each parameter can be varied randomly. So, maintian a distribution for each parameters
+    //Each parameter can be varied randomly. So, maintian a range (uniformly sampled) for each parameters
     bool randomizeParam1, randomizeParam2, randomizeParam3, randomizeParam4;
-    std::uniform_real_distribution<> param1Dist, param2Dist, param3Dist, param4Dist; 
+    std::pair<double, double> param1Range, param2Range, param3Range, param4Range; 
 };
 
+/* The targets of a mask don't depend on the measurements, so a helper thread 
+ * computes them ahead of time (including the randomized changes to the signal 
+ * properties) into a lock-free ring that holds lookahead rows of targets. 
+ * computeNewTargets() only pops the next row, and the helper thread is woken 
+ * up to refill the ring when it is half empty. With a lookahead of 0, the 
+ * targets are computed in computeNewTargets() as before.
+ */
 class MaskGenerator : public Planner {
 public:
     MaskGenerator(std::string name, std::string dirPath, std::string fileName, 
-            uint32_t smplInt = 1, SignalType sig = SignalType::Normal, bool randomProp = false);
+            uint32_t periodUS, SignalType sig = SignalType::Normal, bool randomProp = false,
+            uint32_t lookahead = defaultMaskLookahead);
+    ~MaskGenerator();
+    void reset() override;
 protected:
-    Vector computeNewTargets(bool run) override;
+    Vector computeNewTargets() override;
+    void generateNextTargets(double* newTargets, uint32_t numRows = 1); //the targets for the next numRows invocations, row after row
     
     SignalType signalType;
     std::vector<std::shared_ptr<SignalGenerator>> signalDists; //one signalDist for each output
+    Vector generatedTargets; //latest targets computed by generateNextTargets()
+    std::vector<double> signalValues; //a batch of values of one signal
+    std::unique_ptr<MarkovChain> markovChain; //only for Markov masks
 
     bool randomizeMaskProps;
     uint32_t maskPropHoldCounter, maskPropHoldPeriod;
+    uint32_t uniformHoldStep; //sampling intervals per invocation; a uniform mask's hold is counted in sampling intervals
+    RandomStream random; //own stream, see SignalGenerator
     //bool randomizeMean, randomizeVariance;
     //uint32_t constVariancePeriod, constVarianceCounter, constMeanPeriod, constMeanCounter;
     //uint32_t uniformSigWaitPeriod, uniformSigWaitCounter;
@@ -125,6 +199,18 @@ private:
     bool shouldMaskPropChange();
     //bool shouldMeanChange();
     //bool shouldVarianceChange();
+
+    void startGenerating();
+    void stopGenerating();
+    void generateLoop(); //runs on the helper thread
+    void wakeGenerator();
+
+    uint32_t lookahead;
+    std::unique_ptr<RingBuffer<double>> futureTargets; //rows of targets, nullptr without lookahead
+    std::thread generatorThread;
+    std::mutex generatorLock; //guards stopGenerator, and is held to wake up the helper thread
+    std::condition_variable generatorWakeup;
+    bool stopGenerator;
 };
 
 #endif /* PLANNER_H */
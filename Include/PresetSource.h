@@ -0,0 +1,55 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/*
+ * File:   PresetSource.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * The targets of a Preset mask, streamed from a file instead of being loaded 
+ * into memory at startup. A preset file has one row of targets (one value per 
+ * output) per invocation of the planner; after the last row, the mask starts 
+ * over. If <prefix>_presetlen.txt exists, only that many rows are used.
+ * 
+ * Two formats are supported. <prefix>_presets.bin (native doubles, row after 
+ * row; see Scripts/PresetsToBinary.sh) is memory mapped, and rows are handed out 
+ * as pointers into the mapping. Pages ahead of the current row are prefetched 
+ * and pages behind it are released, so memory stays bounded. Otherwise, 
+ * <prefix>_presets.txt (whitespace separated values) is parsed by a helper 
+ * thread into a few fixed blocks of rows ahead of the planner.
+ * 
+ * Either way, opening a preset doesn't read the whole file, and nextRow() 
+ * neither allocates nor parses.
+ */
+
+#ifndef PRESETSOURCE_H
+#define PRESETSOURCE_H
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+class PresetSource {
+public:
+    //the binary file if it exists, else the text file
+    static std::unique_ptr<PresetSource> open(std::string fileNamePrefix, uint32_t width);
+    virtual ~PresetSource() = default;
+
+    //the next row of width values; valid until the next call
+    virtual const double* nextRow() = 0;
+    virtual void rewind() = 0; //start over from the first row
+};
+
+#endif /* PRESETSOURCE_H */
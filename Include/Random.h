@@ -0,0 +1,87 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   Random.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * Random numbers for the masks, sysid and the simulated plant.
+ *
+ * A RandomStream is the Philox4x32-10 counter-based generator: the n-th block
+ * of four 32-bit words is a keyed bijection of (n, stream id), so streams with
+ * different ids never overlap and there is no state to share between threads.
+ * The key comes from the run's seed. Blocks are computed 16 at a time into a
+ * buffer by a loop without dependencies between the blocks, which the compiler
+ * can vectorize. Gaussian variates use the 128 layer Ziggurat method.
+ *
+ * Every user of random numbers gets its own stream from newRandomStream(),
+ * numbered in the order they are created. Since Maya creates its blocks in
+ * the order of the config, a run is reproducible from its seed (--seed) and
+ * the streams can be used on different threads.
+ */
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+#include <cstddef>
+
+class RandomStream {
+public:
+    RandomStream(uint64_t seed, uint64_t streamId);
+
+    uint32_t nextUInt32() {
+        if (bufferPos == bufferSize) {
+            refill();
+        }
+        return buffer[bufferPos++];
+    }
+
+    uint64_t nextUInt64() {
+        uint64_t high = nextUInt32();
+        return (high << 32) | nextUInt32();
+    }
+
+    double uniform(); //in [0,1)
+    double uniform(double min, double max); //in [min,max)
+    uint32_t uniformInt(uint32_t min, uint32_t max); //in [min,max], without bias
+    double normal(); //standard normal
+    double normal(double mean, double stddev);
+
+    //batch versions
+    void fillUniform(double* values, std::size_t count, double min = 0.0, double max = 1.0);
+    void fillNormal(double* values, std::size_t count, double mean = 0.0, double stddev = 1.0);
+
+private:
+    static const uint32_t blocksPerRefill = 16;
+    static const uint32_t bufferSize = 4 * blocksPerRefill;
+
+    void refill();
+    double openUniform(); //in (0,1), for logarithms
+    double normalTail(bool negative);
+
+    uint32_t key[2];
+    uint64_t counter; //index of the next block
+    uint64_t streamId;
+    uint32_t buffer[bufferSize];
+    uint32_t bufferPos;
+};
+
+void setRandomSeed(uint64_t seed); //call before creating any stream
+uint64_t getRandomSeed();
+RandomStream newRandomStream(); //the next stream of the seed
+
+#endif /* RANDOM_H */
@@ -0,0 +1,118 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/*
+ * File:   Replay.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * Replay: sensors and inputs backed by a trace recorded from an earlier run, 
+ * so that controllers and planners can be driven with historical measurements, 
+ * deterministically and as fast as they can be computed (the Manager runs on a 
+ * VirtualClock, like with the Simulate backend).
+ * 
+ * A trace is Maya's own output: a header line with the pin names (as printed by 
+ * displayHeader) followed by one line of values per sampling interval. The 
+ * header is the last line without numbers before the first row with as many 
+ * numbers as it has names. Lines before the header (e.g., status messages 
+ * captured with 2>&1) and lines that are not a full row of numbers (e.g., 
+ * messages mixed into the log) are skipped. Row k is replayed from virtual time 
+ * (k + 1) * intervalUS until the next row, which is when Maya printed it, so 
+ * replaying a log in Baseline mode prints the same log.
+ * 
+ * The trace is mapped into memory and parsed one row at a time as the virtual 
+ * clock advances. Pages that were already replayed are given back to the 
+ * kernel, so traces much larger than memory can be replayed.
+ * 
+ * Replay is open loop: sensors report what was recorded regardless of what the 
+ * controllers do. An input reports its recorded value until Maya writes to it, 
+ * and then the value Maya wrote.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "Sensors.h"
+#include "Inputs.h"
+#include "Scheduler.h"
+#include "NameRegistry.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+class ReplayTrace {
+public:
+    ReplayTrace(std::string fileName, std::shared_ptr<VirtualClock> clock, uint64_t intervalUS);
+    ~ReplayTrace();
+    ReplayTrace(const ReplayTrace&) = delete;
+    ReplayTrace& operator=(const ReplayTrace&) = delete;
+
+    uint32_t getColumn(std::string name); //UINT32_MAX if the trace has no such column
+    double getValue(uint32_t column); //in the row of the current virtual time
+    bool isFinished(); //the virtual time is past the last row
+    uint64_t getRowsReplayed();
+
+    std::shared_ptr<VirtualClock> getClock();
+
+private:
+    void advance();
+    bool parseNextRow(std::vector<double>& row); //false at the end of the trace
+    bool nextLine(const char*& begin, const char*& end);
+    void releaseReplayedPages();
+
+    std::string fileName;
+    std::shared_ptr<VirtualClock> clock;
+    uint64_t intervalUS;
+
+    const char* data;
+    std::size_t size, cursor, released;
+
+    NameRegistry columnNames;
+    std::vector<uint32_t> columnIndices; //handle in columnNames -> column in a row
+    uint32_t numColumns;
+
+    std::vector<double> currentRow, nextRow;
+    uint64_t currentRowIndex; //row that currentRow holds
+    bool nextRowValid, finished;
+    std::string lineBuffer;
+};
+
+//A single pin sensor that replays the column with the same name
+class ReplaySensor : public Sensor {
+public:
+    ReplaySensor(std::string name, std::shared_ptr<ReplayTrace> trace);
+protected:
+    void readFromSystem() override;
+private:
+    std::shared_ptr<ReplayTrace> trace;
+    uint32_t column;
+};
+
+//An input that replays the column with the same name until Maya writes to it
+class ReplayInput : public Input {
+public:
+    ReplayInput(std::string name, std::shared_ptr<ReplayTrace> trace, std::vector<double> allowed);
+protected:
+    void writeToSystem() override;
+    void readFromSystem() override;
+private:
+    std::shared_ptr<ReplayTrace> trace;
+    uint32_t column;
+    bool written;
+};
+
+#endif /* REPLAY_H */
@@ -0,0 +1,168 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/*
+ * File:   RingBuffer.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * A bounded, lock-free ring for exactly one producer thread and one consumer
+ * thread. The producer only moves the tail and the consumer only moves the head,
+ * so neither side ever blocks. One slot is always left empty to tell a full ring
+ * from an empty one. Items are copied in and out, so T must be default
+ * constructible and copy assignable.
+ */
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+template <typename T>
+class RingBuffer {
+public:
+
+    RingBuffer(std::size_t capacity) : slots(capacity + 1), head(0), tail(0) {
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    // Producer side. Returns false (and drops the item) if the ring is full.
+
+    bool push(const T& item) {
+        auto currTail = tail.load(std::memory_order_relaxed);
+        auto nextTail = increment(currTail);
+        if (nextTail == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        slots[currTail] = item;
+        tail.store(nextTail, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if there is nothing to read.
+
+    bool pop(T& item) {
+        auto currHead = head.load(std::memory_order_relaxed);
+        if (currHead == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = slots[currHead];
+        head.store(increment(currHead), std::memory_order_release);
+        return true;
+    }
+
+    // Batch versions, e.g., for a row of values that must be handed over together.
+    // Either all count items are moved or none are (if there isn't room or there
+    // aren't enough items), and the other side sees them only once all are in place.
+
+    bool push(const T* items, std::size_t count) {
+        auto currTail = tail.load(std::memory_order_relaxed);
+        if (used(head.load(std::memory_order_acquire), currTail) + count > capacity()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < count; i++) {
+            slots[currTail] = items[i];
+            currTail = increment(currTail);
+        }
+        tail.store(currTail, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T* items, std::size_t count) {
+        auto currHead = head.load(std::memory_order_relaxed);
+        if (used(currHead, tail.load(std::memory_order_acquire)) < count) {
+            return false;
+        }
+        for (std::size_t i = 0; i < count; i++) {
+            items[i] = slots[currHead];
+            currHead = increment(currHead);
+        }
+        head.store(currHead, std::memory_order_release);
+        return true;
+    }
+
+    // In-place versions, for items that own memory which should be reused instead of 
+    // copied. The producer fills the slot returned by claim() (nullptr if the ring is 
+    // full) and hands it over with commit(). The consumer reads the slot returned by 
+    // front() (nullptr if the ring is empty) and gives it back with release().
+
+    T* claim() {
+        auto currTail = tail.load(std::memory_order_relaxed);
+        if (increment(currTail) == head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &slots[currTail];
+    }
+
+    void commit() {
+        tail.store(increment(tail.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    T* front() {
+        auto currHead = head.load(std::memory_order_relaxed);
+        if (currHead == tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &slots[currHead];
+    }
+
+    void release() {
+        head.store(increment(head.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    // Set up every slot (e.g., reserve the memory of its items) before the ring is used.
+
+    template <typename F>
+    void initSlots(F init) {
+        for (auto& slot : slots) {
+            init(slot);
+        }
+    }
+
+    // Number of items currently held. Exact only when called from one of the two sides.
+
+    std::size_t size() const {
+        return used(head.load(std::memory_order_acquire), tail.load(std::memory_order_acquire));
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    std::size_t capacity() const {
+        return slots.size() - 1;
+    }
+
+private:
+
+    std::size_t increment(std::size_t idx) const {
+        return (idx + 1 == slots.size()) ? 0 : idx + 1;
+    }
+
+    std::size_t used(std::size_t currHead, std::size_t currTail) const {
+        return (currTail >= currHead) ? currTail - currHead : slots.size() - currHead + currTail;
+    }
+
+    std::vector<T> slots;
+    //keep the two indices on separate cache lines so the two threads don't false share
+    alignas(64) std::atomic<std::size_t> head;
+    alignas(64) std::atomic<std::size_t> tail;
+};
+
+#endif /* RINGBUFFER_H */
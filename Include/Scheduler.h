@@ -0,0 +1,79 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/*
+ * File:   Scheduler.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * Every sensor, input, controller and planner runs at its own period. The 
+ * RateScheduler ticks at the greatest common divisor of all the periods (the 
+ * base tick) and, at every tick, marks which tasks are due. Ticks are placed on 
+ * absolute deadlines so that the time spent running the tasks does not make 
+ * the periods drift. If a tick is missed because the previous one overran, the 
+ * scheduler skips to the next deadline and the tasks that were due in the 
+ * missed ticks run at the next one (once, not once for each missed tick).
+ * getRateMonotonicOrder() orders tasks by period, shortest first, so that the 
+ * fast and cheap tasks of a stage aren't held up by the slow ones.
+ * With a VirtualClock, the scheduler doesn't sleep. It sets the clock to the 
+ * time of each tick instead, so that simulations run as fast as possible.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <atomic>
+
+class VirtualClock {
+public:
+    uint64_t getTimeUS();
+    void setTimeUS(uint64_t newTimeUS);
+private:
+    std::atomic<uint64_t> timeUS{0};
+};
+
+class RateScheduler {
+public:
+    uint32_t addTask(uint32_t periodUS); //returns the id of the task
+    void useVirtualClock(std::shared_ptr<VirtualClock> clock_);
+    void start(); //all tasks are due until the first tick
+    void waitForNextTick();
+
+    bool isDue(uint32_t task) const;
+    bool isAnyDue(const std::vector<uint32_t>& tasks) const;
+    std::vector<uint32_t> getRateMonotonicOrder(const std::vector<uint32_t>& tasks) const; //positions in tasks
+
+    uint32_t getPeriodUS(uint32_t task) const;
+    uint32_t getBaseTickUS() const;
+    uint64_t getNumOverruns() const;
+    uint64_t getElapsedUS() const; //time from start() to the current tick
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<uint32_t> periodsUS;
+    std::vector<uint64_t> ticksPerPeriod, nextDueTicks;
+    std::vector<bool> due;
+    uint32_t baseTickUS = 0;
+    uint64_t tick = 0, numOverruns = 0;
+    Clock::time_point nextDeadline;
+    std::shared_ptr<VirtualClock> clock; //nullptr: run in real time
+};
+
+#endif /* SCHEDULER_H */
@@ -24,7 +24,8 @@
  * the appropriate system counters/files.
  * 
  * There are two sensors defined here: Time, Power. Other sensors can be used 
- * for other purposes if desired.
+ * for other purposes if desired. SampledCPUPowerSensor is a variant of the Power 
+ * sensor that samples the energy counters faster than the control period.
  */
 
 #ifndef SENSORS_H
@@ -38,6 +39,9 @@
 #include <vector>
 #include <linux/perf_event.h>
 #include <time.h>
+#include <thread>
+#include <atomic>
+#include "RingBuffer.h"
 
 class Sensor {
 public:
@@ -50,8 +54,20 @@ public:
 
     Sensor(std::string sname, std::initializer_list<std::string> pnames);
     Sensor(std::string sname);
+    virtual ~Sensor() = default;
     virtual void updateValuesFromSystem();
     std::string getName();
+    void setPeriodUS(uint32_t periodUS_);
+    uint32_t getPeriodUS();
+    void setPackage(int package_); //the package (socket) this reads or drives; -1 is the whole system
+    int getPackage();
+
+    /* All the sysfs and devfs paths used by sensors and inputs are prefixed with 
+     * the system root. It is empty by default (use the real /sys and /dev); set it 
+     * before creating any sensor to run against a fake tree (see FakeSysfs).
+     */
+    static void setSystemRoot(std::string root);
+    static std::string systemPath(std::string path);
 
     std::shared_ptr<OutputPort> out;
     Vector measureReadLatency(); //measure the delay of reading values from system
@@ -62,6 +78,11 @@ protected:
     Vector values, prevValues; //current values and previous values of sensors
     uint32_t width; //number of values, default is 1
     TimePoint sampleTime, prevSampleTime;
+    uint32_t periodUS = 0; //how often the Manager reads (or writes) this; 0 is every sampling interval
+    int package = -1;
+
+private:
+    static std::string systemRoot;
 };
 
 class Time : public Sensor {
@@ -74,18 +95,55 @@ private:
 
 };
 
+/* The power of both packages, or with a package, the power of that package alone 
+ * (its core domain if RAPL has one, else the package domain intel-rapl:<package>).
+ */
 class CPUPowerSensor : public Sensor {
 public:
-    CPUPowerSensor(std::string name);
+    CPUPowerSensor(std::string name, int package = -1);
 protected:
+    CPUPowerSensor(std::string name, std::initializer_list<std::string> pNames, int package);
+    void findEnergyFiles();
     void readFromSystem() override;
-private:
-    std::string coreEnergyDirName = "/sys/class/powercap/intel-rapl/intel-rapl:0/intel-rapl:0:0/",
-            pkgEnergyDirName1 = "/sys/class/powercap/intel-rapl/intel-rapl:0/",
-            pkgEnergyDirName2 = "/sys/class/powercap/intel-rapl/intel-rapl:1/",
+
+    std::string raplDirName = systemPath("/sys/class/powercap/intel-rapl/intel-rapl:"),
+            coreEnergyDirName = systemPath("/sys/class/powercap/intel-rapl/intel-rapl:0/intel-rapl:0:0/"),
+            pkgEnergyDirName1 = systemPath("/sys/class/powercap/intel-rapl/intel-rapl:0/"),
+            pkgEnergyDirName2 = systemPath("/sys/class/powercap/intel-rapl/intel-rapl:1/"),
             energyFilePrefix = "energy_uj";
     std::vector<std::string> energyFileNames;
     double energyCtr;
 };
 
+/* Reads the energy counters on a background thread every sampleIntervalUS 
+ * (RAPL updates roughly every 1 ms) and pushes the power over each sub-interval 
+ * into a lock-free ring. At every control period, the ring is drained and the 
+ * sensor reports four pins: <pinPrefix> (mean), <pinPrefix>Peak, <pinPrefix>Var 
+ * and <pinPrefix>LPF (a first-order low-pass filter with cutoff filterCutoffHz). 
+ * The port name must differ from pinPrefix so that controllers can pick single pins.
+ * The sampler of a package sensor runs on the CPUs of that package.
+ */
+class SampledCPUPowerSensor : public CPUPowerSensor {
+public:
+    SampledCPUPowerSensor(std::string name, std::string pinPrefix,
+            uint32_t sampleIntervalUS = 1000, double filterCutoffHz = 10.0,
+            uint32_t ringCapacity = 4096, int package = -1);
+    ~SampledCPUPowerSensor() override;
+protected:
+    void readFromSystem() override;
+private:
+    void sampleLoop();
+    double readEnergy(); //total energy in uJ, corrected for counter wraparound
+
+    std::vector<int> energyFds;
+    std::vector<double> lastEnergyReadings, maxEnergyRanges;
+    uint32_t sampleIntervalUS;
+    double filterAlpha, filteredPower;
+    bool filterPrimed;
+    RingBuffer<double> samples;
+    std::atomic<bool> stopSampling;
+    std::atomic<uint64_t> overflowCount;
+    std::thread sampler;
+};
+
 #endif /* SENSORS_H */
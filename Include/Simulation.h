@@ -0,0 +1,141 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/*
+ * File:   Simulation.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * Offline simulation: sensors and inputs backed by a plant model instead of the 
+ * real system, so that controllers and masks can be evaluated without root, 
+ * cpufreq, powerclamp or RAPL. The Manager advances a VirtualClock by one base 
+ * tick at a time instead of sleeping, so a simulation runs as fast as the 
+ * blocks can be computed.
+ * 
+ * The plant is a discrete LTI model (e.g., identified from Sysid logs) around an 
+ * operating point, with Gaussian noise on the outputs. Every step of the model 
+ * updates the state with the inputs held since the last step and then computes 
+ * the outputs from the new state and the same inputs:
+ *   x[k] = A x[k-1] + B (u[k] - u0)
+ *   y[k] = C x[k] + D (u[k] - u0) + y0 + noise[k]
+ * with x[0] = 0, u[0] = u0 and y[0] = y0. The estimators, the MPC controller and 
+ * the identified models of Sysid use the same convention.
+ * It is read from files named <prefix>_<name>.txt, like the controller files:
+ *   dimension, numInputs, numOutputs    sizes of x, u, y
+ *   A, B, C, D                          system matrices
+ *   periodUS                            time between two steps of the model
+ *   inputNames, outputNames             which input and sensor each entry of u and y is
+ *   inputOffsets, outputOffsets         u0 and y0
+ *   inputMin, inputMax, inputLevels     allowed values of each input (inputLevels 
+ *                                       evenly spaced values from min to max)
+ *   noise                               standard deviation of the noise on each output
+ * Inputs start at u0.
+ */
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "Sensors.h"
+#include "Inputs.h"
+#include "MathSupport.h"
+#include "Scheduler.h"
+#include "Random.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+/* Readers of the model files above. The plant model, the estimators and the MPC 
+ * controller (and the models they read that Sysid identified) all load their 
+ * models with them, so a file is checked in the same way wherever it is used. 
+ * Each exits with a message naming the file if it can't be opened or doesn't 
+ * have the expected number of entries.
+ */
+
+//The sizes of a model: dimension, numInputs and numOutputs, and the names of its inputs and outputs
+struct ModelShape {
+    uint32_t dimension, numInputs, numOutputs;
+    std::vector<std::string> inputNames, outputNames;
+};
+
+ModelShape readModelShape(std::string fileNamePrefix, uint32_t maxSize = UINT32_MAX); //each size between 1 and maxSize
+uint32_t readModelCount(std::string fileName, uint32_t maxCount = UINT32_MAX); //between 1 and maxCount
+std::vector<std::string> readModelNames(std::string fileName, uint32_t numNames);
+//rows x cols values into an array that has stride values per row (e.g., a fixed-size matrix)
+void readModelValues(double* values, std::string fileName, uint32_t rows, uint32_t cols, uint32_t stride);
+Vector readModelVector(std::string fileName, uint32_t size);
+Matrix readModelMatrix(std::string fileName, uint32_t rows, uint32_t cols);
+
+class PlantModel {
+public:
+    PlantModel(std::string fileNamePrefix, std::shared_ptr<VirtualClock> clock);
+
+    uint32_t getInputIndex(std::string name); //UINT32_MAX if the plant has no such input
+    uint32_t getOutputIndex(std::string name); //UINT32_MAX if the plant has no such output
+    std::vector<double> getAllowedInputValues(uint32_t index);
+
+    void setInput(uint32_t index, double value);
+    double getInput(uint32_t index);
+    double getOutput(uint32_t index); //advances the model to the current virtual time first
+
+    std::shared_ptr<VirtualClock> getClock();
+
+private:
+    void advance();
+    void step();
+
+    std::shared_ptr<VirtualClock> clock;
+    Matrix A, B, C, D;
+    Vector state, inputs, outputs;
+    Vector inputOffsets, outputOffsets, inputMin, inputMax, inputLevels, noiseStddev, noiseSamples;
+    std::vector<std::string> inputNames, outputNames;
+    uint64_t periodUS, lastStepTimeUS;
+
+    RandomStream noise;
+};
+
+class SimulatedTime : public Sensor {
+public:
+    SimulatedTime(std::string name, std::shared_ptr<VirtualClock> clock);
+protected:
+    void readFromSystem() override;
+private:
+    std::shared_ptr<VirtualClock> clock;
+};
+
+//A single pin sensor that reads the plant output with the same name
+class SimulatedSensor : public Sensor {
+public:
+    SimulatedSensor(std::string name, std::shared_ptr<PlantModel> plant);
+protected:
+    void readFromSystem() override;
+private:
+    std::shared_ptr<PlantModel> plant;
+    uint32_t outputIndex;
+};
+
+//An input that drives the plant input with the same name
+class SimulatedInput : public Input {
+public:
+    SimulatedInput(std::string name, std::shared_ptr<PlantModel> plant);
+protected:
+    void writeToSystem() override;
+    void readFromSystem() override;
+private:
+    std::shared_ptr<PlantModel> plant;
+    uint32_t inputIndex;
+};
+
+#endif /* SIMULATION_H */
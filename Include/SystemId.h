@@ -0,0 +1,83 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   SystemId.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * Identifies a model of the system while Sysid mode excites it. Every sysid
+ * period, the outputs are fitted to an ARX model with na >= 1 past outputs and nb >= 1
+ * inputs (the one applied until the outputs were measured and nb - 1 earlier ones):
+ *   y[k] = A1 y[k-1] + ... + Ana y[k-na] + B0 u[k] + ... + B(nb-1) u[k-nb+1] + c
+ * by recursive least squares, with an optional forgetting factor. All outputs
+ * share the regressor, so one period is one rank-1 update of its covariance
+ * and of the parameters, with no allocation: O(n^2) for n = na outputs + nb
+ * inputs + 1 regressors. The inputs are scaled to [-1, 1] over their ranges so
+ * that the frequency (in kHz) and the percentages are fitted equally well.
+ *
+ * The fit of each output is 100 (1 - |e| / |y - mean(y)|) over the one step
+ * ahead prediction errors e, after the first warmupFactor x n periods. At the end
+ * of the run, the model is written in the plant model files of the Simulate
+ * backend (see Simulation.h), so it can be simulated and used by the
+ * KalmanFilter and the MPC controller directly. Its state is the na last outputs
+ * and the nb - 1 last inputs, relative to the middle of the input ranges (u0)
+ * and the outputs there (y0); the noise is the standard deviation of the
+ * prediction errors.
+ */
+
+#ifndef SYSTEMID_H
+#define SYSTEMID_H
+
+#include "Abstractions.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <ostream>
+
+const uint32_t maxSystemIdLags = 16;
+const double defaultSystemIdForgetting = 1.0; //no forgetting
+
+class SystemIdentifier {
+public:
+    SystemIdentifier(std::vector<std::string> outputNames, std::vector<std::string> inputNames,
+            std::vector<double> inputMinVals, std::vector<double> inputMaxVals, std::vector<uint32_t> inputLevels,
+            uint32_t periodUS, uint32_t na = 1, uint32_t nb = 1, double forgetting = defaultSystemIdForgetting);
+    void update(); //one period: the values on the ports were measured together
+    void report(std::ostream& out); //the fit of each output
+    bool writeModel(std::string fileNamePrefix); //false if the model has an integrator (no y0)
+    double getFit(uint32_t output); //in %; 0 before the warmup ends
+    uint64_t getNumSamples();
+    std::shared_ptr<InputPort> outputVals, inputVals;
+private:
+    uint32_t numOutputs, numInputs, na, nb, numRegressors;
+    std::vector<std::string> outputNames, inputNames;
+    std::vector<double> inputMinVals, inputMaxVals, inputMids, inputHalfRanges;
+    std::vector<uint32_t> inputLevels;
+    uint32_t periodUS;
+    double forgetting;
+
+    std::vector<double> P; //numRegressors x numRegressors
+    std::vector<double> theta; //numOutputs x numRegressors
+    std::vector<double> regressor, gain, Pphi;
+    std::vector<double> pastOutputs, pastInputs; //newest first: na x numOutputs, nb x numInputs (normalized)
+    std::vector<double> outputs, inputs;
+    uint64_t numUpdates, numSamples;
+
+    //fit statistics after the warmup
+    std::vector<double> sumErrors2, sumOutputs, sumOutputs2;
+};
+
+#endif /* SYSTEMID_H */
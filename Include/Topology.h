@@ -0,0 +1,43 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   Topology.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * The packages (sockets) of the machine and the CPUs of each, read from
+ * cpu<n>/topology/physical_package_id of the present CPUs (under the system
+ * root, see Sensor::setSystemRoot). Packages are numbered 0, 1, ... in the order
+ * of their ids, which is also the order of the RAPL package domains
+ * (intel-rapl:<package>). If the topology can't be read, all CPUs are in package 0.
+ */
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <cstdint>
+
+std::vector<uint32_t> parseCPUList(std::string list); //e.g., 0-3,8-11
+std::vector<std::vector<uint32_t>> getPackageCPUs(); //the CPUs of each package
+uint32_t getNumPackages();
+
+//Restrict a thread to the given CPUs; false if the system refused (e.g., CPUs of a fake tree)
+bool pinThreadToCPUs(std::thread& thread, const std::vector<uint32_t>& cpus);
+
+#endif /* TOPOLOGY_H */
@@ -0,0 +1,77 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/* 
+ * File:   WorkerPool.h
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * A small work-stealing thread pool used by the Manager to run independent blocks 
+ * (planners, controllers) of one period in parallel. Each worker (and the calling 
+ * thread) has its own task queue. A worker takes tasks from the back of its own 
+ * queue and, when it runs out, steals from the front of the other queues. 
+ * runAll() returns only when every task of the batch has completed, so it can be 
+ * used as a barrier between dependent groups of blocks.
+ * Workers can be pinned to sets of CPUs (e.g., the CPUs of one package), and a task 
+ * can be given to one worker, which alone runs it; such tasks are never stolen.
+ */
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+class WorkerPool {
+public:
+    static const uint32_t anyWorker = UINT32_MAX;
+
+    //worker i runs on workerCPUs[i] if it is given and not empty
+    WorkerPool(uint32_t numWorkers, std::vector<std::vector<uint32_t>> workerCPUs = {});
+    ~WorkerPool();
+
+    void runAll(std::vector<std::function<void()>>& tasks);
+    //tasks[i] runs on worker workerIds[i], or on any thread if it is anyWorker (or not given)
+    void runAll(std::vector<std::function<void()>>& tasks, const std::vector<uint32_t>& workerIds);
+    uint32_t getNumWorkers();
+
+private:
+    struct TaskQueue {
+        std::mutex lock;
+        std::deque<std::function<void()>*> tasks;
+        std::deque<std::function<void()>*> pinnedTasks; //only for the owner of the queue
+    };
+
+    void workerLoop(uint32_t queueId);
+    bool runOneTask(uint32_t queueId); //run own (pinned first) task or steal one; false if nothing was found
+
+    std::vector<std::unique_ptr<TaskQueue>> queues; //one per worker, the last one for the caller
+    std::vector<std::thread> workers;
+    std::atomic<uint32_t> pendingTasks;
+
+    std::mutex wakeupLock;
+    std::condition_variable wakeup;
+    uint64_t batchNum;
+    bool stopping;
+};
+
+#endif /* WORKERPOOL_H */
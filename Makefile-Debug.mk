@@ -7,17 +7,36 @@ OBJECTDIR=${BUILDDIR}/${CONF}
 # Object Files
 OBJECTFILES= \
         ${OBJECTDIR}/Source/Abstractions.o \
+        ${OBJECTDIR}/Source/Calibrator.o \
+        ${OBJECTDIR}/Source/Config.o \
         ${OBJECTDIR}/Source/Controller.o \
+        ${OBJECTDIR}/Source/Estimator.o \
+        ${OBJECTDIR}/Source/Excitation.o \
         ${OBJECTDIR}/Source/Inputs.o \
+        ${OBJECTDIR}/Source/LogHeader.o \
         ${OBJECTDIR}/Source/Manager.o \
+        ${OBJECTDIR}/Source/MarkovChain.o \
         ${OBJECTDIR}/Source/MathSupport.o \
+        ${OBJECTDIR}/Source/MPCController.o \
+        ${OBJECTDIR}/Source/NameRegistry.o \
         ${OBJECTDIR}/Source/Planner.o \
+        ${OBJECTDIR}/Source/PresetSource.o \
+        ${OBJECTDIR}/Source/Random.o \
+        ${OBJECTDIR}/Source/Replay.o \
+        ${OBJECTDIR}/Source/Scheduler.o \
         ${OBJECTDIR}/Source/Sensors.o \
+        ${OBJECTDIR}/Source/Simulation.o \
+        ${OBJECTDIR}/Source/SystemId.o \
+        ${OBJECTDIR}/Source/Topology.o \
+        ${OBJECTDIR}/Source/WorkerPool.o \
         ${OBJECTDIR}/Source/main.o
 
 BALLOONOBJ=${OBJECTDIR}/Balloon/Balloon.o
+FAKESYSFSOBJ=${OBJECTDIR}/FakeSysfs/FakeSysfs.o
+MARKOVTRAINOBJ=${OBJECTDIR}/Tools/MarkovTrain.o
+MARKOVTRAINOBJECTFILES=${MARKOVTRAINOBJ} ${OBJECTDIR}/Source/LogHeader.o
 
-# C Compiler Flags; Used for Balloon
+# C Compiler Flags; Used for Balloon and FakeSysfs
 CFLAGS=-O2 -fopenmp
 
 # CC Compiler Flags
@@ -28,10 +47,10 @@ CXXFLAGS=-DDEBUG -g -IInclude -std=c++14
 ASFLAGS=
 
 # Link Libraries and Options
-LDLIBSOPTIONS=
+LDLIBSOPTIONS=-pthread
 
 # Build Targets
-.build-conf: .balloon-build
+.build-conf: .balloon-build .fakesysfs-build .markovtrain-build
 	"${MAKE}"  -f Makefile-${CONF}.mk ${DISTDIR}/${CONF}/${PROJECTNAME}
 
 ${DISTDIR}/${CONF}/${PROJECTNAME}: ${OBJECTFILES}
@@ -53,6 +72,11 @@ ${OBJECTDIR}/Source/Inputs.o: Source/Inputs.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Inputs.o Source/Inputs.cpp
 
+${OBJECTDIR}/Source/LogHeader.o: Source/LogHeader.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/LogHeader.o Source/LogHeader.cpp
+
 ${OBJECTDIR}/Source/Manager.o: Source/Manager.cpp
 	${MKDIR} -p ${OBJECTDIR}/Source
 	${RM} "$@.d"
@@ -73,6 +97,81 @@ ${OBJECTDIR}/Source/Sensors.o: Source/Sensors.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Sensors.o Source/Sensors.cpp
 
+${OBJECTDIR}/Source/WorkerPool.o: Source/WorkerPool.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/WorkerPool.o Source/WorkerPool.cpp
+
+${OBJECTDIR}/Source/NameRegistry.o: Source/NameRegistry.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/NameRegistry.o Source/NameRegistry.cpp
+
+${OBJECTDIR}/Source/Config.o: Source/Config.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Config.o Source/Config.cpp
+
+${OBJECTDIR}/Source/Scheduler.o: Source/Scheduler.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Scheduler.o Source/Scheduler.cpp
+
+${OBJECTDIR}/Source/Simulation.o: Source/Simulation.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Simulation.o Source/Simulation.cpp
+
+${OBJECTDIR}/Source/Replay.o: Source/Replay.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Replay.o Source/Replay.cpp
+
+${OBJECTDIR}/Source/PresetSource.o: Source/PresetSource.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/PresetSource.o Source/PresetSource.cpp
+
+${OBJECTDIR}/Source/Random.o: Source/Random.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Random.o Source/Random.cpp
+
+${OBJECTDIR}/Source/MarkovChain.o: Source/MarkovChain.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/MarkovChain.o Source/MarkovChain.cpp
+
+${OBJECTDIR}/Source/Estimator.o: Source/Estimator.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Estimator.o Source/Estimator.cpp
+
+${OBJECTDIR}/Source/MPCController.o: Source/MPCController.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/MPCController.o Source/MPCController.cpp
+
+${OBJECTDIR}/Source/SystemId.o: Source/SystemId.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/SystemId.o Source/SystemId.cpp
+
+${OBJECTDIR}/Source/Calibrator.o: Source/Calibrator.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Calibrator.o Source/Calibrator.cpp
+
+${OBJECTDIR}/Source/Excitation.o: Source/Excitation.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Excitation.o Source/Excitation.cpp
+
+${OBJECTDIR}/Source/Topology.o: Source/Topology.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Topology.o Source/Topology.cpp
+
 ${OBJECTDIR}/Source/main.o: Source/main.cpp
 	${MKDIR} -p ${OBJECTDIR}/Source
 	${RM} "$@.d"
@@ -95,6 +194,30 @@ ${BALLOONOBJ}: ${BALLOONDIR}/Balloon.c
 	${RM} "$@.d"
 	$(COMPILE.c) -g -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Balloon/Balloon.o ${BALLOONDIR}/Balloon.c
 
+.fakesysfs-build:
+	"${MAKE}"  -f Makefile-${CONF}.mk ${DISTDIR}/${CONF}/FAKESYSFS
+
+${DISTDIR}/${CONF}/FAKESYSFS: ${FAKESYSFSOBJ}
+	${MKDIR} -p ${DISTDIR}/${CONF}
+	${LINK.c} -o ${DISTDIR}/${CONF}/FakeSysfs ${FAKESYSFSOBJ} ${LDLIBSOPTIONS} -lm
+
+${FAKESYSFSOBJ}: ${FAKESYSFSDIR}/FakeSysfs.c
+	${MKDIR} -p ${OBJECTDIR}/FakeSysfs
+	${RM} "$@.d"
+	$(COMPILE.c) -g -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/FakeSysfs/FakeSysfs.o ${FAKESYSFSDIR}/FakeSysfs.c
+
+.markovtrain-build:
+	"${MAKE}"  -f Makefile-${CONF}.mk ${DISTDIR}/${CONF}/MarkovTrain
+
+${DISTDIR}/${CONF}/MarkovTrain: ${MARKOVTRAINOBJECTFILES}
+	${MKDIR} -p ${DISTDIR}/${CONF}
+	${LINK.cc} -o ${DISTDIR}/${CONF}/MarkovTrain ${MARKOVTRAINOBJECTFILES} ${LDLIBSOPTIONS}
+
+${MARKOVTRAINOBJ}: ${TOOLSDIR}/MarkovTrain.cpp
+	${MKDIR} -p ${OBJECTDIR}/Tools
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Tools/MarkovTrain.o ${TOOLSDIR}/MarkovTrain.cpp
+
 # Enable dependency checking
 .dep.inc: .depcheck-impl
 
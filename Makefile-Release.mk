@@ -7,17 +7,46 @@ OBJECTDIR=${BUILDDIR}/${CONF}
 # Object Files
 OBJECTFILES= \
         ${OBJECTDIR}/Source/Abstractions.o \
+        ${OBJECTDIR}/Source/Calibrator.o \
+        ${OBJECTDIR}/Source/Config.o \
         ${OBJECTDIR}/Source/Controller.o \
+        ${OBJECTDIR}/Source/Estimator.o \
+        ${OBJECTDIR}/Source/Excitation.o \
         ${OBJECTDIR}/Source/Inputs.o \
+        ${OBJECTDIR}/Source/LogHeader.o \
         ${OBJECTDIR}/Source/Manager.o \
+        ${OBJECTDIR}/Source/MarkovChain.o \
         ${OBJECTDIR}/Source/MathSupport.o \
+        ${OBJECTDIR}/Source/MPCController.o \
+        ${OBJECTDIR}/Source/NameRegistry.o \
         ${OBJECTDIR}/Source/Planner.o \
+        ${OBJECTDIR}/Source/PresetSource.o \
+        ${OBJECTDIR}/Source/Random.o \
+        ${OBJECTDIR}/Source/Replay.o \
+        ${OBJECTDIR}/Source/Scheduler.o \
         ${OBJECTDIR}/Source/Sensors.o \
+        ${OBJECTDIR}/Source/Simulation.o \
+        ${OBJECTDIR}/Source/SystemId.o \
+        ${OBJECTDIR}/Source/Topology.o \
+        ${OBJECTDIR}/Source/WorkerPool.o \
         ${OBJECTDIR}/Source/main.o
 
 BALLOONOBJ=${OBJECTDIR}/Balloon/Balloon.o
+FAKESYSFSOBJ=${OBJECTDIR}/FakeSysfs/FakeSysfs.o
+MARKOVTRAINOBJ=${OBJECTDIR}/Tools/MarkovTrain.o
+MARKOVTRAINOBJECTFILES=${MARKOVTRAINOBJ} ${OBJECTDIR}/Source/LogHeader.o
 
-# C Compiler Flags; Used for Balloon
+# The benchmark links everything except main
+BENCHMARKOBJ=${OBJECTDIR}/Benchmark/Benchmark.o
+BENCHMARKOBJECTFILES=$(filter-out ${OBJECTDIR}/Source/main.o,${OBJECTFILES}) ${BENCHMARKOBJ}
+
+# So do the tests, one program each
+TESTOBJ=${OBJECTDIR}/Tests/SystemIdTest.o
+REPLAYTESTOBJ=${OBJECTDIR}/Tests/ReplayTest.o
+TESTLIBOBJECTFILES=$(filter-out ${OBJECTDIR}/Source/main.o,${OBJECTFILES})
+TESTOBJECTFILES=${TESTLIBOBJECTFILES} ${TESTOBJ} ${REPLAYTESTOBJ}
+
+# C Compiler Flags; Used for Balloon and FakeSysfs
 CFLAGS=-O2 -fopenmp
 
 # CC Compiler Flags
@@ -28,10 +57,10 @@ CXXFLAGS=
 ASFLAGS=
 
 # Link Libraries and Options
-LDLIBSOPTIONS=
+LDLIBSOPTIONS=-pthread
 
 # Build Targets
-.build-conf: .balloon-build
+.build-conf: .balloon-build .fakesysfs-build .markovtrain-build
 	"${MAKE}"  -f Makefile-${CONF}.mk ${DISTDIR}/${CONF}/${PROJECTNAME}
 
 ${DISTDIR}/${CONF}/${PROJECTNAME}: ${OBJECTFILES}
@@ -53,6 +82,11 @@ ${OBJECTDIR}/Source/Inputs.o: Source/Inputs.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Inputs.o Source/Inputs.cpp
 
+${OBJECTDIR}/Source/LogHeader.o: Source/LogHeader.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/LogHeader.o Source/LogHeader.cpp
+
 ${OBJECTDIR}/Source/Manager.o: Source/Manager.cpp
 	${MKDIR} -p ${OBJECTDIR}/Source
 	${RM} "$@.d"
@@ -73,6 +107,81 @@ ${OBJECTDIR}/Source/Sensors.o: Source/Sensors.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Sensors.o Source/Sensors.cpp
 
+${OBJECTDIR}/Source/WorkerPool.o: Source/WorkerPool.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/WorkerPool.o Source/WorkerPool.cpp
+
+${OBJECTDIR}/Source/NameRegistry.o: Source/NameRegistry.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/NameRegistry.o Source/NameRegistry.cpp
+
+${OBJECTDIR}/Source/Config.o: Source/Config.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Config.o Source/Config.cpp
+
+${OBJECTDIR}/Source/Scheduler.o: Source/Scheduler.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Scheduler.o Source/Scheduler.cpp
+
+${OBJECTDIR}/Source/Simulation.o: Source/Simulation.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Simulation.o Source/Simulation.cpp
+
+${OBJECTDIR}/Source/Replay.o: Source/Replay.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Replay.o Source/Replay.cpp
+
+${OBJECTDIR}/Source/PresetSource.o: Source/PresetSource.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/PresetSource.o Source/PresetSource.cpp
+
+${OBJECTDIR}/Source/Random.o: Source/Random.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Random.o Source/Random.cpp
+
+${OBJECTDIR}/Source/MarkovChain.o: Source/MarkovChain.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/MarkovChain.o Source/MarkovChain.cpp
+
+${OBJECTDIR}/Source/Estimator.o: Source/Estimator.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Estimator.o Source/Estimator.cpp
+
+${OBJECTDIR}/Source/MPCController.o: Source/MPCController.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/MPCController.o Source/MPCController.cpp
+
+${OBJECTDIR}/Source/SystemId.o: Source/SystemId.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/SystemId.o Source/SystemId.cpp
+
+${OBJECTDIR}/Source/Calibrator.o: Source/Calibrator.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Calibrator.o Source/Calibrator.cpp
+
+${OBJECTDIR}/Source/Excitation.o: Source/Excitation.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Excitation.o Source/Excitation.cpp
+
+${OBJECTDIR}/Source/Topology.o: Source/Topology.cpp
+	${MKDIR} -p ${OBJECTDIR}/Source
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Source/Topology.o Source/Topology.cpp
+
 ${OBJECTDIR}/Source/main.o: Source/main.cpp
 	${MKDIR} -p ${OBJECTDIR}/Source
 	${RM} "$@.d"
@@ -95,6 +204,65 @@ ${BALLOONOBJ}: ${BALLOONDIR}/Balloon.c
 	${RM} "$@.d"
 	$(COMPILE.c) -g -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Balloon/Balloon.o ${BALLOONDIR}/Balloon.c
 
+.fakesysfs-build:
+	"${MAKE}"  -f Makefile-${CONF}.mk ${DISTDIR}/${CONF}/FAKESYSFS
+
+${DISTDIR}/${CONF}/FAKESYSFS: ${FAKESYSFSOBJ}
+	${MKDIR} -p ${DISTDIR}/${CONF}
+	${LINK.c} -o ${DISTDIR}/${CONF}/FakeSysfs ${FAKESYSFSOBJ} ${LDLIBSOPTIONS} -lm
+
+${FAKESYSFSOBJ}: ${FAKESYSFSDIR}/FakeSysfs.c
+	${MKDIR} -p ${OBJECTDIR}/FakeSysfs
+	${RM} "$@.d"
+	$(COMPILE.c) -g -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/FakeSysfs/FakeSysfs.o ${FAKESYSFSDIR}/FakeSysfs.c
+
+.markovtrain-build:
+	"${MAKE}"  -f Makefile-${CONF}.mk ${DISTDIR}/${CONF}/MarkovTrain
+
+${DISTDIR}/${CONF}/MarkovTrain: ${MARKOVTRAINOBJECTFILES}
+	${MKDIR} -p ${DISTDIR}/${CONF}
+	${LINK.cc} -o ${DISTDIR}/${CONF}/MarkovTrain ${MARKOVTRAINOBJECTFILES} ${LDLIBSOPTIONS}
+
+${MARKOVTRAINOBJ}: ${TOOLSDIR}/MarkovTrain.cpp
+	${MKDIR} -p ${OBJECTDIR}/Tools
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Tools/MarkovTrain.o ${TOOLSDIR}/MarkovTrain.cpp
+
+.benchmark-conf: .build-conf
+	"${MAKE}"  -f Makefile-${CONF}.mk ${DISTDIR}/${CONF}/Benchmark
+
+${DISTDIR}/${CONF}/Benchmark: ${BENCHMARKOBJECTFILES}
+	${MKDIR} -p ${DISTDIR}/${CONF}
+	${LINK.cc} -o ${DISTDIR}/${CONF}/Benchmark ${BENCHMARKOBJECTFILES} ${LDLIBSOPTIONS}
+
+${BENCHMARKOBJ}: ${BENCHMARKDIR}/Benchmark.cpp
+	${MKDIR} -p ${OBJECTDIR}/Benchmark
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Benchmark/Benchmark.o ${BENCHMARKDIR}/Benchmark.cpp
+
+.test-conf: .build-conf
+	"${MAKE}"  -f Makefile-${CONF}.mk ${DISTDIR}/${CONF}/SystemIdTest ${DISTDIR}/${CONF}/ReplayTest
+	${DISTDIR}/${CONF}/SystemIdTest
+	${DISTDIR}/${CONF}/ReplayTest
+
+${DISTDIR}/${CONF}/SystemIdTest: ${TESTLIBOBJECTFILES} ${TESTOBJ}
+	${MKDIR} -p ${DISTDIR}/${CONF}
+	${LINK.cc} -o ${DISTDIR}/${CONF}/SystemIdTest ${TESTLIBOBJECTFILES} ${TESTOBJ} ${LDLIBSOPTIONS}
+
+${DISTDIR}/${CONF}/ReplayTest: ${TESTLIBOBJECTFILES} ${REPLAYTESTOBJ}
+	${MKDIR} -p ${DISTDIR}/${CONF}
+	${LINK.cc} -o ${DISTDIR}/${CONF}/ReplayTest ${TESTLIBOBJECTFILES} ${REPLAYTESTOBJ} ${LDLIBSOPTIONS}
+
+${TESTOBJ}: ${TESTSDIR}/SystemIdTest.cpp
+	${MKDIR} -p ${OBJECTDIR}/Tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Tests/SystemIdTest.o ${TESTSDIR}/SystemIdTest.cpp
+
+${REPLAYTESTOBJ}: ${TESTSDIR}/ReplayTest.cpp
+	${MKDIR} -p ${OBJECTDIR}/Tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -IInclude -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Tests/ReplayTest.o ${TESTSDIR}/ReplayTest.cpp
+
 # Enable dependency checking
 .dep.inc: .depcheck-impl
 
@@ -0,0 +1,21 @@
+#!/bin/sh
+#
+# File:   PresetsToBinary.sh
+# Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+#
+
+# Convert the text targets of a Preset mask (<prefix>_presets.txt, whitespace 
+# separated values) into <prefix>_presets.bin (native doubles, row after row). 
+# Maya memory maps the binary file when it exists, so long masks open instantly.
+
+if [ "$#" -ne 1 ]; then
+    echo "Usage: $0 <directory>/<file prefix>"
+    exit 1
+fi
+
+if [ ! -f "$1_presets.txt" ]; then
+    echo "$1_presets.txt does not exist"
+    exit 1
+fi
+
+perl -ne 'print pack("d*", split)' "$1_presets.txt" > "$1_presets.bin"
@@ -28,7 +28,11 @@ Pin::Pin(std::string name_) : Pin(name_, 0.0) {
 
 }
 
-Pin::Pin(std::string name_, double value) : name(name_), value(value), connected(false) {
+Pin::Pin(std::string name_, double value) : name(name_), value(value), connected(false),
+valueUnread(false),
+valueSlot(&this->value),
+unreadSlot(&valueUnread),
+slotIndex(UINT32_MAX) {
 }
 
 auto Pin::getName() {
@@ -36,8 +40,8 @@ auto Pin::getName() {
 }
 
 auto Pin::getValue() {
-    valueUnread = false;
-    return value;
+    *unreadSlot = false;
+    return *valueSlot;
 }
 
 auto Pin::isConnected() {
@@ -45,7 +49,7 @@ auto Pin::isConnected() {
 }
 
 auto Pin::isValueUnread() {
-    return valueUnread;
+    return *unreadSlot;
 }
 
 void Pin::setName(std::string name_) {
@@ -53,8 +57,8 @@ void Pin::setName(std::string name_) {
 }
 
 void Pin::setValue(double value_) {
-    value = value_;
-    valueUnread = true;
+    *valueSlot = value_;
+    *unreadSlot = true;
 }
 
 void Pin::setConnected() {
@@ -68,7 +72,7 @@ Port::Port(std::string portName_) : Port(portName_,{}) {
 Port::Port(std::string portName, std::initializer_list<std::string> pinNames) :
 portName(portName) {
     for (auto& pinName : pinNames) {
-        pins.push_back(std::make_unique<Pin>(pinName));
+        addPin(pinName);
     }
 #ifdef DEBUG
     std::cout << "port width " << pins.size() << std::endl;
@@ -79,11 +83,7 @@ auto Port::getName() {
     return portName;
 }
 
-std::vector<std::string> Port::getPinNames() {
-    std::vector<std::string> pinNames;
-    for (auto& pin : pins) {
-        pinNames.push_back(pin->getName());
-    }
+const std::vector<std::string>& Port::getPinNames() {
     return pinNames;
 }
 
@@ -93,12 +93,9 @@ auto Port::getPinName(uint32_t pinNum) {
 }
 
 auto Port::getPinNum(std::string pinName) {
-    uint32_t pinNum = 0;
-    for (auto& pin : pins) {
-        if (pinName.compare(pin->getName()) == 0) {
-            return pinNum;
-        }
-        pinNum++;
+    auto it = pinNumIndex.find(pinName);
+    if (it != pinNumIndex.end()) {
+        return it->second;
     }
     std::cout << "Pin with name " << pinName << " does not exist in Port " <<
             portName << std::endl;
@@ -128,12 +125,14 @@ void Port::sanitizePinNums(std::vector<uint32_t> pinNumList) {
 }
 
 void Port::addPin(std::string pinName) {
+    pinNumIndex.emplace(pinName, pins.size());
+    pinNames.push_back(pinName);
     pins.push_back(std::make_unique<Pin>(pinName));
 }
 
-void Port::addPin(std::vector<std::string> pinNames) {
-    for (auto& pinName : pinNames) {
-        pins.push_back(std::make_unique<Pin>(pinName));
+void Port::addPin(std::vector<std::string> newPinNames) {
+    for (auto& pinName : newPinNames) {
+        addPin(pinName);
     }
 }
 
@@ -168,7 +167,11 @@ Vector OutputPort::transmitValues(std::vector<std::string> pinNames) {
 }
 
 Vector OutputPort::transmitValues() {
-    return transmitValues(getPinNames());
+    Vector result(pins.size());
+    for (uint32_t i = 0; i < pins.size(); i++) {
+        result[i] = pins[i]->getValue();
+    }
+    return result;
 }
 
 void OutputPort::updateValuesToPort(Vector newValues) {
@@ -182,6 +185,12 @@ void OutputPort::updateValuesToPort(Vector newValues) {
     }
 }
 
+void OutputPort::updateValuesToPort(const double* newValues) {
+    for (uint32_t i = 0; i < pins.size(); i++) {
+        pins[i]->setValue(newValues[i]);
+    }
+}
+
 void OutputPort::setConnected(std::vector<uint32_t> pinNums) {
     sanitizePinNums(pinNums);
     for (auto pinNum : pinNums) {
@@ -224,6 +233,12 @@ Vector InputPort::updateValuesFromPort() {
 
 }
 
+void InputPort::updateValuesFromPort(double* values) {
+    for (uint32_t i = 0; i < pins.size(); i++) {
+        values[i] = pins[i]->getValue();
+    }
+}
+
 void InputPort::receiveValues(std::vector<uint32_t> pinNums, Vector newValues) {
     sanitizePinNums(pinNums);
     uint32_t i = 0;
@@ -235,14 +250,20 @@ void InputPort::receiveValues(std::vector<uint32_t> pinNums, Vector newValues) {
 
 void InputPort::receiveValues(std::vector<std::string> pinNames, Vector newValues) {
     std::vector<uint32_t> pinNums;
-    for (auto pinName : pinNames) {
+    for (auto& pinName : pinNames) {
         pinNums.push_back(getPinNum(pinName));
     }
     receiveValues(pinNums, newValues);
 }
 
 void InputPort::receiveValues(Vector newValues) {
-    receiveValues(getPinNames(), newValues);
+    if (newValues.size() != pins.size()) {
+        std::cout << "Values received must match available pins." << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    for (uint32_t i = 0; i < pins.size(); i++) {
+        pins[i]->setValue(newValues[i]);
+    }
 }
 
 bool InputPort::areValuesUnread() {
@@ -363,4 +384,103 @@ void Wire::transfer() {
     }
 }
 
+std::shared_ptr<OutputPort> Wire::getSrcPort() {
+    return srcPort;
+}
 
+std::shared_ptr<InputPort> Wire::getDestPort() {
+    return destPort;
+}
+
+void WiringPlan::compile(std::vector<std::shared_ptr<Port>> ports) {
+    if (compiled) {
+        std::cout << "Wiring plan is already compiled" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    uint32_t numPins = 0;
+    for (auto& port : ports) {
+        numPins += port->pins.size();
+    }
+    //size the storage once; pins keep pointers into it
+    values.assign(numPins, 0.0);
+    unreadFlags = std::make_unique<bool[]>(numPins);
+
+    uint32_t slot = 0;
+    for (auto& port : ports) {
+        for (auto& pin : port->pins) {
+            if (pin->slotIndex != UINT32_MAX) {
+                std::cout << "Pin " << pin->getName() << " of port " << port->getName() <<
+                        " is already in a wiring plan" << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+            values[slot] = *pin->valueSlot;
+            unreadFlags[slot] = *pin->unreadSlot;
+            pin->valueSlot = &values[slot];
+            pin->unreadSlot = &unreadFlags[slot];
+            pin->slotIndex = slot;
+            slot++;
+        }
+    }
+    compiled = true;
+#ifdef DEBUG
+    std::cout << "Compiled " << numPins << " pins of " << ports.size() << " ports" << std::endl;
+#endif
+}
+
+uint32_t WiringPlan::getSlot(Port* port, uint32_t pinNum) {
+    auto slot = port->pins[pinNum]->slotIndex;
+    if (slot == UINT32_MAX) {
+        std::cout << "Pin " << port->pins[pinNum]->getName() << " of port " << port->getName() <<
+                " was not compiled into the wiring plan" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return slot;
+}
+
+uint32_t WiringPlan::addRoute(std::vector<std::unique_ptr<Wire>>& routeWires) {
+    if (!compiled) {
+        std::cout << "Wiring plan must be compiled before adding routes" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    Route route;
+    route.firstWire = wires.size();
+    for (auto& wire : routeWires) {
+        CompiledWire compiledWire;
+        compiledWire.firstCopy = copies.size();
+        for (uint32_t i = 0; i < wire->srcPinNumList.size(); i++) {
+            PinCopy copy;
+            copy.src = getSlot(wire->srcPort.get(), wire->srcPinNumList[i]);
+            copy.dest = getSlot(wire->destPort.get(), wire->destPinNumList[i]);
+            copies.push_back(copy);
+        }
+        compiledWire.lastCopy = copies.size();
+        compiledWire.delay = wire->delay;
+        compiledWire.cycles = wire->cycles;
+        wires.push_back(compiledWire);
+    }
+    route.lastWire = wires.size();
+    routes.push_back(route);
+    return routes.size() - 1;
+}
+
+void WiringPlan::transfer(uint32_t routeId) {
+    auto& route = routes[routeId];
+    for (auto w = route.firstWire; w < route.lastWire; w++) {
+        auto& wire = wires[w];
+        if (wire.cycles != wire.delay) {
+            wire.cycles++;
+            continue;
+        }
+        wire.cycles = 0;
+        for (auto c = wire.firstCopy; c < wire.lastCopy; c++) {
+            auto& copy = copies[c];
+            values[copy.dest] = values[copy.src];
+            unreadFlags[copy.src] = false;
+            unreadFlags[copy.dest] = true;
+        }
+    }
+}
+
+bool WiringPlan::isCompiled() {
+    return compiled;
+}
@@ -0,0 +1,197 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   Calibrator.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "Calibrator.h"
+#include "debug.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+Calibrator::Calibrator(std::string outputName, std::vector<std::string> inputNames, std::vector<double> inputMinVals,
+        std::vector<double> inputMaxVals, uint32_t window, double tolerance, uint32_t maxWindows) :
+outputVals(std::make_shared<InputPort>("outputVals")),
+outputName(outputName),
+inputNames(inputNames),
+inputMinVals(inputMinVals),
+inputMaxVals(inputMaxVals),
+numInputs(inputNames.size()),
+window(window),
+maxWindows(maxWindows),
+tolerance(tolerance),
+stage(Stage::Base),
+currInput(0),
+setting(inputNames.size(), false),
+highest(-1),
+lowest(-1),
+windowSum(0.0),
+windowSum2(0.0),
+lastAverage(0.0),
+windowCount(0),
+numWindows(0),
+numPeriods(0) {
+    if (numInputs == 0) {
+        std::cout << "Calibration needs at least one input" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    if (window == 0 || maxWindows < 2 || tolerance < 0.0) {
+        std::cout << "Calibration needs a window of at least 1 interval, at least 2 windows and a tolerance >= 0"
+                << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    outputVals->addPin(outputName);
+}
+
+const std::vector<bool>& Calibrator::getSetting() {
+    return setting;
+}
+
+bool Calibrator::isDone() {
+    return stage == Stage::Done;
+}
+
+bool Calibrator::update() {
+    if (stage == Stage::Done) {
+        return false;
+    }
+    double value;
+    outputVals->updateValuesFromPort(&value);
+    numPeriods++;
+    windowSum += value;
+    windowSum2 += value * value;
+    windowCount++;
+    if (windowCount < window) {
+        return false;
+    }
+    auto average = windowSum / window;
+    //the noise of the output also moves the average, by about stddev sqrt(2 / window) between windows
+    auto noise = 3.0 * std::sqrt(std::max(0.0, windowSum2 / window - average * average) * 2.0 / window);
+    windowSum = 0.0;
+    windowSum2 = 0.0;
+    windowCount = 0;
+    numWindows++;
+    bool isSettled = numWindows > 1 &&
+            std::abs(average - lastAverage) <= std::max(tolerance * std::abs(average), noise);
+    lastAverage = average;
+    if (!isSettled && numWindows < maxWindows) {
+        return false;
+    }
+#ifdef DEBUG
+    std::cout << "Calibration setting " << measuredSettings.size() << ": " << outputName << " " << average <<
+            " after " << numWindows << " windows" << std::endl;
+#endif
+    measuredSettings.push_back(setting);
+    measuredVals.push_back(average);
+    settled.push_back(isSettled);
+    numWindows = 0;
+    return nextSetting();
+}
+
+int Calibrator::findMeasured(const std::vector<bool>& setting) {
+    for (uint32_t i = 0; i < measuredSettings.size(); i++) {
+        if (measuredSettings[i] == setting) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool Calibrator::nextSetting() {
+    //moves on until a setting that hasn't been measured, or the end
+    while (true) {
+        if (stage == Stage::Base) {
+            stage = Stage::OneInput;
+            currInput = 0;
+        } else if (stage == Stage::OneInput && currInput + 1 < numInputs) {
+            currInput++;
+        } else if (stage == Stage::OneInput) {
+            stage = Stage::Highest;
+        } else if (stage == Stage::Highest) {
+            highest = findMeasured(setting);
+            stage = Stage::Lowest;
+        } else {
+            lowest = findMeasured(setting);
+            stage = Stage::Done;
+            return false;
+        }
+
+        if (stage == Stage::OneInput) {
+            std::fill(setting.begin(), setting.end(), false);
+            setting[currInput] = true;
+        } else {
+            //the direction of each input from raising it alone, relative to the base setting
+            for (uint32_t i = 0; i < numInputs; i++) {
+                auto raises = measuredVals[i + 1] > measuredVals[0], lowers = measuredVals[i + 1] < measuredVals[0];
+                setting[i] = (stage == Stage::Highest) ? raises : lowers;
+            }
+        }
+        if (findMeasured(setting) < 0) {
+            return true;
+        }
+    }
+}
+
+double Calibrator::getOutputRange() {
+    if (highest < 0 || lowest < 0) {
+        return 0.0;
+    }
+    return measuredVals[highest] - measuredVals[lowest];
+}
+
+void Calibrator::report(std::ostream& out) {
+    out << "Calibration: " << measuredSettings.size() << " settings in " << numPeriods << " sampling intervals" <<
+            (isDone() ? "" : " (not finished)") << std::endl;
+    for (uint32_t s = 0; s < measuredSettings.size(); s++) {
+        out << "Calibration:";
+        for (uint32_t i = 0; i < numInputs; i++) {
+            out << " " << inputNames[i] << (measuredSettings[s][i] ? " max" : " min");
+        }
+        out << ", " << outputName << " " << std::setprecision(3) << std::fixed << measuredVals[s] <<
+                (settled[s] ? "" : " (did not settle)") << std::endl;
+    }
+    if (isDone()) {
+        out << "Calibration: " << outputName << " from " << measuredVals[lowest] << " to " <<
+                measuredVals[highest] << std::endl;
+    }
+}
+
+bool Calibrator::writeScales(std::string fileNamePrefix) {
+    auto range = getOutputRange();
+    if (range <= 0.0) {
+        std::cerr << "Calibration: the inputs don't change " << outputName << "; not writing the scales" << std::endl;
+        return false;
+    }
+    std::ofstream outputFile(fileNamePrefix + "_scaleYmeasDown.txt");
+    std::ofstream inputFile(fileNamePrefix + "_scaleInputsUp.txt");
+    if (!outputFile || !inputFile) {
+        std::cerr << "Unable to open the scale files with prefix " << fileNamePrefix << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    outputFile << std::setprecision(6) << 2.0 / range << std::endl;
+    inputFile << std::setprecision(6);
+    for (uint32_t i = 0; i < numInputs; i++) {
+        inputFile << (i > 0 ? " " : "") << (inputMaxVals[i] - inputMinVals[i]) / 2.0;
+    }
+    inputFile << std::endl;
+    std::cerr << "Calibration: wrote " << fileNamePrefix << "_scaleYmeasDown.txt and " << fileNamePrefix <<
+            "_scaleInputsUp.txt" << std::endl;
+    return true;
+}
@@ -0,0 +1,660 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/*
+ * File:   Config.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "Config.h"
+#include "debug.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <set>
+
+namespace {
+
+std::string trim(const std::string& text) {
+    auto first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return "";
+    }
+    auto last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+//sensors, inputs, controllers and planners are referred to by name, so they need one
+
+void checkNamed(ConfigSection& section) {
+    if (section.getName().empty()) {
+        std::cout << "Section [" << section.getKind() << "] at line " << section.getLine() <<
+                " needs a name: [" << section.getKind() << " <name>]" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+//periodUS if given, else period in sampling intervals (default 1)
+
+uint32_t getPeriodUS(ConfigSection& section, Manager& manager) {
+    return section.getUInt("periodUS", section.getUInt("period", 1) * manager.getSamplingIntervalMS() * 1000);
+}
+
+//the package a sensor or input is for, -1 (the whole system) if none is given
+
+int getPackage(ConfigSection& section) {
+    return section.has("package") ? (int) section.getUInt("package", 0) : -1;
+}
+
+std::map<std::string, SensorFactory>& getSensorFactories() {
+    static std::map<std::string, SensorFactory> factories = {
+        {"Time", [](ConfigSection & section) {
+                return std::unique_ptr<Sensor>(std::make_unique<Time>(section.getName()));
+            }},
+        {"CPUPower", [](ConfigSection & section) {
+                return std::unique_ptr<Sensor>(std::make_unique<CPUPowerSensor>(section.getName(), getPackage(section)));
+            }},
+        //the port name must differ from the pin prefix, so pinPrefix is required here
+        {"SampledCPUPower", [](ConfigSection & section) {
+                return std::unique_ptr<Sensor>(std::make_unique<SampledCPUPowerSensor>(section.getName(),
+                        section.getString("pinPrefix"), section.getUInt("sampleIntervalUS", 1000),
+                        section.getDouble("filterCutoffHz", 10.0), section.getUInt("ringCapacity", 4096),
+                        getPackage(section)));
+            }}
+    };
+    return factories;
+}
+
+std::map<std::string, InputFactory>& getInputFactories() {
+    static std::map<std::string, InputFactory> factories = {
+        {"CPUFrequency", [](ConfigSection & section) {
+                return std::unique_ptr<Input>(std::make_unique<CPUFrequency>(section.getName(), getPackage(section)));
+            }},
+        //powerclamp injects idle time on all packages
+        {"IdleInject", [](ConfigSection & section) {
+                if (getPackage(section) >= 0) {
+                    std::cout << "Input " << section.getName() << ": IdleInject applies to all packages and "
+                            "can't be given a package" << std::endl;
+                    std::exit(EXIT_FAILURE);
+                }
+                return std::unique_ptr<Input>(std::make_unique<IdleInject>(section.getName()));
+            }},
+        {"PowerBalloon", [](ConfigSection & section) {
+                return std::unique_ptr<Input>(std::make_unique<PowerBalloon>(section.getName(), getPackage(section)));
+            }}
+    };
+    return factories;
+}
+
+}
+
+ConfigSection::ConfigSection(std::string kind, std::string name, uint32_t line) :
+kind(kind), name(name), line(line) {
+
+}
+
+std::string ConfigSection::getKind() {
+    return kind;
+}
+
+std::string ConfigSection::getName() {
+    return name;
+}
+
+uint32_t ConfigSection::getLine() {
+    return line;
+}
+
+bool ConfigSection::has(std::string key) {
+    return values.find(key) != values.end();
+}
+
+std::string ConfigSection::getString(std::string key) {
+    if (!has(key)) {
+        std::cout << "Section [" << kind << " " << name << "] at line " << line <<
+                " needs a value for " << key << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return values[key];
+}
+
+std::string ConfigSection::getString(std::string key, std::string defaultValue) {
+    return has(key) ? values[key] : defaultValue;
+}
+
+uint32_t ConfigSection::getUInt(std::string key, uint32_t defaultValue) {
+    if (!has(key)) {
+        return defaultValue;
+    }
+    try {
+        return std::stoul(values[key]);
+    } catch (...) {
+        std::cout << "Value of " << key << " in section [" << kind << " " << name <<
+                "] must be a non-negative integer" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+double ConfigSection::getDouble(std::string key, double defaultValue) {
+    if (!has(key)) {
+        return defaultValue;
+    }
+    try {
+        return std::stod(values[key]);
+    } catch (...) {
+        std::cout << "Value of " << key << " in section [" << kind << " " << name <<
+                "] must be a number" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+bool ConfigSection::getBool(std::string key, bool defaultValue) {
+    if (!has(key)) {
+        return defaultValue;
+    }
+    auto value = values[key];
+    if (value.compare("true") == 0 || value.compare("1") == 0 || value.compare("yes") == 0) {
+        return true;
+    } else if (value.compare("false") == 0 || value.compare("0") == 0 || value.compare("no") == 0) {
+        return false;
+    }
+    std::cout << "Value of " << key << " in section [" << kind << " " << name <<
+            "] must be true or false" << std::endl;
+    std::exit(EXIT_FAILURE);
+}
+
+std::vector<std::string> ConfigSection::getList(std::string key) {
+    std::vector<std::string> items;
+    if (!has(key)) {
+        return items;
+    }
+    auto value = values[key];
+    std::replace(value.begin(), value.end(), ',', ' ');
+    std::istringstream stream(value);
+    std::string item;
+    while (stream >> item) {
+        items.push_back(item);
+    }
+    return items;
+}
+
+std::vector<uint32_t> ConfigSection::getUIntList(std::string key) {
+    std::vector<uint32_t> items;
+    for (auto& item : getList(key)) {
+        try {
+            items.push_back(std::stoul(item));
+        } catch (...) {
+            std::cout << "Values of " << key << " in section [" << kind << " " << name <<
+                    "] must be non-negative integers" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return items;
+}
+
+std::vector<double> ConfigSection::getDoubleList(std::string key) {
+    std::vector<double> items;
+    for (auto& item : getList(key)) {
+        try {
+            items.push_back(std::stod(item));
+        } catch (...) {
+            std::cout << "Values of " << key << " in section [" << kind << " " << name <<
+                    "] must be numbers" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return items;
+}
+
+void ConfigSection::set(std::string key, std::string value) {
+    values[key] = value;
+}
+
+void ConfigSection::rename(std::string newName) {
+    name = newName;
+}
+
+Config::Config(std::string fileName) : sourceName(fileName) {
+    std::ifstream configFile(fileName);
+    if (!configFile.is_open()) {
+        std::cout << "Cannot open configuration file " << fileName << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    parse(configFile);
+    auto dirEnd = fileName.rfind('/');
+    if (dirEnd != std::string::npos) {
+        resolvePaths(fileName.substr(0, dirEnd + 1));
+    }
+}
+
+void Config::resolvePaths(std::string dir) {
+    //keys whose values are files or directories
+    static const std::vector<std::string> pathKeys = {"plant", "trace", "sysroot", "dir", "model"};
+    for (auto& section : sections) {
+        for (auto& key : pathKeys) {
+            if (section->has(key)) {
+                auto path = section->getString(key);
+                if (!path.empty() && path[0] != '/') {
+                    section->set(key, dir + path);
+                }
+            }
+        }
+    }
+}
+
+Config Config::fromString(std::string text, std::string sourceName) {
+    Config config;
+    config.sourceName = sourceName;
+    std::istringstream stream(text);
+    config.parse(stream);
+    return config;
+}
+
+void Config::parse(std::istream& stream) {
+    std::string line;
+    uint32_t lineNum = 0;
+    while (std::getline(stream, line)) {
+        lineNum++;
+        line = trim(line);
+        if (line.empty() || line[0] == '#' || line[0] == ';') {
+            continue;
+        }
+        if (line[0] == '[') {
+            if (line.back() != ']') {
+                std::cout << sourceName << ":" << lineNum << ": section header must end with ]" << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+            std::istringstream header(line.substr(1, line.size() - 2));
+            std::string kind, name, extra;
+            header >> kind >> name >> extra;
+            if (kind.empty() || !extra.empty()) {
+                std::cout << sourceName << ":" << lineNum << ": section header must be [<kind>] or [<kind> <name>]" << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+            sections.push_back(std::make_unique<ConfigSection>(kind, name, lineNum));
+            continue;
+        }
+        auto equals = line.find('=');
+        if (equals == std::string::npos || sections.empty()) {
+            std::cout << sourceName << ":" << lineNum << ": expected key = value inside a section" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        auto key = trim(line.substr(0, equals));
+        auto value = trim(line.substr(equals + 1));
+        if (key.empty()) {
+            std::cout << sourceName << ":" << lineNum << ": missing key" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        sections.back()->set(key, value);
+    }
+#ifdef DEBUG
+    std::cout << "Read " << sections.size() << " sections from " << sourceName << std::endl;
+#endif
+}
+
+std::vector<ConfigSection*> Config::getSections(std::string kind) {
+    std::vector<ConfigSection*> result;
+    for (auto& section : sections) {
+        if (kind.compare(section->getKind()) == 0) {
+            result.push_back(section.get());
+        }
+    }
+    return result;
+}
+
+ConfigSection* Config::getSection(std::string kind) {
+    auto result = getSections(kind);
+    return result.empty() ? nullptr : result[0];
+}
+
+ConfigSection& Config::addSection(std::string kind, std::string name) {
+    sections.push_back(std::make_unique<ConfigSection>(kind, name, 0));
+    return *sections.back();
+}
+
+void Config::expandPerPackage(uint32_t numPackages) {
+    //sensors and inputs (and pin prefixes) of the packages, which replicas refer to with their suffix
+    std::set<std::string> perPackageNames;
+    for (auto& section : sections) {
+        if (!section->getBool("perPackage", false)) {
+            continue;
+        }
+        auto kind = section->getKind();
+        if (kind != "sensor" && kind != "input" && kind != "controller" && kind != "planner") {
+            std::cout << "Section [" << kind << "] at line " << section->getLine() <<
+                    " can't be perPackage; only sensors, inputs, controllers and planners can" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        checkNamed(*section);
+        perPackageNames.insert(section->getName());
+        if (section->has("pinPrefix")) {
+            perPackageNames.insert(section->getString("pinPrefix"));
+        }
+    }
+    if (perPackageNames.empty()) {
+        return;
+    }
+
+    const std::vector<std::string> referenceKeys = {"outputs", "inputs", "controller", "schedule", "pinPrefix"};
+    std::vector<std::unique_ptr<ConfigSection>> expanded;
+    for (auto& section : sections) {
+        auto kind = section->getKind();
+        bool perPackage = section->getBool("perPackage", false);
+        if (kind == "controller" || kind == "planner") {
+            for (auto& key : referenceKeys) {
+                for (auto& item : section->getList(key)) {
+                    bool isPerPackage = perPackageNames.find(item) != perPackageNames.end();
+                    if (!perPackage && isPerPackage) {
+                        std::cout << "[" << kind << " " << section->getName() << "] refers to " << item <<
+                                ", which is perPackage, so it must be perPackage too" << std::endl;
+                        std::exit(EXIT_FAILURE);
+                    }
+                    //the controllers of two packages must not drive the same input
+                    if (perPackage && kind == "controller" && key == "inputs" && !isPerPackage) {
+                        std::cout << "[controller " << section->getName() << "] is perPackage, so its input " <<
+                                item << " must be perPackage too" << std::endl;
+                        std::exit(EXIT_FAILURE);
+                    }
+                }
+            }
+        }
+        if (!perPackage) {
+            expanded.push_back(std::move(section));
+            continue;
+        }
+        for (uint32_t p = 0; p < numPackages; p++) {
+            auto suffix = std::to_string(p);
+            auto replica = std::make_unique<ConfigSection>(*section);
+            replica->rename(section->getName() + suffix);
+            replica->set("package", suffix);
+            for (auto& key : referenceKeys) {
+                if (!replica->has(key)) {
+                    continue;
+                }
+                std::string items;
+                for (auto& item : replica->getList(key)) {
+                    bool isPerPackage = perPackageNames.find(item) != perPackageNames.end();
+                    items += (items.empty() ? "" : ", ") + item + (isPerPackage ? suffix : "");
+                }
+                replica->set(key, items);
+            }
+            expanded.push_back(std::move(replica));
+        }
+#ifdef DEBUG
+        std::cout << "Replicated [" << kind << " " << section->getName() << "] for " << numPackages <<
+                " packages" << std::endl;
+#endif
+    }
+    sections = std::move(expanded);
+}
+
+void registerSensorType(std::string type, SensorFactory factory) {
+    getSensorFactories()[type] = factory;
+}
+
+void registerInputType(std::string type, InputFactory factory) {
+    getInputFactories()[type] = factory;
+}
+
+Mode getModeFromName(std::string name) {
+    if (name.compare("Baseline") == 0) {
+        return Mode::Baseline;
+    } else if (name.compare("Sysid") == 0) {
+        return Mode::Sysid;
+    } else if (name.compare("Mask") == 0) {
+        return Mode::Mask;
+    } else if (name.compare("Calibrate") == 0) {
+        return Mode::Calibrate;
+    } else {
+        std::cout << "Mode " << name << " is invalid. It should be one of Baseline, Sysid, Mask, Calibrate" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+ExecMode getExecModeFromName(std::string name) {
+    if (name.compare("Serial") == 0) {
+        return ExecMode::Serial;
+    } else if (name.compare("Pipelined") == 0) {
+        return ExecMode::Pipelined;
+    } else {
+        std::cout << "Execution mode " << name << " is invalid. It should be one of Serial, Pipelined" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+ControllerType getControllerTypeFromName(std::string name) {
+    if (name.compare("SSV") == 0) {
+        return ControllerType::SSV;
+    } else if (name.compare("MPC") == 0) {
+        return ControllerType::MPC;
+    } else if (name.compare("Bank") == 0) {
+        return ControllerType::Bank;
+    } else if (name.compare("Dummy") == 0) {
+        return ControllerType::Dummy;
+    } else {
+        std::cout << "Controller type " << name << " is invalid. It should be one of SSV, MPC, Bank, Dummy" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+EstimatorType getEstimatorTypeFromName(std::string name) {
+    if (name.compare("Kalman") == 0) {
+        return EstimatorType::Kalman;
+    } else if (name.compare("SteadyStateKalman") == 0) {
+        return EstimatorType::SteadyStateKalman;
+    } else {
+        std::cout << "Estimator type " << name << " is invalid. It should be one of Kalman, SteadyStateKalman" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+ExcitationType getExcitationTypeFromName(std::string name) {
+    if (name.compare("Random") == 0) {
+        return ExcitationType::Random;
+    } else if (name.compare("PRBS") == 0) {
+        return ExcitationType::PRBS;
+    } else if (name.compare("MultiLevelPRBS") == 0) {
+        return ExcitationType::MultiLevelPRBS;
+    } else if (name.compare("Multisine") == 0) {
+        return ExcitationType::Multisine;
+    } else {
+        std::cout << "Excitation " << name << " is invalid. It should be one of Random, PRBS, MultiLevelPRBS, Multisine"
+                << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+MaskGenType getMaskGenTypeFromName(std::string name) {
+    if (name.compare("Constant") == 0) {
+        return MaskGenType::Constant;
+    } else if (name.compare("Uniform") == 0) {
+        return MaskGenType::Uniform;
+    } else if (name.compare("Gauss") == 0) {
+        return MaskGenType::Gauss;
+    } else if (name.compare("GaussSine") == 0) {
+        return MaskGenType::GaussSine;
+    } else if (name.compare("Sine") == 0) {
+        return MaskGenType::Sine;
+    } else if (name.compare("Pink") == 0) {
+        return MaskGenType::Pink;
+    } else if (name.compare("BandNoise") == 0) {
+        return MaskGenType::BandNoise;
+    } else if (name.compare("MultiTone") == 0) {
+        return MaskGenType::MultiTone;
+    } else if (name.compare("Markov") == 0) {
+        return MaskGenType::Markov;
+    } else if (name.compare("Preset") == 0) {
+        return MaskGenType::Preset;
+    } else {
+        std::cout << "Mask name " << name << " is invalid. It should be one of Constant, Uniform, Gauss, GaussSine, Sine, "
+                "Pink, BandNoise, MultiTone, Markov, Preset" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+Backend getBackendFromName(std::string name) {
+    if (name.compare("System") == 0) {
+        return Backend::System;
+    } else if (name.compare("Simulate") == 0) {
+        return Backend::Simulate;
+    } else if (name.compare("Replay") == 0) {
+        return Backend::Replay;
+    } else {
+        std::cout << "Backend " << name << " is invalid. It should be one of System, Simulate, Replay" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+//The allowed values of a replayed input, from min to max in steps of step
+std::vector<double> getReplayAllowedValues(ConfigSection& section) {
+    if (!section.has("min") || !section.has("max")) {
+        std::cout << "Input " << section.getName() << " must give min and max (and step) to be replayed" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    auto minVal = section.getDouble("min", 0.0), maxVal = section.getDouble("max", 0.0);
+    auto step = section.getDouble("step", maxVal - minVal);
+    if (maxVal < minVal || (step <= 0.0 && maxVal > minVal)) {
+        std::cout << "Input " << section.getName() << " has an invalid min, max or step" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    std::vector<double> allowedValues;
+    uint32_t numSteps = (maxVal > minVal) ? (uint32_t) ((maxVal - minVal) / step + 1e-9) : 0;
+    for (uint32_t i = 0; i <= numSteps; i++) {
+        allowedValues.push_back(minVal + i * step);
+    }
+    return allowedValues;
+}
+
+void populateManager(Manager& manager, Config& config, Mode mode, std::shared_ptr<PlantModel> plant,
+        std::shared_ptr<ReplayTrace> trace) {
+    for (auto section : config.getSections("sensor")) {
+        checkNamed(*section);
+        auto type = section->getString("type");
+        auto& factories = getSensorFactories();
+        std::unique_ptr<Sensor> sensor;
+        if (plant && type.compare("Time") == 0) {
+            sensor = std::make_unique<SimulatedTime>(section->getName(), plant->getClock());
+        } else if (plant) {
+            sensor = std::make_unique<SimulatedSensor>(section->getName(), plant);
+        } else if (trace && type.compare("Time") == 0 && trace->getColumn(section->getName()) == UINT32_MAX) {
+            sensor = std::make_unique<SimulatedTime>(section->getName(), trace->getClock());
+        } else if (trace) {
+            sensor = std::make_unique<ReplaySensor>(section->getName(), trace);
+        } else if (factories.find(type) != factories.end()) {
+            sensor = factories[type](*section);
+        } else {
+            std::cout << "Unknown sensor type " << type << " for sensor " << section->getName() << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        sensor->setPeriodUS(section->getUInt("periodUS", 0));
+        sensor->setPackage(getPackage(*section));
+        manager.addSensor(std::move(sensor));
+    }
+
+    for (auto section : config.getSections("input")) {
+        checkNamed(*section);
+        auto type = section->getString("type");
+        auto& factories = getInputFactories();
+        std::unique_ptr<Input> input;
+        if (plant) {
+            input = std::make_unique<SimulatedInput>(section->getName(), plant);
+        } else if (trace) {
+            input = std::make_unique<ReplayInput>(section->getName(), trace, getReplayAllowedValues(*section));
+        } else if (factories.find(type) != factories.end()) {
+            input = factories[type](*section);
+        } else {
+            std::cout << "Unknown input type " << type << " for input " << section->getName() << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        input->setPeriodUS(section->getUInt("periodUS", 0));
+        input->setPackage(getPackage(*section));
+        manager.addInput(std::move(input));
+    }
+
+    if (mode == Mode::Sysid) {
+        auto section = config.getSection("sysid");
+        if (section == nullptr || section->getList("inputs").empty()) {
+            std::cout << "Sysid mode needs a [sysid] section with the list of inputs" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        manager.addSysIdParams(section->getList("inputs"), section->getUIntList("minHold"),
+                section->getUIntList("maxHold"), section->getUIntList("initHold"));
+        manager.setSysidExcitation(getExcitationTypeFromName(section->getString("excitation", "Random")),
+                section->getUIntList("clock"), section->getUInt("levels", defaultExcitationLevels),
+                section->getDoubleList("lowHz"), section->getDoubleList("highHz"), section->getDoubleList("amplitude"),
+                section->getUInt("period", defaultMultisinePeriod));
+        if (!section->getList("outputs").empty()) {
+            manager.addSystemIdentifier(section->getList("outputs"), section->getUInt("na", 1),
+                    section->getUInt("nb", 1), section->getDouble("forgetting", defaultSystemIdForgetting),
+                    section->getString("model", ""));
+        }
+    } else if (mode == Mode::Calibrate) {
+        auto section = config.getSection("calibrate");
+        if (section == nullptr || section->getList("inputs").empty()) {
+            std::cout << "Calibrate mode needs a [calibrate] section with the list of inputs" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        manager.addCalibrator(section->getString("output", "CPUPower"), section->getList("inputs"),
+                section->getString("dir") + "/" + section->getString("file"),
+                section->getUInt("window", defaultCalibrationWindow),
+                section->getDouble("tolerance", defaultCalibrationTolerance),
+                section->getUInt("maxWindows", defaultCalibrationMaxWindows));
+    } else if (mode == Mode::Mask) {
+        for (auto section : config.getSections("estimator")) {
+            checkNamed(*section);
+            manager.addEstimator(section->getName(), getEstimatorTypeFromName(section->getString("type", "SteadyStateKalman")),
+                    section->getString("dir"), section->getString("file"), getPeriodUS(*section, manager));
+        }
+        auto controllers = config.getSections("controller");
+        for (auto section : controllers) {
+            checkNamed(*section);
+            auto ctlType = getControllerTypeFromName(section->getString("type", "Dummy"));
+            if (ctlType == ControllerType::Bank) {
+                manager.addControllerBank(section->getName(), section->getList("outputs"), section->getList("inputs"),
+                        section->getString("dir", ""), section->getList("designs"), section->getDoubleList("points"),
+                        section->getString("schedule"), section->getBool("interpolate", false),
+                        section->getDouble("hysteresis", defaultBankHysteresis), getPeriodUS(*section, manager),
+                        section->getBool("antiwindup", true));
+                continue;
+            }
+            manager.addController(section->getName(), section->getList("outputs"), section->getList("inputs"),
+                    ctlType, section->getString("dir", ""), section->getString("file", ""),
+                    getPeriodUS(*section, manager), section->getBool("antiwindup", true),
+                    section->getString("model", ""), section->getDouble("budget", defaultMPCBudget));
+        }
+
+        for (auto section : config.getSections("planner")) {
+            checkNamed(*section);
+            auto ctlName = section->getString("controller");
+            auto ctlSection = std::find_if(controllers.begin(), controllers.end(),
+                    [&](ConfigSection * ctl) {
+                        return ctlName.compare(ctl->getName()) == 0;
+                    });
+            if (ctlSection == controllers.end()) {
+                std::cout << "Planner " << section->getName() << " is attached to unknown controller " << ctlName << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+            auto maskType = getMaskGenTypeFromName(section->getString("type"));
+            //the uniform mask looks better without randomizing its properties
+            bool randomize = section->getBool("randomize", maskType != MaskGenType::Uniform);
+            manager.addMaskGenerator(section->getName(), ctlName, maskType,
+                    section->getString("dir", (*ctlSection)->getString("dir", "")),
+                    section->getString("file", (*ctlSection)->getString("file", "")),
+                    getPeriodUS(*section, manager), randomize,
+                    section->getUInt("lookahead", defaultMaskLookahead));
+        }
+    }
+}
@@ -24,16 +24,12 @@
 #include "Abstractions.h"
 #include "Sensors.h"
 #include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
 
 void Controller::run() {
-    bool run = false;
-    if (cycles == samplingInterval) {
-        cycles = 1;
-        run = true;
-    } else {
-        cycles++;
-    }
-    auto newValues = computeNewInputs(run);
+    auto newValues = computeNewInputs();
 
 #ifdef DEBUG
     std::vector<std::string> inputNames = newInputVals->getPinNames();
@@ -47,27 +43,19 @@ void Controller::run() {
     currOutputTargetVals->updateValuesToPort(outputTargetVals->updateValuesFromPort());
 }
 
-Vector Controller::computeNewInputs(bool run) {
+Vector Controller::computeNewInputs() {
 #ifdef DEBUG
     std::cout << "------Controller------" << std::endl;
 #endif
 
-    if (run) {
-        auto currOpVals = outputVals->updateValuesFromPort();
-        auto currIpVals = currInputVals->updateValuesFromPort();
-        auto newIpVals = currInputVals->updateValuesFromPort() - 5;
-#ifdef DEBUG
-        std::cout << "currOps " << currOpVals << "currIps " << currIpVals;
-        std::cout << "newIps " << newIpVals;
-#endif
-        return newIpVals;
-    } else {
+    auto currOpVals = outputVals->updateValuesFromPort();
+    auto currIpVals = currInputVals->updateValuesFromPort();
+    auto newIpVals = currInputVals->updateValuesFromPort() - 5;
 #ifdef DEBUG
-        std::cout << "Skipping" << std::endl;
+    std::cout << "currOps " << currOpVals << "currIps " << currIpVals;
+    std::cout << "newIps " << newIpVals;
 #endif
-        auto currIpVals = currInputVals->updateValuesFromPort();
-        return currIpVals;
-    }
+    return newIpVals;
 }
 
 void Controller::reset() {
@@ -78,23 +66,37 @@ std::string Controller::getName() {
     return name;
 }
 
-Controller::Controller(std::string name, uint32_t smplInt) :
+uint32_t Controller::getPeriodUS() {
+    return periodUS;
+}
+
+void Controller::setInputLimits(Vector minVals, Vector maxVals, std::vector<std::vector<double>> allowedVals) {
+    inputMinVals = minVals;
+    inputMaxVals = maxVals;
+    inputAllowedVals = allowedVals;
+    for (auto& values : inputAllowedVals) {
+        std::sort(values.begin(), values.end());
+    }
+}
+
+Controller::Controller(std::string name, uint32_t periodUS) :
 name(name),
 newInputVals(std::make_shared<OutputPort>("newInputVals")),
 currOutputTargetVals(std::make_shared<OutputPort>("currOutputTargetVals")),
 currInputVals(std::make_shared<InputPort>("currInputVals")),
 outputVals(std::make_shared<InputPort>("outputVals")),
 outputTargetVals(std::make_shared<InputPort>("outputTargetVals")),
-samplingInterval(smplInt),
-cycles(smplInt) {
+periodUS(periodUS) {
 #ifdef DEBUG
     std::cout << "Creating controller " << name << std::endl;
 #endif
 
 }
 
-RobustController::RobustController(std::string name, std::string dirPath, std::string ctlFileName, uint32_t smplInt) :
-Controller(name, smplInt) {
+RobustController::RobustController(std::string name, std::string dirPath, std::string ctlFileName, uint32_t periodUS,
+        bool antiWindup) :
+Controller(name, periodUS),
+antiWindup(antiWindup) {
     std::ifstream file;
     uint32_t dimension, numInputs, numMeasurements;
     std::string fileNamePrefix = dirPath + "/"+ ctlFileName;
@@ -157,9 +159,38 @@ Controller(name, smplInt) {
     std::cout << "outputNormalizationScales\n" << outputNormalizeScales;
 #endif
 
+    if (std::ifstream(fileNamePrefix + "_slewLimits.txt")) {
+        slewLimits.from_file(fileNamePrefix + "_slewLimits.txt");
+        if (slewLimits.size() != numInputs) {
+            std::cout << fileNamePrefix << "_slewLimits.txt must have " << numInputs << " values" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+#ifdef DEBUG
+        std::cout << "slewLimits\n" << slewLimits;
+#endif
+    }
+    //the smallest state change that gives a change of the normalized inputs
+    auto CCt = inverse(C * transpose(C));
+    if (CCt.row() > 0) {
+        pinvC = transpose(C) * CCt;
+    }
+    if (antiWindup && std::ifstream(fileNamePrefix + "_Kaw.txt")) {
+        Kaw = Matrix(dimension, numInputs);
+        Kaw.from_file(fileNamePrefix + "_Kaw.txt");
+    } else if (antiWindup) {
+        //the smallest state change that gives the applied inputs instead of the requested ones
+        if (pinvC.row() == 0) {
+            std::cout << "Controller " << name << " needs a _Kaw.txt file for anti-windup since C*C' is singular" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        Kaw = pinvC;
+    }
+#ifdef DEBUG
+    std::cout << "Kaw\n" << Kaw;
+#endif
 }
 
-Vector RobustController::computeNewInputs(bool run) {
+Vector RobustController::computeNewInputs() {
 #ifdef DEBUG
     std::cout << "------Robust Controller: " << name << "------" << std::endl;
 #endif
@@ -167,31 +198,209 @@ Vector RobustController::computeNewInputs(bool run) {
     auto currIpVals = currInputVals->updateValuesFromPort();
     auto currTargets = outputTargetVals->updateValuesFromPort();
     auto currOpVals = outputVals->updateValuesFromPort();
-    if (run) {
-        deltaOutputs = currTargets - currOpVals;
-        auto normalizedDeltaOutputs = (deltaOutputs) * outputNormalizeScales;
 
-        auto newState = A * state + B*normalizedDeltaOutputs;
-        auto newNormalizedIps = C * state + D*normalizedDeltaOutputs;
-        auto newIpVals = (newNormalizedIps * inputDenormalizeScales) + currIpVals;
+    auto requestedDeltaIps = requestDeltaInputs(currTargets - currOpVals);
+    auto newIpVals = requestedDeltaIps + currIpVals;
+    bool limited = limitInputs(newIpVals, currIpVals);
+    commitState(limited ? newIpVals - currIpVals - requestedDeltaIps : Vector());
 
 #ifdef DEBUG
-        std::cout << "currIpVals " << currIpVals << "currOpVals " << currOpVals <<
-                "currTargets " << currTargets << "deltaOutputs " << deltaOutputs <<
-                " normalizedDeltaOutputs " << normalizedDeltaOutputs <<
-                " newNormalizedIps " << newNormalizedIps << " newState " << newState;
+    std::cout << "currIpVals " << currIpVals << "currOpVals " << currOpVals <<
+            "currTargets " << currTargets << "deltaOutputs " << deltaOutputs <<
+            " requestedDeltaIps " << requestedDeltaIps << " newState " << state <<
+            " limited " << limited;
 #endif
+    return newIpVals;
+}
 
-        state = newState;
-        return newIpVals;
-    } else {
-#ifdef DEBUG
-        std::cout << "Skipping" << std::endl;
-#endif
-        return currIpVals;
+Vector RobustController::requestDeltaInputs(const Vector& deltaOutputs) {
+    this->deltaOutputs = deltaOutputs;
+    auto normalizedDeltaOutputs = deltaOutputs * outputNormalizeScales;
+
+    newState = A * state + B*normalizedDeltaOutputs;
+    auto newNormalizedIps = C * state + D*normalizedDeltaOutputs;
+    return newNormalizedIps * inputDenormalizeScales;
+}
+
+bool RobustController::limitInputs(Vector& newIpVals, const Vector& currIpVals) {
+    bool limited = false;
+    for (Vector::size_type i = 0; i < newIpVals.size(); i++) {
+        auto newIpVal = newIpVals[i];
+        if (slewLimits.size() > 0 && slewLimits[i] > 0.0) {
+            newIpVal = std::min(std::max(newIpVal, currIpVals[i] - slewLimits[i]), currIpVals[i] + slewLimits[i]);
+        }
+        if (inputMinVals.size() > 0) {
+            newIpVal = std::min(std::max(newIpVal, inputMinVals[i]), inputMaxVals[i]);
+        }
+        if (newIpVal != newIpVals[i]) {
+            limited = true;
+            newIpVals[i] = newIpVal;
+        }
     }
+    return limited;
 }
 
+void RobustController::commitState(const Vector& unappliedDeltaIps) {
+    if (antiWindup && unappliedDeltaIps.size() > 0) {
+        newState = newState + Kaw * (unappliedDeltaIps / inputDenormalizeScales);
+    }
+    state = newState;
+}
+
+bool RobustController::canTransferState() {
+    return pinvC.row() > 0;
+}
 
+void RobustController::transferStateFrom(const RobustController& other) {
+    //C state is the part of the normalized change of the inputs that comes from the state
+    auto deltaIps = (other.C * other.state) * other.inputDenormalizeScales;
+    state = pinvC * (deltaIps / inputDenormalizeScales);
+}
+
+void RobustController::reset() {
+    state = Vector(state.size());
+}
 
+uint32_t RobustController::getNumInputs() {
+    return C.row();
+}
 
+uint32_t RobustController::getNumMeasurements() {
+    return D.col();
+}
+
+ControllerBank::ControllerBank(std::string name, std::string dirPath, std::vector<std::string> designFileNames,
+        std::vector<double> points, uint32_t periodUS, bool interpolate, double hysteresis, bool antiWindup) :
+Controller(name, periodUS),
+scheduleVals(std::make_shared<InputPort>("scheduleVals")),
+interpolate(interpolate),
+hysteresis(hysteresis),
+activeDesign(0),
+switches(0),
+started(false) {
+    if (designFileNames.empty() || designFileNames.size() != points.size()) {
+        std::cout << "Controller bank " << name << " needs one point for each of its designs" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    std::vector<std::size_t> order(points.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return points[a] < points[b];
+    });
+    for (auto i : order) {
+        if (!this->points.empty() && points[i] == this->points.back()) {
+            std::cout << "Designs of controller bank " << name << " must have different points" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        this->points.push_back(points[i]);
+        designs.push_back(std::make_unique<RobustController>(name + "/" + designFileNames[i], dirPath,
+                designFileNames[i], periodUS, antiWindup));
+        auto& design = designs.back();
+        if (design->getNumInputs() != designs[0]->getNumInputs() ||
+                design->getNumMeasurements() != designs[0]->getNumMeasurements()) {
+            std::cout << "Designs of controller bank " << name << " must have the same inputs and outputs" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        if (!design->canTransferState()) {
+            std::cout << "Design " << designFileNames[i] << " of controller bank " << name <<
+                    " needs a C with full row rank for bumpless transfer" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    weights.assign(designs.size(), 0.0);
+    prevWeights.assign(designs.size(), 0.0);
+    requestedDeltaIps.resize(designs.size());
+}
+
+void ControllerBank::setInputLimits(Vector minVals, Vector maxVals, std::vector<std::vector<double>> allowedVals) {
+    Controller::setInputLimits(minVals, maxVals, allowedVals);
+    for (auto& design : designs) {
+        design->setInputLimits(minVals, maxVals, allowedVals);
+    }
+}
+
+void ControllerBank::reset() {
+    for (auto& design : designs) {
+        design->reset();
+    }
+    started = false;
+}
+
+uint32_t ControllerBank::getActiveDesign() {
+    return activeDesign;
+}
+
+uint64_t ControllerBank::getSwitches() {
+    return switches;
+}
+
+void ControllerBank::updateWeights(double operatingPoint) {
+    std::fill(weights.begin(), weights.end(), 0.0);
+    auto above = std::lower_bound(points.begin(), points.end(), operatingPoint) - points.begin();
+    if (above == 0 || above == (long) points.size()) {
+        //beyond the points: the design at that end
+        weights[above == 0 ? 0 : points.size() - 1] = 1.0;
+    } else if (interpolate) {
+        auto fraction = (operatingPoint - points[above - 1]) / (points[above] - points[above - 1]);
+        weights[above - 1] = 1.0 - fraction;
+        weights[above] = fraction;
+    } else {
+        auto nearest = (operatingPoint - points[above - 1] < points[above] - operatingPoint) ? above - 1 : above;
+        auto current = activeDesign;
+        if (started && nearest != current && std::fabs(operatingPoint - points[current]) -
+                std::fabs(operatingPoint - points[nearest]) <= hysteresis * std::fabs(points[nearest] - points[current])) {
+            nearest = current;
+        }
+        weights[nearest] = 1.0;
+    }
+    activeDesign = std::max_element(weights.begin(), weights.end()) - weights.begin();
+}
+
+Vector ControllerBank::computeNewInputs() {
+#ifdef DEBUG
+    std::cout << "------Controller Bank: " << name << "------" << std::endl;
+#endif
+
+    auto currIpVals = currInputVals->updateValuesFromPort();
+    auto currTargets = outputTargetVals->updateValuesFromPort();
+    auto currOpVals = outputVals->updateValuesFromPort();
+    auto operatingPoint = scheduleVals->updateValuesFromPort()[0];
+
+    auto prevActiveDesign = activeDesign;
+    std::swap(weights, prevWeights);
+    updateWeights(operatingPoint);
+    for (std::size_t i = 0; i < designs.size(); i++) {
+        if (started && weights[i] > 0.0 && prevWeights[i] == 0.0) {
+            designs[i]->transferStateFrom(*designs[prevActiveDesign]);
+            switches++;
+        }
+    }
+    started = true;
+
+    auto deltaOutputs = currTargets - currOpVals;
+    Vector blendedDeltaIps(currIpVals.size());
+    uint32_t numUsed = 0;
+    for (std::size_t i = 0; i < designs.size(); i++) {
+        if (weights[i] > 0.0) {
+            requestedDeltaIps[i] = designs[i]->requestDeltaInputs(deltaOutputs);
+            blendedDeltaIps = blendedDeltaIps + requestedDeltaIps[i] * weights[i];
+            numUsed++;
+        }
+    }
+    auto newIpVals = blendedDeltaIps + currIpVals;
+    bool limited = designs[activeDesign]->limitInputs(newIpVals, currIpVals);
+
+    //every design used is corrected for what was applied instead of what it asked for
+    for (std::size_t i = 0; i < designs.size(); i++) {
+        if (weights[i] > 0.0) {
+            designs[i]->commitState((limited || numUsed > 1) ? newIpVals - currIpVals - requestedDeltaIps[i] : Vector());
+        }
+    }
+
+#ifdef DEBUG
+    std::cout << "operatingPoint " << operatingPoint << " activeDesign " << activeDesign <<
+            " designs used " << numUsed << " currIpVals " << currIpVals << "currOpVals " << currOpVals <<
+            "currTargets " << currTargets << " newIpVals " << newIpVals;
+#endif
+    return newIpVals;
+}
@@ -0,0 +1,307 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   Estimator.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "Estimator.h"
+#include "MathSupport.h"
+#include "Simulation.h"
+#include "debug.h"
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+typedef KalmanFilter::FixedMatrix FixedMatrix;
+
+//Riccati steps to find the steady state gain
+const uint32_t steadyStateIterations = 100000;
+const double steadyStateTolerance = 1e-12;
+
+//n values are the diagonal, n x n values the whole matrix
+void readCovariance(FixedMatrix& m, std::string fileName, uint32_t n) {
+    Vector v(fileName);
+    if (v.size() == n) {
+        for (uint32_t i = 0; i < n; i++) {
+            m[i][i] = v[i];
+        }
+    } else {
+        readModelValues(&m[0][0], fileName, n, n, maxEstimatorDimension);
+    }
+}
+
+//out = a * b, where a is rows x inner and b is inner x cols
+void multiply(FixedMatrix& out, const FixedMatrix& a, const FixedMatrix& b, uint32_t rows, uint32_t inner, uint32_t cols) {
+    for (uint32_t r = 0; r < rows; r++) {
+        for (uint32_t c = 0; c < cols; c++) {
+            out[r][c] = 0.0;
+        }
+        for (uint32_t k = 0; k < inner; k++) {
+            for (uint32_t c = 0; c < cols; c++) {
+                out[r][c] += a[r][k] * b[k][c];
+            }
+        }
+    }
+}
+
+//out = a * b', where a is rows x inner and b is cols x inner
+void multiplyTransposed(FixedMatrix& out, const FixedMatrix& a, const FixedMatrix& b, uint32_t rows, uint32_t inner,
+        uint32_t cols) {
+    for (uint32_t r = 0; r < rows; r++) {
+        for (uint32_t c = 0; c < cols; c++) {
+            double sum = 0.0;
+            for (uint32_t k = 0; k < inner; k++) {
+                sum += a[r][k] * b[c][k];
+            }
+            out[r][c] = sum;
+        }
+    }
+}
+
+}
+
+Estimator::Estimator(std::string name, uint32_t periodUS, std::vector<std::string> outputNames,
+        std::vector<std::string> inputNames) :
+measuredVals(std::make_shared<InputPort>("measuredVals")),
+inputVals(std::make_shared<InputPort>("inputVals")),
+estimatedVals(std::make_shared<OutputPort>("estimatedVals")),
+name(name),
+periodUS(periodUS),
+outputNames(outputNames),
+inputNames(inputNames) {
+    if (outputNames.size() > maxEstimatorDimension || inputNames.size() > maxEstimatorDimension) {
+        std::cout << "Estimator " << name << " can have at most " << maxEstimatorDimension << " outputs and inputs" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    measuredVals->addPin(outputNames);
+    inputVals->addPin(inputNames);
+    estimatedVals->addPin(outputNames);
+    std::fill(measurements, measurements + maxEstimatorDimension, 0.0);
+    std::fill(inputs, inputs + maxEstimatorDimension, 0.0);
+    std::fill(estimates, estimates + maxEstimatorDimension, 0.0);
+#ifdef DEBUG
+    std::cout << "Creating estimator " << name << std::endl;
+#endif
+}
+
+std::string Estimator::getName() {
+    return name;
+}
+
+uint32_t Estimator::getPeriodUS() {
+    return periodUS;
+}
+
+const std::vector<std::string>& Estimator::getOutputNames() {
+    return outputNames;
+}
+
+const std::vector<std::string>& Estimator::getInputNames() {
+    return inputNames;
+}
+
+void Estimator::run() {
+    measuredVals->updateValuesFromPort(measurements);
+    inputVals->updateValuesFromPort(inputs);
+    estimate();
+    estimatedVals->updateValuesToPort(estimates);
+}
+
+void Estimator::estimate() {
+    std::copy(measurements, measurements + outputNames.size(), estimates);
+}
+
+void Estimator::reset() {
+
+}
+
+KalmanFilter::KalmanFilter(std::string name, std::string dirPath, std::string fileName, uint32_t periodUS,
+        bool timeVarying) :
+KalmanFilter(name, dirPath + "/" + fileName, readModelShape(dirPath + "/" + fileName, maxEstimatorDimension),
+periodUS, timeVarying) {
+}
+
+KalmanFilter::KalmanFilter(std::string name, std::string fileNamePrefix, const ModelShape& shape, uint32_t periodUS,
+        bool timeVarying) :
+Estimator(name, periodUS, shape.outputNames, shape.inputNames),
+timeVarying(timeVarying),
+A(), B(), C(), D(), Q(), R(), P(), K(), initialP() {
+    readModel(fileNamePrefix, shape);
+
+    std::copy(&Q[0][0], &Q[0][0] + maxEstimatorDimension * maxEstimatorDimension, &P[0][0]);
+    if (!timeVarying) {
+        uint32_t iteration = 0;
+        double change;
+        do {
+            FixedMatrix prevK;
+            std::copy(&K[0][0], &K[0][0] + maxEstimatorDimension * maxEstimatorDimension, &prevK[0][0]);
+            updateGain();
+            change = 0.0;
+            for (uint32_t i = 0; i < dimension; i++) {
+                for (uint32_t j = 0; j < numOutputs; j++) {
+                    change = std::max(change, std::fabs(K[i][j] - prevK[i][j]));
+                }
+            }
+        } while (change > steadyStateTolerance && ++iteration < steadyStateIterations);
+        if (change > steadyStateTolerance) {
+            std::cout << "The gain of estimator " << name << " does not converge; check that the model is detectable" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+#ifdef DEBUG
+        std::cout << "Steady state gain of estimator " << name << " after " << iteration << " steps:";
+        for (uint32_t i = 0; i < dimension; i++) {
+            for (uint32_t j = 0; j < numOutputs; j++) {
+                std::cout << " " << K[i][j];
+            }
+        }
+        std::cout << std::endl;
+#endif
+    }
+    std::copy(&P[0][0], &P[0][0] + maxEstimatorDimension * maxEstimatorDimension, &initialP[0][0]);
+    reset();
+}
+
+void KalmanFilter::readModel(std::string fileNamePrefix, const ModelShape& shape) {
+    dimension = shape.dimension;
+    numInputs = shape.numInputs;
+    numOutputs = shape.numOutputs;
+
+    readModelValues(&A[0][0], fileNamePrefix + "_A.txt", dimension, dimension, maxEstimatorDimension);
+    readModelValues(&B[0][0], fileNamePrefix + "_B.txt", dimension, numInputs, maxEstimatorDimension);
+    readModelValues(&C[0][0], fileNamePrefix + "_C.txt", numOutputs, dimension, maxEstimatorDimension);
+    readModelValues(&D[0][0], fileNamePrefix + "_D.txt", numOutputs, numInputs, maxEstimatorDimension);
+    readModelValues(inputOffsets, fileNamePrefix + "_inputOffsets.txt", 1, numInputs, numInputs);
+    readModelValues(outputOffsets, fileNamePrefix + "_outputOffsets.txt", 1, numOutputs, numOutputs);
+
+    readCovariance(Q, fileNamePrefix + "_Q.txt", dimension);
+    if (std::ifstream(fileNamePrefix + "_R.txt")) {
+        readCovariance(R, fileNamePrefix + "_R.txt", numOutputs);
+    } else {
+        double noiseStddev[maxEstimatorDimension];
+        readModelValues(noiseStddev, fileNamePrefix + "_noise.txt", 1, numOutputs, numOutputs);
+        for (uint32_t i = 0; i < numOutputs; i++) {
+            R[i][i] = noiseStddev[i] * noiseStddev[i];
+        }
+    }
+    for (uint32_t i = 0; i < numOutputs; i++) {
+        if (R[i][i] <= 0.0) {
+            std::cout << "The measurement noise of estimator " << name << " must be > 0 for every output" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+#ifdef DEBUG
+    std::cout << "Estimator " << name << " with " << dimension << " states, " << numInputs <<
+            " inputs and " << numOutputs << " outputs" << (timeVarying ? ", time varying" : "") << std::endl;
+#endif
+}
+
+void KalmanFilter::updateGain() {
+    auto n = dimension, m = numOutputs;
+    //predictedP = A P A' + Q
+    multiply(temp, A, P, n, n, n);
+    multiplyTransposed(predictedP, temp, A, n, n, n);
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+            predictedP[i][j] += Q[i][j];
+        }
+    }
+
+    //K = predictedP C' (C predictedP C' + R)^-1
+    multiplyTransposed(PCt, predictedP, C, n, n, m);
+    multiply(S, C, PCt, m, n, m);
+    for (uint32_t i = 0; i < m; i++) {
+        for (uint32_t j = 0; j < m; j++) {
+            S[i][j] += R[i][j];
+        }
+    }
+    if (!inverse(&Sinv[0][0], &S[0][0], m, maxEstimatorDimension)) {
+        return; //keep the last gain
+    }
+    multiply(K, PCt, Sinv, n, m, m);
+
+    //Joseph form, which keeps P symmetric and positive: P = (I - K C) predictedP (I - K C)' + K R K'
+    multiply(IKC, K, C, n, m, n);
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+            IKC[i][j] = ((i == j) ? 1.0 : 0.0) - IKC[i][j];
+        }
+    }
+    multiply(temp, IKC, predictedP, n, n, n);
+    multiplyTransposed(P, temp, IKC, n, n, n);
+    multiply(temp, K, R, n, m, m);
+    multiplyTransposed(predictedP, temp, K, n, m, n);
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+            P[i][j] += predictedP[i][j];
+        }
+    }
+}
+
+void KalmanFilter::estimate() {
+    for (uint32_t j = 0; j < numInputs; j++) {
+        currInputs[j] = inputs[j] - inputOffsets[j];
+    }
+    if (timeVarying) {
+        updateGain();
+    }
+
+    //the inputs read with the measurements are the ones that were applied during the last period
+    for (uint32_t i = 0; i < dimension; i++) {
+        double sum = 0.0;
+        for (uint32_t j = 0; j < dimension; j++) {
+            sum += A[i][j] * state[j];
+        }
+        for (uint32_t j = 0; j < numInputs; j++) {
+            sum += B[i][j] * currInputs[j];
+        }
+        predictedState[i] = sum;
+    }
+    for (uint32_t o = 0; o < numOutputs; o++) {
+        double sum = measurements[o] - outputOffsets[o];
+        for (uint32_t j = 0; j < dimension; j++) {
+            sum -= C[o][j] * predictedState[j];
+        }
+        for (uint32_t j = 0; j < numInputs; j++) {
+            sum -= D[o][j] * currInputs[j];
+        }
+        innovation[o] = sum;
+    }
+    for (uint32_t i = 0; i < dimension; i++) {
+        double sum = predictedState[i];
+        for (uint32_t o = 0; o < numOutputs; o++) {
+            sum += K[i][o] * innovation[o];
+        }
+        state[i] = sum;
+    }
+    for (uint32_t o = 0; o < numOutputs; o++) {
+        double sum = outputOffsets[o];
+        for (uint32_t j = 0; j < dimension; j++) {
+            sum += C[o][j] * state[j];
+        }
+        for (uint32_t j = 0; j < numInputs; j++) {
+            sum += D[o][j] * currInputs[j];
+        }
+        estimates[o] = sum;
+    }
+}
+
+void KalmanFilter::reset() {
+    std::fill(state, state + maxEstimatorDimension, 0.0);
+    std::copy(&initialP[0][0], &initialP[0][0] + maxEstimatorDimension * maxEstimatorDimension, &P[0][0]);
+}
@@ -0,0 +1,130 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   Excitation.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "Excitation.h"
+#include "debug.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+Excitation::Excitation(double amplitude) :
+amplitude(amplitude) {
+    if (amplitude <= 0.0 || amplitude > 1.0) {
+        std::cout << "The amplitude of an excitation must be in (0, 1]" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+PRBS::PRBS(uint32_t clockPeriods, uint32_t levels, uint32_t shift, double amplitude) :
+Excitation(amplitude),
+clockPeriods(clockPeriods),
+levels(levels),
+count(0),
+reg(1),
+value(0.0) {
+    if (clockPeriods == 0 || levels < 2) {
+        std::cout << "A PRBS needs a clock of at least 1 period and at least 2 levels" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    for (uint32_t i = 0; i < shift * ((levels == 2) ? 1 : prbsOrder); i++) {
+        advance();
+    }
+}
+
+void PRBS::advance() {
+    //x^11 + x^9 + 1 is primitive, so the register visits all 2047 nonzero states
+    auto bit = ((reg >> 10) ^ (reg >> 8)) & 1;
+    reg = ((reg << 1) | bit) & ((1u << prbsOrder) - 1);
+}
+
+double PRBS::next() {
+    if (count == 0) {
+        if (levels == 2) {
+            advance();
+            value = (reg & 1) ? amplitude : -amplitude;
+        } else {
+            //a whole new register, so that consecutive levels are independent
+            for (uint32_t i = 0; i < prbsOrder; i++) {
+                advance();
+            }
+            value = amplitude * (-1.0 + 2.0 * (reg % levels) / (levels - 1));
+        }
+    }
+    count = (count + 1) % clockPeriods;
+    return value;
+}
+
+Multisine::Multisine(uint32_t period, double samplingIntervalS, double lowHz, double highHz, uint32_t input,
+        uint32_t numInputs, double amplitude) :
+Excitation(amplitude),
+values(period, 0.0),
+index(0),
+numHarmonics(0) {
+    //the harmonics go from 1 to period / 2 - 1, so a multisine needs at least 4 periods
+    if (period < 4 || !(lowHz > 0.0) || !(highHz >= lowHz)) {
+        std::cout << "A multisine needs a period of at least 4 sampling intervals and 0 < lowHz <= highHz" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    //harmonic k has the frequency k / (period x samplingIntervalS)
+    auto resolutionHz = 1.0 / (period * samplingIntervalS);
+    uint32_t lowest = std::max(1.0, std::ceil(lowHz / resolutionHz));
+    uint32_t highest = std::min(period / 2.0 - 1.0, std::floor(highHz / resolutionHz));
+    std::vector<uint32_t> harmonics;
+    for (auto k = lowest; k <= highest; k++) {
+        if (k % numInputs == input % numInputs) {
+            harmonics.push_back(k);
+        }
+    }
+    numHarmonics = harmonics.size();
+    if (numHarmonics == 0) {
+        std::cout << "A multisine of " << period << " periods has no harmonics of its own between " << lowHz <<
+                " and " << highHz << " Hz (resolution " << resolutionHz << " Hz)" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    //Schroeder phases and unit amplitudes, then scaled so that the peak is amplitude
+    double peak = 0.0;
+    for (uint32_t t = 0; t < period; t++) {
+        double sum = 0.0;
+        for (uint32_t j = 0; j < numHarmonics; j++) {
+            auto phase = -M_PI * j * (j + 1) / numHarmonics;
+            sum += std::cos(2.0 * M_PI * harmonics[j] * t / period + phase);
+        }
+        values[t] = sum;
+        peak = std::max(peak, std::abs(sum));
+    }
+    for (auto& value : values) {
+        value *= amplitude / peak;
+    }
+#ifdef DEBUG
+    std::cout << "Multisine with harmonics " << lowest << " to " << highest << ", " << numHarmonics <<
+            " of them, crest factor " << peak / std::sqrt(numHarmonics / 2.0) << std::endl;
+#endif
+}
+
+double Multisine::next() {
+    auto value = values[index];
+    index = (index + 1) % values.size();
+    return value;
+}
+
+uint32_t Multisine::getNumHarmonics() {
+    return numHarmonics;
+}
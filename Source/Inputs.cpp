@@ -20,6 +20,7 @@
 #include "Inputs.h"
 #include "debug.h"
 #include "Sensors.h"
+#include "Topology.h"
 #include <fstream>
 #include <cmath>
 #include <algorithm>
@@ -35,7 +36,8 @@
 Input::Input(std::string iname) : Sensor(iname),
 in(std::make_shared<InputPort>(iname, std::initializer_list<std::string>({iname}))),
 requestedWriteValue(0.0),
-actualWriteValue(0.0) {
+actualWriteValue(0.0),
+rewritePending(false) {
 
 }
 
@@ -54,19 +56,50 @@ double Input::sanitizeValue(double val) {
 }
 
 void Input::prepareValueToBeWritten(Vector newValues) {
-    requestedWriteValue = newValues[0];
+    prepareValueToBeWritten(newValues[0]);
+}
+
+void Input::prepareValueToBeWritten(double newValue) {
+    requestedWriteValue = newValue;
     actualWriteValue = sanitizeValue(requestedWriteValue);
 }
 
+void Input::updateValuesFromSystem() {
+    std::lock_guard<std::mutex> lock(ioLock);
+    Sensor::updateValuesFromSystem();
+}
+
 void Input::updateValueToSystem() {
-    if (in->areValuesUnread() == false) {
+    if (hasPendingValue() == false) {
 #ifdef DEBUG
         std::cout << "Didn't receive any new values for " << name << std::endl;
 #endif
         return;
     }
 
-    prepareValueToBeWritten(in->updateValuesFromPort());
+    double newValue;
+    takePendingValue(&newValue);
+    applyValueToSystem(&newValue);
+}
+
+bool Input::hasPendingValue() {
+    return in->areValuesUnread() || rewritePending.load();
+}
+
+void Input::takePendingValue(double* newValue) {
+    if (in->areValuesUnread()) {
+        rewritePending.store(false);
+        in->updateValuesFromPort(newValue);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(ioLock);
+    rewritePending.store(false);
+    *newValue = actualWriteValue;
+}
+
+void Input::applyValueToSystem(const double* newValue) {
+    std::lock_guard<std::mutex> lock(ioLock);
+    prepareValueToBeWritten(*newValue);
 
 #ifdef DEBUG
     std::cout << " Asked to write " << requestedWriteValue << " writing " << actualWriteValue <<
@@ -121,11 +154,11 @@ void Input::updateMinMaxMid() {
 #endif
 }
 
-void Input::setRandomValue() {
+void Input::setRandomValue(RandomStream& random) {
 #ifdef DEBUG
     std::cout << "Setting random value for " << name << std::endl;
 #endif
-    auto id = rand() % (allowedValues.size());
+    auto id = random.uniformInt(0, allowedValues.size() - 1);
     in->receiveValues(Vector({allowedValues[id]}));
 }
 
@@ -150,6 +183,25 @@ void Input::setMidValue() {
     in->receiveValues(Vector({midVal}));
 }
 
+void Input::setNormalizedValue(double value) {
+#ifdef DEBUG
+    std::cout << "Setting normalized value " << value << " for " << name << std::endl;
+#endif
+    in->receiveValues(Vector({sanitizeValue(midVal + value * (maxVal - minVal) / 2.0)}));
+}
+
+double Input::getMinValue() {
+    return minVal;
+}
+
+double Input::getMaxValue() {
+    return maxVal;
+}
+
+const std::vector<double>& Input::getAllowedValues() {
+    return allowedValues;
+}
+
 void Input::reset() {
 #ifdef DEBUG
     std::cout << "Reset called for " << name << std::endl;
@@ -157,8 +209,18 @@ void Input::reset() {
     setMaxValue();
 }
 
-CPUFrequency::CPUFrequency(std::string name) :
+CPUFrequency::CPUFrequency(std::string name, int package_) :
 Input(name) {
+    package = package_;
+    if (package >= 0) {
+        auto packageCPUs = getPackageCPUs();
+        if ((uint32_t) package >= packageCPUs.size()) {
+            std::cout << "Input " << name << " is for package " << package << " but there are only " <<
+                    packageCPUs.size() << " packages" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        coreIds = packageCPUs[package];
+    }
     //Find number of cores
     std::string coreStatusString;
     std::ifstream coreFile(presentCPUCoreFileName);
@@ -170,7 +232,7 @@ Input(name) {
         endCore = std::stoul(coreStatusString.substr(delimPos + 1));
         numCores = endCore - startCore + 1;
     }
-    for (auto i = 0; i < numCores; i++){
+    for (auto i = 0; package < 0 && i < numCores; i++){
         coreIds.push_back(i);
     }
 
@@ -194,7 +256,7 @@ Input(name) {
         freqWMinFileName.push_back(fileName);
 
         //populate freqWFileNameMax
-        fileName.replace(fileName.find("min"), 3, "max");
+        fileName.replace(fileName.rfind("min"), 3, "max");
         freqWMaxFileName.push_back(fileName);
 
     }
@@ -202,7 +264,7 @@ Input(name) {
     //find min frequency
     minVal = 0, maxVal = 0;
     auto tmpFreqFileName = freqRFileName[0];
-    tmpFreqFileName.replace(tmpFreqFileName.find("scaling_cur"), 11, "cpuinfo_min");
+    tmpFreqFileName.replace(tmpFreqFileName.rfind("scaling_cur"), 11, "cpuinfo_min");
     std::ifstream freqFile(tmpFreqFileName);
 #ifdef DEBUG
     std::cout << tmpFreqFileName << std::endl;
@@ -211,7 +273,7 @@ Input(name) {
     freqFile.close();
 
     //find max frequency
-    tmpFreqFileName.replace(tmpFreqFileName.find("min"), 3, "max");
+    tmpFreqFileName.replace(tmpFreqFileName.rfind("min"), 3, "max");
     freqFile.open(tmpFreqFileName);
 #ifdef DEBUG
     std::cout << tmpFreqFileName << std::endl;
@@ -385,7 +447,7 @@ void CPUFrequency::readFromSystem() {
 #ifdef DEBUG
         std::cout << "Supposedly " << actualWriteValue << std::endl;
 #endif
-        in->receiveValues(Vector({actualWriteValue}));
+        rewritePending.store(true);
     }
 }
 
@@ -400,6 +462,7 @@ IdleInject::IdleInject(std::string name) : Input(name) {
         //Check all the entries and find the intel powerclamp file
         while ((dEntry = readdir(dir)) != NULL) {
             std::string deviceDirName(dEntry->d_name);
+            deviceType.clear(); //entries without a type file (e.g., "..") must not keep the previous type
             deviceTypeFileName = dirName + "/" + deviceDirName + devicetypePostfix;
             file.open(deviceTypeFileName);
             file >> deviceType;
@@ -473,7 +536,12 @@ void IdleInject::reset() {
     file << 0;
 }
 
-PowerBalloon::PowerBalloon(std::string name) : Input(name) {
+PowerBalloon::PowerBalloon(std::string name, int package_) : Input(name) {
+    package = package_;
+    if (package >= 0) {
+        pbFileName = systemPath("/dev/shm/powerBalloon" + std::to_string(package) + ".txt");
+        pbMaxFileName = systemPath("/dev/shm/powerBalloonMax" + std::to_string(package) + ".txt");
+    }
     uint32_t maxLevel;
     std::ifstream pbFile(pbMaxFileName);
     if (!pbFile) {
@@ -0,0 +1,68 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/*
+ * File:   LogHeader.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "LogHeader.h"
+
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+
+bool LogHeader::addLine(const std::vector<std::string>& words) {
+    if (found || words.empty()) {
+        return found;
+    }
+    if (std::none_of(words.begin(), words.end(), isLogNumber)) {
+        names = words;
+    } else if (!names.empty() && words.size() == names.size() && std::all_of(words.begin(), words.end(), isLogNumber)) {
+        found = true;
+    }
+    return found;
+}
+
+const std::vector<std::string>& LogHeader::getNames() const {
+    return names;
+}
+
+bool LogHeader::isFound() const {
+    return found;
+}
+
+bool isLogNumber(const std::string& word) {
+    char* end;
+    std::strtod(word.c_str(), &end);
+    return end != word.c_str() && *end == '\0';
+}
+
+std::vector<std::string> splitLogLine(const char* begin, const char* end) {
+    std::vector<std::string> words;
+    const char* p = begin;
+    while (p < end) {
+        while (p < end && std::isspace((unsigned char) *p)) {
+            p++;
+        }
+        const char* wordBegin = p;
+        while (p < end && !std::isspace((unsigned char) *p)) {
+            p++;
+        }
+        if (p > wordBegin) {
+            words.emplace_back(wordBegin, p);
+        }
+    }
+    return words;
+}
@@ -0,0 +1,456 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   MPCController.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "MPCController.h"
+#include "Simulation.h"
+#include "debug.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+//gradients and steps of the normalized inputs below this are 0
+const double solverTolerance = 1e-9;
+
+//fraction of the new error between the measured and the predicted outputs added to the disturbance
+const double disturbanceGain = 0.2;
+
+}
+
+MPCController::MPCController(std::string name, std::string dirPath, std::string ctlFileName, std::string modelPrefix,
+        uint32_t periodUS, double budget) :
+Controller(name, periodUS),
+A(), B(), C(), D(),
+budget(budget),
+built(false),
+fallbacks(0) {
+    if (modelPrefix.empty()) {
+        std::cout << "MPC controller " << name << " needs a model" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    if (budget <= 0.0) {
+        std::cout << "The budget of MPC controller " << name << " must be > 0" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    readModel(modelPrefix);
+
+    std::string fileNamePrefix = dirPath + "/" + ctlFileName;
+    std::fill(outputWeights, outputWeights + maxMPCInputs, 1.0);
+    std::fill(moveWeights, moveWeights + maxMPCInputs, defaultMPCMoveWeight);
+    if (std::ifstream(fileNamePrefix + "_mpcOutputWeights.txt")) {
+        readModelValues(outputWeights, fileNamePrefix + "_mpcOutputWeights.txt", 1, numOutputs, numOutputs);
+    }
+    if (std::ifstream(fileNamePrefix + "_mpcMoveWeights.txt")) {
+        readModelValues(moveWeights, fileNamePrefix + "_mpcMoveWeights.txt", 1, numInputs, numInputs);
+    }
+    for (uint32_t i = 0; i < std::max(numInputs, numOutputs); i++) {
+        if ((i < numOutputs && outputWeights[i] < 0.0) || (i < numInputs && moveWeights[i] <= 0.0)) {
+            std::cout << "The output weights of MPC controller " << name << " must be >= 0 and its move weights > 0" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    reset();
+}
+
+void MPCController::readModel(std::string modelPrefix) {
+    dimension = readModelCount(modelPrefix + "_dimension.txt", maxMPCDimension);
+    numInputs = readModelCount(modelPrefix + "_numInputs.txt", maxMPCInputs);
+    numOutputs = readModelCount(modelPrefix + "_numOutputs.txt", maxMPCInputs);
+    modelInputNames = readModelNames(modelPrefix + "_inputNames.txt", numInputs);
+    modelOutputNames = readModelNames(modelPrefix + "_outputNames.txt", numOutputs);
+
+    readModelValues(&A[0][0], modelPrefix + "_A.txt", dimension, dimension, maxMPCDimension);
+    readModelValues(&B[0][0], modelPrefix + "_B.txt", dimension, numInputs, maxMPCInputs);
+    readModelValues(&C[0][0], modelPrefix + "_C.txt", numOutputs, dimension, maxMPCDimension);
+    readModelValues(&D[0][0], modelPrefix + "_D.txt", numOutputs, numInputs, maxMPCInputs);
+    readModelValues(inputOffsets, modelPrefix + "_inputOffsets.txt", 1, numInputs, numInputs);
+    readModelValues(outputOffsets, modelPrefix + "_outputOffsets.txt", 1, numOutputs, numOutputs);
+#ifdef DEBUG
+    std::cout << "MPC controller " << name << " with a model of " << dimension << " states, " << numInputs <<
+            " inputs and " << numOutputs << " outputs" << std::endl;
+#endif
+}
+
+void MPCController::setInputLimits(Vector minVals, Vector maxVals, std::vector<std::vector<double>> allowedVals) {
+    Controller::setInputLimits(minVals, maxVals, allowedVals);
+    if (newInputVals->getPinNames() != modelInputNames || outputVals->getPinNames() != modelOutputNames) {
+        std::cout << "The inputs and outputs of MPC controller " << name <<
+                " must be the ones of its model, in the same order" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    if (inputMinVals.size() != numInputs) {
+        std::cout << "MPC controller " << name << " needs the range of every input" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    buildProblem();
+}
+
+void MPCController::buildProblem() {
+    auto n = dimension, m = numInputs, p = numOutputs, numVariables = numInputs * mpcHorizon;
+    for (uint32_t i = 0; i < m; i++) {
+        inputLows[i] = inputMinVals[i];
+        inputSpans[i] = inputMaxVals[i] - inputMinVals[i];
+    }
+
+    //the outputs predicted over the horizon are y = Phi x + G (u - u0) + y0 + disturbance,
+    //where block (j, i) of G is C A^(j-i) B, plus D when i = j
+    std::vector<std::vector<double>> CAk(p, std::vector<double>(n)); //C A^k
+    std::vector<std::vector<double>> markov(mpcHorizon * p, std::vector<double>(m)); //C A^k B, k = 0..horizon-1
+    std::vector<std::vector<double>> Phi(mpcHorizon * p, std::vector<double>(n)); //C A^j, j = 1..horizon
+    for (uint32_t o = 0; o < p; o++) {
+        std::copy(C[o], C[o] + n, CAk[o].begin());
+    }
+    for (uint32_t k = 0; k < mpcHorizon; k++) {
+        for (uint32_t o = 0; o < p; o++) {
+            for (uint32_t i = 0; i < m; i++) {
+                double sum = 0.0;
+                for (uint32_t s = 0; s < n; s++) {
+                    sum += CAk[o][s] * B[s][i];
+                }
+                markov[k * p + o][i] = sum;
+            }
+        }
+        for (uint32_t o = 0; o < p; o++) {
+            for (uint32_t s = 0; s < n; s++) {
+                double sum = 0.0;
+                for (uint32_t t = 0; t < n; t++) {
+                    sum += CAk[o][t] * A[t][s];
+                }
+                Phi[k * p + o][s] = sum;
+            }
+            CAk[o] = Phi[k * p + o];
+        }
+    }
+
+    //G scaled by the ranges, for the normalized inputs, and G (lows - u0)
+    std::vector<std::vector<double>> GS(mpcHorizon * p, std::vector<double>(numVariables, 0.0));
+    std::vector<double> GL(mpcHorizon * p, 0.0);
+    for (uint32_t j = 0; j < mpcHorizon; j++) {
+        for (uint32_t o = 0; o < p; o++) {
+            for (uint32_t k = 0; k <= j; k++) {
+                for (uint32_t i = 0; i < m; i++) {
+                    auto gain = markov[(j - k) * p + o][i] + ((k == j) ? D[o][i] : 0.0);
+                    GS[j * p + o][k * m + i] = gain * inputSpans[i];
+                    GL[j * p + o] += gain * (inputLows[i] - inputOffsets[i]);
+                }
+            }
+        }
+    }
+
+    //H = GS' Wy GS + M' Wu M, where M takes the differences of consecutive inputs
+    for (uint32_t a = 0; a < numVariables; a++) {
+        for (uint32_t b = 0; b < numVariables; b++) {
+            double sum = 0.0;
+            for (uint32_t r = 0; r < mpcHorizon * p; r++) {
+                sum += GS[r][a] * outputWeights[r % p] * GS[r][b];
+            }
+            H[a][b] = sum;
+        }
+        for (uint32_t s = 0; s < n; s++) {
+            double sum = 0.0;
+            for (uint32_t r = 0; r < mpcHorizon * p; r++) {
+                sum += GS[r][a] * outputWeights[r % p] * Phi[r][s];
+            }
+            stateGain[a][s] = sum;
+        }
+        for (uint32_t o = 0; o < p; o++) {
+            double sum = 0.0;
+            for (uint32_t j = 0; j < mpcHorizon; j++) {
+                sum += GS[j * p + o][a] * outputWeights[o];
+            }
+            outputGain[a][o] = sum;
+        }
+        double sum = 0.0;
+        for (uint32_t r = 0; r < mpcHorizon * p; r++) {
+            sum += GS[r][a] * outputWeights[r % p] * GL[r];
+        }
+        constantTerm[a] = sum;
+    }
+
+    for (uint32_t a = 0; a < numVariables; a++) {
+        auto i = a % m;
+        H[a][a] += moveWeights[i] * ((a + m < numVariables) ? 2.0 : 1.0);
+        if (a + m < numVariables) {
+            H[a][a + m] -= moveWeights[i];
+            H[a + m][a] -= moveWeights[i];
+        }
+    }
+
+    built = true;
+#ifdef DEBUG
+    std::cout << "MPC controller " << name << " has " << numVariables << " variables" << std::endl;
+#endif
+}
+
+void MPCController::reset() {
+    std::fill(state, state + maxMPCDimension, 0.0);
+    std::fill(disturbance, disturbance + maxMPCInputs, 0.0);
+    std::fill(plan, plan + maxMPCVariables, 0.0);
+    started = false;
+    iterations = 0;
+}
+
+uint32_t MPCController::getIterations() {
+    return iterations;
+}
+
+uint64_t MPCController::getFallbacks() {
+    return fallbacks;
+}
+
+//Cholesky factorization of the rows and columns of H in freeInputs, into reduced; false if it isn't positive
+bool MPCController::factorFree(uint32_t numFree) {
+    for (uint32_t r = 0; r < numFree; r++) {
+        for (uint32_t c = 0; c <= r; c++) {
+            double sum = H[freeInputs[r]][freeInputs[c]];
+            for (uint32_t k = 0; k < c; k++) {
+                sum -= reduced[r][k] * reduced[c][k];
+            }
+            if (r == c) {
+                if (sum <= 0.0) {
+                    return false;
+                }
+                reduced[r][r] = std::sqrt(sum);
+            } else {
+                reduced[r][c] = sum / reduced[c][c];
+            }
+        }
+    }
+    return true;
+}
+
+bool MPCController::solve(uint32_t numVariables) {
+    auto deadline = std::chrono::steady_clock::now() +
+            std::chrono::microseconds((int64_t) (budget * periodUS));
+    //start from the last plan; the inputs at a bound in it are held there
+    for (uint32_t a = 0; a < numVariables; a++) {
+        z[a] = plan[a];
+        bound[a] = (z[a] <= 0.0) ? -1 : ((z[a] >= 1.0) ? 1 : 0);
+    }
+    for (iterations = 1; iterations <= mpcMaxIterations; iterations++) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        for (uint32_t a = 0; a < numVariables; a++) {
+            double sum = linear[a];
+            for (uint32_t b = 0; b < numVariables; b++) {
+                sum += H[a][b] * z[b];
+            }
+            gradient[a] = sum;
+        }
+
+        //Newton step of the free inputs: H_free step = -gradient_free
+        uint32_t numFree = 0;
+        for (uint32_t a = 0; a < numVariables; a++) {
+            if (bound[a] == 0) {
+                freeInputs[numFree++] = a;
+            }
+        }
+        if (!factorFree(numFree)) {
+            return false;
+        }
+        double largestStep = 0.0;
+        for (uint32_t r = 0; r < numFree; r++) {
+            double sum = -gradient[freeInputs[r]];
+            for (uint32_t k = 0; k < r; k++) {
+                sum -= reduced[r][k] * step[k];
+            }
+            step[r] = sum / reduced[r][r];
+        }
+        for (uint32_t r = numFree; r-- > 0;) {
+            double sum = step[r];
+            for (auto k = r + 1; k < numFree; k++) {
+                sum -= reduced[k][r] * step[k];
+            }
+            step[r] = sum / reduced[r][r];
+            largestStep = std::max(largestStep, std::fabs(step[r]));
+        }
+
+        if (largestStep <= solverTolerance) {
+            //optimal for these bounds: release the input whose bound costs the most, if any
+            uint32_t release = numVariables;
+            double largestGradient = solverTolerance;
+            for (uint32_t a = 0; a < numVariables; a++) {
+                if (bound[a] != 0 && bound[a] * gradient[a] > largestGradient) {
+                    largestGradient = bound[a] * gradient[a];
+                    release = a;
+                }
+            }
+            if (release == numVariables) {
+                return true;
+            }
+            bound[release] = 0;
+            continue;
+        }
+
+        //go as far as the first bound on the way
+        double length = 1.0;
+        uint32_t blocking = numVariables;
+        for (uint32_t r = 0; r < numFree; r++) {
+            auto a = freeInputs[r];
+            double limit = (step[r] < 0.0) ? -z[a] / step[r] : ((step[r] > 0.0) ? (1.0 - z[a]) / step[r] : 1.0);
+            if (limit < length) {
+                length = limit;
+                blocking = a;
+            }
+        }
+        for (uint32_t r = 0; r < numFree; r++) {
+            z[freeInputs[r]] = std::min(std::max(z[freeInputs[r]] + length * step[r], 0.0), 1.0);
+        }
+        if (blocking < numVariables) {
+            bound[blocking] = (z[blocking] < 0.5) ? -1 : 1;
+            z[blocking] = (bound[blocking] < 0) ? 0.0 : 1.0;
+        }
+    }
+    return false;
+}
+
+void MPCController::chooseAllowedValues() {
+    if (inputAllowedVals.size() != numInputs) {
+        return;
+    }
+    auto numVariables = numInputs * mpcHorizon;
+    //gradient of the cost, to find the change of the cost when one input moves
+    for (uint32_t a = 0; a < numVariables; a++) {
+        double sum = linear[a];
+        for (uint32_t b = 0; b < numVariables; b++) {
+            sum += H[a][b] * plan[b];
+        }
+        gradient[a] = sum;
+    }
+    for (uint32_t i = 0; i < numInputs; i++) {
+        auto& values = inputAllowedVals[i];
+        if (values.empty() || inputSpans[i] <= 0.0) {
+            continue;
+        }
+        auto value = inputLows[i] + inputSpans[i] * plan[i];
+        auto above = std::lower_bound(values.begin(), values.end(), value);
+        auto below = (above == values.begin()) ? above : above - 1;
+        if (above == values.end()) {
+            above = below;
+        }
+        double bestDelta = 0.0, bestCost = 0.0;
+        bool first = true;
+        for (auto candidate : {*below, *above}) {
+            auto delta = (candidate - value) / inputSpans[i];
+            auto cost = delta * gradient[i] + 0.5 * H[i][i] * delta * delta;
+            if (first || cost < bestCost) {
+                bestDelta = delta;
+                bestCost = cost;
+                first = false;
+            }
+        }
+        plan[i] += bestDelta;
+        for (uint32_t a = 0; a < numVariables; a++) {
+            gradient[a] += H[a][i] * bestDelta;
+        }
+    }
+}
+
+Vector MPCController::computeNewInputs() {
+#ifdef DEBUG
+    std::cout << "------MPC Controller: " << name << "------" << std::endl;
+#endif
+
+    auto currIpVals = currInputVals->updateValuesFromPort();
+    auto currTargets = outputTargetVals->updateValuesFromPort();
+    auto currOpVals = outputVals->updateValuesFromPort();
+    if (!built) {
+        std::cout << "MPC controller " << name << " runs without the ranges of its inputs" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    auto m = numInputs, numVariables = numInputs * mpcHorizon;
+
+    //simulate the model with the inputs applied in the last period, and update the disturbance
+    for (uint32_t i = 0; i < m; i++) {
+        currInputs[i] = currIpVals[i] - inputOffsets[i];
+        currNormalized[i] = (inputSpans[i] > 0.0) ? (currIpVals[i] - inputLows[i]) / inputSpans[i] : 0.0;
+    }
+    double nextState[maxMPCDimension];
+    for (uint32_t s = 0; s < dimension; s++) {
+        double sum = 0.0;
+        for (uint32_t t = 0; t < dimension; t++) {
+            sum += A[s][t] * state[t];
+        }
+        for (uint32_t i = 0; i < m; i++) {
+            sum += B[s][i] * currInputs[i];
+        }
+        nextState[s] = sum;
+    }
+    std::copy(nextState, nextState + dimension, state);
+    for (uint32_t o = 0; o < numOutputs; o++) {
+        double predicted = outputOffsets[o];
+        for (uint32_t s = 0; s < dimension; s++) {
+            predicted += C[o][s] * state[s];
+        }
+        for (uint32_t i = 0; i < m; i++) {
+            predicted += D[o][i] * currInputs[i];
+        }
+        auto error = currOpVals[o] - predicted;
+        disturbance[o] = started ? disturbance[o] + disturbanceGain * (error - disturbance[o]) : error;
+    }
+
+    //shift the last plan by one period; the first time, hold the current inputs
+    for (uint32_t a = 0; a < numVariables; a++) {
+        if (!started) {
+            plan[a] = currNormalized[a % m];
+        } else if (a + m < numVariables) {
+            plan[a] = plan[a + m];
+        }
+    }
+    started = true;
+
+    for (uint32_t a = 0; a < numVariables; a++) {
+        double sum = constantTerm[a];
+        for (uint32_t s = 0; s < dimension; s++) {
+            sum += stateGain[a][s] * state[s];
+        }
+        for (uint32_t o = 0; o < numOutputs; o++) {
+            sum += outputGain[a][o] * (outputOffsets[o] + disturbance[o] - currTargets[o]);
+        }
+        if (a < m) {
+            sum -= moveWeights[a] * currNormalized[a];
+        }
+        linear[a] = sum;
+    }
+
+    bool converged = solve(numVariables);
+    if (converged) {
+        std::copy(z, z + numVariables, plan);
+    } else {
+        fallbacks++;
+    }
+    chooseAllowedValues();
+
+    Vector newIpVals(m);
+    for (uint32_t i = 0; i < m; i++) {
+        newIpVals[i] = inputLows[i] + inputSpans[i] * plan[i];
+    }
+
+#ifdef DEBUG
+    std::cout << "currIpVals " << currIpVals << "currOpVals " << currOpVals <<
+            "currTargets " << currTargets << "iterations " << iterations <<
+            (converged ? "" : " (fell back to the last plan)") << " newIpVals " << newIpVals;
+#endif
+    return newIpVals;
+}
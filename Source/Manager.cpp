@@ -18,9 +18,12 @@
  */
 
 #include "Manager.h"
+#include "Topology.h"
 #include "debug.h"
 
 #include <iomanip>
+#include <algorithm>
+#include <cmath>
 #include <signal.h>
 #include <cstring>
 #include <thread>
@@ -41,29 +44,54 @@ void Manager::setupSigKillHandler() {
 
 Manager::Manager(uint32_t samplingIntervalMS, Mode mode) :
 samplingIntervalMS(samplingIntervalMS),
-mode(mode) {
+mode(mode),
+stopActuating(false) {
     setupSigKillHandler();
 }
 
+void Manager::setExecMode(ExecMode newExecMode) {
+    execMode = newExecMode;
+}
+
+void Manager::setNumWorkers(uint32_t numWorkers_) {
+    numWorkers = numWorkers_;
+}
+
+uint32_t Manager::getSamplingIntervalMS() {
+    return samplingIntervalMS;
+}
+
+void Manager::useVirtualClock(std::shared_ptr<VirtualClock> clock) {
+    scheduler.useVirtualClock(clock);
+    usesVirtualClock = true;
+}
+
+void Manager::setRunDurationUS(uint64_t durationUS) {
+    runDurationUS = durationUS;
+}
+
+void Manager::setStopCondition(std::function<bool()> shouldStop) {
+    stopCondition = shouldStop;
+}
+
 void Manager::addInput(std::unique_ptr<Input> newInput) {
     if (newInput == nullptr) {
         std::cout << "Cannot add Null pointer as input" << std::endl;
         std::exit(EXIT_FAILURE);
     }
     //Check if an input with the same name is added twice
-    auto newInputPinNames = newInput->out->getPinNames();
-    for (auto& input : inputList) {
-        auto pinNames = input->out->getPinNames();
-        for (auto& pinName : pinNames) {
-            if (std::find(newInputPinNames.begin(), newInputPinNames.end(), pinName) != newInputPinNames.end()) {
-                std::cout << "Cannot add two inputs with same name: " << pinName << std::endl;
-                std::exit(EXIT_FAILURE);
-            }
+    const auto& newInputPinNames = newInput->out->getPinNames();
+    for (auto& pinName : newInputPinNames) {
+        auto entry = findName(inputNames, inputNameEntries, pinName);
+        if (entry != nullptr && entry->isPin) {
+            std::cout << "Cannot add two inputs with same name: " << pinName << std::endl;
+            std::exit(EXIT_FAILURE);
         }
     }
 #ifdef DEBUG
     std::cout << "Adding " << newInput->getName() << " with index " << inputList.size() << std::endl;
 #endif
+    registerNames(inputNames, inputNameEntries, newInput->getName(), newInputPinNames, inputList.size());
     inputList.push_back(std::move(newInput));
 }
 
@@ -72,37 +100,36 @@ void Manager::addSensor(std::unique_ptr<Sensor> newSensor) {
         std::cout << "Cannot add Null pointer as sensor" << std::endl;
         std::exit(EXIT_FAILURE);
     }
-    auto newSensorPinNames = newSensor->out->getPinNames();
+    const auto& newSensorPinNames = newSensor->out->getPinNames();
 
     //Check if a sensor with the same name is added twice
-    for (auto& sensor : sensorList) {
-        auto pinNames = sensor->out->getPinNames();
-        for (auto& pinName : pinNames) {
-            if (std::find(newSensorPinNames.begin(), newSensorPinNames.end(), pinName) != newSensorPinNames.end()) {
-                std::cout << "Cannot add two sensors with same name: " << pinName << std::endl;
-                std::exit(EXIT_FAILURE);
-            }
+    for (auto& pinName : newSensorPinNames) {
+        auto entry = findName(sensorNames, sensorNameEntries, pinName);
+        if (entry != nullptr && entry->isPin) {
+            std::cout << "Cannot add two sensors with same name: " << pinName << std::endl;
+            std::exit(EXIT_FAILURE);
         }
     }
   #ifdef DEBUG
     std::cout << "Adding " << newSensor->getName() << " with index " << sensorList.size() << std::endl;
 #endif
+    registerNames(sensorNames, sensorNameEntries, newSensor->getName(), newSensorPinNames, sensorList.size());
     sensorList.push_back(std::move(newSensor));
 }
 
 void Manager::addSysIdParams(std::vector<std::string> sysidList_,
-        std::initializer_list<uint32_t> minHoldTime,
-        std::initializer_list<uint32_t> maxHoldTime,
-        std::initializer_list<uint32_t> initHoldTime) {
+        std::vector<uint32_t> minHoldTime,
+        std::vector<uint32_t> maxHoldTime,
+        std::vector<uint32_t> initHoldTime) {
 #ifdef DEBUG
     for (auto& item : sysidList_) {
         std::cout << "Asked id for " << item << std::endl;
     }
 #endif
     sysidInputNameList = sysidList_;
-    holdPeriods = std::vector<uint32_t>(initHoldTime);
-    minHoldPeriods = std::vector<uint32_t>(minHoldTime);
-    maxHoldPeriods = std::vector<uint32_t>(maxHoldTime);
+    holdPeriods = initHoldTime;
+    minHoldPeriods = minHoldTime;
+    maxHoldPeriods = maxHoldTime;
 
     auto numSysidInputs = sysidInputNameList.size();
     holdCounters = std::vector<uint32_t>(numSysidInputs, 0);
@@ -129,15 +156,201 @@ void Manager::addSysIdParams(std::vector<std::string> sysidList_,
     }
 }
 
-void Manager::addController(std::string name, std::initializer_list<std::string> opNames,
-        std::initializer_list<std::string> ipNames, ControllerType ctlType,
-        std::string dirPath, std::string fileName, uint32_t smplInt) {
+void Manager::setSysidExcitation(ExcitationType type, std::vector<uint32_t> clockPeriods, uint32_t levels,
+        std::vector<double> lowHz, std::vector<double> highHz, std::vector<double> amplitudes,
+        uint32_t multisinePeriod) {
+    auto numSysidInputs = sysidInputNameList.size();
+    if (numSysidInputs == 0) {
+        std::cout << "The sysid excitation needs the sysid inputs" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    auto samplingIntervalS = samplingIntervalMS / 1000.0;
+    if (clockPeriods.empty()) {
+        clockPeriods = std::vector<uint32_t>(numSysidInputs, defaultMinHoldPeriod);
+    }
+    if (lowHz.empty()) {
+        //the first harmonic of the multisine
+        lowHz = std::vector<double>(numSysidInputs, 1.0 / (multisinePeriod * samplingIntervalS));
+    }
+    if (highHz.empty()) {
+        highHz = std::vector<double>(numSysidInputs, 0.25 / samplingIntervalS); //half the Nyquist frequency
+    }
+    if (amplitudes.empty()) {
+        amplitudes = std::vector<double>(numSysidInputs, 1.0);
+    }
+    if (clockPeriods.size() != numSysidInputs || lowHz.size() != numSysidInputs ||
+            highHz.size() != numSysidInputs || amplitudes.size() != numSysidInputs) {
+        std::cout << "The sysid excitation needs one clock, band and amplitude per sysid input" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    excitations.clear();
+    for (uint32_t i = 0; i < numSysidInputs && type != ExcitationType::Random; i++) {
+        //shifts of the PRBS by a fraction of its period keep the inputs apart
+        auto shift = i * ((1u << prbsOrder) - 1) / numSysidInputs;
+        if (type == ExcitationType::PRBS) {
+            excitations.push_back(std::make_unique<PRBS>(clockPeriods[i], 2, shift, amplitudes[i]));
+        } else if (type == ExcitationType::MultiLevelPRBS) {
+            excitations.push_back(std::make_unique<PRBS>(clockPeriods[i], levels, shift, amplitudes[i]));
+        } else if (type == ExcitationType::Multisine) {
+            excitations.push_back(std::make_unique<Multisine>(multisinePeriod, samplingIntervalS, lowHz[i],
+                    highHz[i], i, numSysidInputs, amplitudes[i]));
+        }
+    }
+    excitationValues = std::vector<double>(excitations.size(), NAN);
+}
+
+void Manager::addSystemIdentifier(std::vector<std::string> outputNames, uint32_t na, uint32_t nb,
+        double forgetting, std::string modelPrefix) {
+    if (sysidInputNameList.empty()) {
+        std::cout << "System identification needs the sysid inputs" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    std::vector<std::string> opPinNames, ipPinNames;
+    std::vector<double> inputMinVals, inputMaxVals;
+    std::vector<uint32_t> inputLevels;
+    for (auto& opName : outputNames) {
+        if (isNameSensorPort(opName)) {
+            auto pinNames = sensorList[getSensorIndexInList(opName)]->out->getPinNames();
+            opPinNames.insert(opPinNames.end(), pinNames.begin(), pinNames.end());
+        } else if (isNameSensorPin(opName)) {
+            opPinNames.push_back(opName);
+        } else {
+            std::cout << "System identification output " << opName << " is not a sensor" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    for (auto& ipName : sysidInputNameList) {
+        auto& input = inputList[getInputIndexInList(ipName)];
+        std::vector<std::string> pinNames;
+        if (isNameInputPort(ipName)) {
+            pinNames = input->out->getPinNames();
+        } else {
+            pinNames.push_back(ipName);
+        }
+        ipPinNames.insert(ipPinNames.end(), pinNames.begin(), pinNames.end());
+        inputMinVals.insert(inputMinVals.end(), pinNames.size(), input->getMinValue());
+        inputMaxVals.insert(inputMaxVals.end(), pinNames.size(), input->getMaxValue());
+        inputLevels.insert(inputLevels.end(), pinNames.size(), input->getAllowedValues().size());
+    }
+    systemId = std::make_unique<SystemIdentifier>(opPinNames, ipPinNames, inputMinVals, inputMaxVals,
+            inputLevels, samplingIntervalMS * 1000, na, nb, forgetting);
+    for (auto& opName : opPinNames) {
+        auto srcPort = sensorList[getSensorIndexInList(opName)]->out;
+        sysReadWires.push_back(std::make_unique<Wire>(srcPort, opName, systemId->outputVals, opName));
+    }
+    for (auto& ipName : ipPinNames) {
+        auto srcPort = inputList[getInputIndexInList(ipName)]->out;
+        sysReadWires.push_back(std::make_unique<Wire>(srcPort, ipName, systemId->inputVals, ipName));
+    }
+    systemIdModelPrefix = modelPrefix;
+}
+
+void Manager::addCalibrator(std::string outputName, std::vector<std::string> inputNames,
+        std::string fileNamePrefix, uint32_t window, double tolerance, uint32_t maxWindows) {
+    if (!isNameSensorPin(outputName)) {
+        std::cout << "Calibration output " << outputName << " is not a sensor pin" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    std::vector<double> inputMinVals, inputMaxVals;
+    for (auto& ipName : inputNames) {
+        if (!isNameInputPort(ipName)) {
+            std::cout << "Calibration input " << ipName << " is not an input" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        auto& input = inputList[getInputIndexInList(ipName)];
+        calibrationInputIndices.push_back(getInputIndexInList(ipName));
+        inputMinVals.push_back(input->getMinValue());
+        inputMaxVals.push_back(input->getMaxValue());
+    }
+    calibrator = std::make_unique<Calibrator>(outputName, inputNames, inputMinVals, inputMaxVals, window,
+            tolerance, maxWindows);
+    auto srcPort = sensorList[getSensorIndexInList(outputName)]->out;
+    sysReadWires.push_back(std::make_unique<Wire>(srcPort, outputName, calibrator->outputVals, outputName));
+    calibrationFileNamePrefix = fileNamePrefix;
+}
+
+void Manager::addEstimator(std::string name, EstimatorType estType, std::string dirPath, std::string fileName,
+        uint32_t periodUS) {
+    if (periodUS == 0) {
+        periodUS = samplingIntervalMS * 1000;
+    }
+    auto estimator = std::make_unique<KalmanFilter>(name, dirPath, fileName, periodUS,
+            estType == EstimatorType::Kalman);
+    for (auto& opName : estimator->getOutputNames()) {
+        if (!isNameSensorPin(opName)) {
+            std::cout << "Estimator " << name << " estimates " << opName << ", which is not a sensor pin" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        for (auto& other : estimatorList) {
+            auto& otherNames = other->getOutputNames();
+            if (std::find(otherNames.begin(), otherNames.end(), opName) != otherNames.end()) {
+                std::cout << opName << " is estimated by both " << other->getName() << " and " << name << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        auto srcPort = sensorList[getSensorIndexInList(opName)]->out;
+        sysReadWires.push_back(std::make_unique<Wire>(srcPort, opName, estimator->measuredVals, opName));
+    }
+    for (auto& ipName : estimator->getInputNames()) {
+        if (!isNameInputPin(ipName)) {
+            std::cout << "Estimator " << name << " depends on " << ipName << ", which is not an input pin" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        auto srcPort = inputList[getInputIndexInList(ipName)]->out;
+        sysReadWires.push_back(std::make_unique<Wire>(srcPort, ipName, estimator->inputVals, ipName));
+    }
+    estimatorList.push_back(std::move(estimator));
+}
+
+void Manager::addController(std::string name, std::vector<std::string> opNames,
+        std::vector<std::string> ipNames, ControllerType ctlType,
+        std::string dirPath, std::string fileName, uint32_t periodUS, bool antiWindup,
+        std::string modelPrefix, double mpcBudget) {
+    if (periodUS == 0) {
+        periodUS = samplingIntervalMS * 1000;
+    }
     std::unique_ptr<Controller> controller;
     if (ctlType == ControllerType::Dummy) {
-        controller = std::make_unique<Controller>(name, smplInt);
+        controller = std::make_unique<Controller>(name, periodUS);
     } else if (ctlType == ControllerType::SSV) {
-        controller = std::make_unique<RobustController>(name, dirPath, fileName, smplInt);
+        controller = std::make_unique<RobustController>(name, dirPath, fileName, periodUS, antiWindup);
+    } else if (ctlType == ControllerType::MPC) {
+        controller = std::make_unique<MPCController>(name, dirPath, fileName, modelPrefix, periodUS, mpcBudget);
+    } else if (ctlType == ControllerType::Bank) {
+        std::cout << "Controller bank " << name << " must be added with its designs and schedule" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    wireController(std::move(controller), opNames, ipNames);
+}
+
+void Manager::addControllerBank(std::string name, std::vector<std::string> opNames,
+        std::vector<std::string> ipNames, std::string dirPath, std::vector<std::string> designFileNames,
+        std::vector<double> points, std::string scheduleName, bool interpolate, double hysteresis,
+        uint32_t periodUS, bool antiWindup) {
+    if (periodUS == 0) {
+        periodUS = samplingIntervalMS * 1000;
     }
+    auto bank = std::make_unique<ControllerBank>(name, dirPath, designFileNames, points, periodUS,
+            interpolate, hysteresis, antiWindup);
+    std::shared_ptr<OutputPort> srcPort;
+    if (isNameSensorPin(scheduleName)) {
+        srcPort = sensorList[getSensorIndexInList(scheduleName)]->out;
+    } else if (isNameInputPin(scheduleName)) {
+        srcPort = inputList[getInputIndexInList(scheduleName)]->out;
+    } else {
+        std::cout << "The schedule " << scheduleName << " of controller bank " << name <<
+                " must be a sensor or input pin" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    bank->scheduleVals->addPin(scheduleName);
+    sysReadWires.push_back(std::make_unique<Wire>(srcPort, scheduleName, bank->scheduleVals, scheduleName));
+    schedulePorts.push_back(bank->scheduleVals);
+    wireController(std::move(bank), opNames, ipNames);
+}
+
+void Manager::wireController(std::unique_ptr<Controller> controller, std::vector<std::string> opNames,
+        std::vector<std::string> ipNames) {
     //set width of ports in controller to take in outputs, curr inputs, curr targets and set new inputs
     //opNames, ipNames could be pins or ports
     for (auto& opName : opNames) {
@@ -151,12 +364,32 @@ void Manager::addController(std::string name, std::initializer_list<std::string>
         controller->outputVals->addPin(pinNames);
         controller->outputTargetVals->addPin(pinNames);
         controller->currOutputTargetVals->addPin(pinNames);
-        sysReadWires.push_back(std::make_unique<Wire>(srcPort, pinNames, controller->outputVals, pinNames));
+        //the pins that an estimator estimates come from it instead of the sensor
+        std::vector<std::string> measuredPinNames;
+        for (auto& pinName : pinNames) {
+            auto estimator = std::find_if(estimatorList.begin(), estimatorList.end(),
+                    [&](std::unique_ptr<Estimator>& est) {
+                        auto& estNames = est->getOutputNames();
+                        return std::find(estNames.begin(), estNames.end(), pinName) != estNames.end();
+                    });
+            if (estimator != estimatorList.end()) {
+                estimateWires.push_back(std::make_unique<Wire>((*estimator)->estimatedVals, pinName,
+                        controller->outputVals, pinName));
+            } else {
+                measuredPinNames.push_back(pinName);
+            }
+        }
+        if (!measuredPinNames.empty()) {
+            sysReadWires.push_back(std::make_unique<Wire>(srcPort, measuredPinNames, controller->outputVals, measuredPinNames));
+        }
     }
 
+    std::vector<double> inputMinVals, inputMaxVals;
+    std::vector<std::vector<double>> inputAllowedVals;
     for (auto& ipName : ipNames) {
-        auto srcPort = inputList[getInputIndexInList(ipName)]->out;
-        auto destPort = inputList[getInputIndexInList(ipName)]->in;
+        auto& input = inputList[getInputIndexInList(ipName)];
+        auto srcPort = input->out;
+        auto destPort = input->in;
         std::vector<std::string> srcPinNames, destPinNames;
         if (isNameInputPort(ipName)) {
             srcPinNames = srcPort->getPinNames();
@@ -165,31 +398,46 @@ void Manager::addController(std::string name, std::initializer_list<std::string>
             srcPinNames.push_back(ipName);
             destPinNames.push_back(ipName);
         }
+        inputMinVals.insert(inputMinVals.end(), destPinNames.size(), input->getMinValue());
+        inputMaxVals.insert(inputMaxVals.end(), destPinNames.size(), input->getMaxValue());
+        inputAllowedVals.insert(inputAllowedVals.end(), destPinNames.size(), input->getAllowedValues());
         controller->currInputVals->addPin(srcPinNames);
         sysReadWires.push_back(std::make_unique<Wire>(srcPort, srcPinNames, controller->currInputVals, srcPinNames));
 
         controller->newInputVals->addPin(destPinNames);
         sysWriteWires.push_back(std::make_unique<Wire>(controller->newInputVals, destPinNames, destPort, destPinNames));
     }
+    controller->setInputLimits(Vector(inputMinVals), Vector(inputMaxVals), inputAllowedVals);
     controllerList.push_back(std::move(controller));
 }
 
 void Manager::addMaskGenerator(std::string name, std::string controllerName, MaskGenType maskType,
-        std::string dirPath, std::string fileName, uint32_t smplInt, bool randomProp) {
+        std::string dirPath, std::string fileName, uint32_t periodUS, bool randomProp, uint32_t lookahead) {
+    if (periodUS == 0) {
+        periodUS = samplingIntervalMS * 1000;
+    }
     //Create  planner
     std::unique_ptr<Planner> planner;
     if (maskType == MaskGenType::Constant) {
-        planner = std::make_unique<Planner>(name, dirPath, fileName, smplInt);
+        planner = std::make_unique<Planner>(name, dirPath, fileName, periodUS);
     } else if (maskType == MaskGenType::Gauss) {
-        planner = std::make_unique<MaskGenerator>(name, dirPath, fileName, smplInt, SignalType::Normal, randomProp);
+        planner = std::make_unique<MaskGenerator>(name, dirPath, fileName, periodUS, SignalType::Normal, randomProp, lookahead);
     } else if (maskType == MaskGenType::Sine) {
-        planner = std::make_unique<MaskGenerator>(name, dirPath, fileName, smplInt, SignalType::Sine, randomProp);
+        planner = std::make_unique<MaskGenerator>(name, dirPath, fileName, periodUS, SignalType::Sine, randomProp, lookahead);
     } else if (maskType == MaskGenType::GaussSine) {
-        planner = std::make_unique<MaskGenerator>(name, dirPath, fileName, smplInt, SignalType::GaussSine, randomProp);
+        planner = std::make_unique<MaskGenerator>(name, dirPath, fileName, periodUS, SignalType::GaussSine, randomProp, lookahead);
     } else if (maskType == MaskGenType::Uniform) {
-        planner = std::make_unique<MaskGenerator>(name, dirPath, fileName, smplInt, SignalType::Uniform, randomProp);
+        planner = std::make_unique<MaskGenerator>(name, dirPath, fileName, periodUS, SignalType::Uniform, randomProp, lookahead);
+    } else if (maskType == MaskGenType::Pink) {
+        planner = std::make_unique<MaskGenerator>(name, dirPath, fileName, periodUS, SignalType::Pink, randomProp, lookahead);
+    } else if (maskType == MaskGenType::BandNoise) {
+        planner = std::make_unique<MaskGenerator>(name, dirPath, fileName, periodUS, SignalType::BandNoise, randomProp, lookahead);
+    } else if (maskType == MaskGenType::MultiTone) {
+        planner = std::make_unique<MaskGenerator>(name, dirPath, fileName, periodUS, SignalType::MultiTone, randomProp, lookahead);
+    } else if (maskType == MaskGenType::Markov) {
+        planner = std::make_unique<MaskGenerator>(name, dirPath, fileName, periodUS, SignalType::Markov, randomProp, lookahead);
     } else if (maskType == MaskGenType::Preset) {
-        planner = std::make_unique<Planner>(name, dirPath, fileName, smplInt, true);
+        planner = std::make_unique<Planner>(name, dirPath, fileName, periodUS, true);
     }
 
     //Find the corresponding controller
@@ -227,241 +475,652 @@ void Manager::addMaskGenerator(std::string name, std::string controllerName, Mas
     plannerList.push_back(std::move(planner));
 }
 
-NameType Manager::getInputNameType(std::string name) {
-    for (auto& ip : inputList) {
-        if (name.compare(ip->getName()) == 0) {
-            return NameType::Port;
+void Manager::registerNames(NameRegistry& registry, std::vector<NameEntry>& entries,
+        std::string portName, const std::vector<std::string>& pinNames, uint32_t listIndex) {
+    auto addName = [&](const std::string & name) -> NameEntry& {
+        auto handle = registry.intern(name);
+        if (handle == entries.size()) {
+            entries.push_back(NameEntry());
+            entries[handle].listIndex = listIndex;
         }
+        return entries[handle];
+    };
+    addName(portName).isPort = true;
+    for (auto& pinName : pinNames) {
+        addName(pinName).isPin = true;
     }
-    for (auto& ip : inputList) {
-        auto pinNames = ip->out->getPinNames();
-        for (auto& pinName : pinNames) {
-            if (name.compare(pinName) == 0) {
-                return NameType::Pin;
-            }
-        }
+}
+
+const Manager::NameEntry* Manager::findName(const NameRegistry& registry,
+        const std::vector<NameEntry>& entries, const std::string& name) {
+    auto handle = registry.find(name);
+    if (handle == NameRegistry::invalidHandle) {
+        return nullptr;
     }
-    return NameType::Invalid;
+    return &entries[handle];
 }
 
-NameType Manager::getSensorNameType(std::string name) {
-    for (auto& op : sensorList) {
-        if (name.compare(op->getName()) == 0) {
-            return NameType::Port;
-        }
+NameType Manager::getInputNameType(std::string name) {
+    auto entry = findName(inputNames, inputNameEntries, name);
+    if (entry == nullptr) {
+        return NameType::Invalid;
     }
-    for (auto& op : sensorList) {
-        auto pinNames = op->out->getPinNames();
-        for (auto& pinName : pinNames) {
-            if (name.compare(pinName) == 0) {
-                return NameType::Pin;
-            }
-        }
+    return entry->isPort ? NameType::Port : NameType::Pin;
+}
+
+NameType Manager::getSensorNameType(std::string name) {
+    auto entry = findName(sensorNames, sensorNameEntries, name);
+    if (entry == nullptr) {
+        return NameType::Invalid;
     }
-    return NameType::Invalid;
+    return entry->isPort ? NameType::Port : NameType::Pin;
 }
 
 bool Manager::isNameInputPin(std::string name) {
-    for (auto& ip : inputList) {
-        auto ipPinNames = ip->out->getPinNames();
-        for (auto& ipPinName : ipPinNames) {
-            if (name.compare(ipPinName) == 0) {
-                return true;
-            }
-        }
-    }
-    return false;
+    auto entry = findName(inputNames, inputNameEntries, name);
+    return entry != nullptr && entry->isPin;
 }
 
 bool Manager::isNameSensorPin(std::string name) {
-    for (auto& op : sensorList) {
-        auto opPinNames = op->out->getPinNames();
-        for (auto& opPinName : opPinNames) {
-            if (name.compare(opPinName) == 0) {
-                return true;
-            }
-        }
-    }
-    return false;
+    auto entry = findName(sensorNames, sensorNameEntries, name);
+    return entry != nullptr && entry->isPin;
 }
 
 bool Manager::isNameInputPort(std::string name) {
-    for (auto& ip : inputList) {
-        if (name.compare(ip->getName()) == 0) {
-            return true;
-        }
-    }
-    return false;
+    auto entry = findName(inputNames, inputNameEntries, name);
+    return entry != nullptr && entry->isPort;
 }
 
 bool Manager::isNameSensorPort(std::string name) {
-    for (auto& op : sensorList) {
-        if (name.compare(op->getName()) == 0) {
-            return true;
-        }
-    }
-    return false;
+    auto entry = findName(sensorNames, sensorNameEntries, name);
+    return entry != nullptr && entry->isPort;
 }
 
 uint32_t Manager::getInputIndexInList(std::string name) {
-    uint32_t i = 0;
-    for (auto& ip : inputList) {
-        if (name.compare(ip->getName()) == 0) {
-#ifdef DEBUG
-            std::cout << "Found input port for name " << name << std::endl;
-#endif
-            return i;
-        } else {
-            auto ipPinNames = ip->out->getPinNames();
-            for (auto& ipPinName : ipPinNames) {
-                if (name.compare(ipPinName) == 0) {
+    auto entry = findName(inputNames, inputNameEntries, name);
+    if (entry == nullptr) {
+        std::cout << "Cannot find non-existing input name " << name << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
 #ifdef DEBUG
-                    std::cout << "Found pin for name " << name << std::endl;
+    std::cout << "Found input " << (entry->isPort ? "port" : "pin") << " for name " << name << std::endl;
 #endif
-                    return i;
-                }
-            }
-        }
-        i++;
-    }
-    std::cout << "Cannot find non-existing input name " << name << std::endl;
-    std::exit(EXIT_FAILURE);
+    return entry->listIndex;
 }
 
 uint32_t Manager::getSensorIndexInList(std::string name) {
-    uint32_t i = 0;
-    for (auto& op : sensorList) {
-        if (name.compare(op->getName()) == 0) {
-#ifdef DEBUG
-            std::cout << "Found sensor port for name " << name << std::endl;
-#endif
-            return i;
-        } else {
-            auto opPinNames = op->out->getPinNames();
-            for (auto& opPinName : opPinNames) {
-                if (name.compare(opPinName) == 0) {
+    auto entry = findName(sensorNames, sensorNameEntries, name);
+    if (entry == nullptr) {
+        std::cout << "Cannot find non-existing sensor name " << name << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
 #ifdef DEBUG
-                    std::cout << "Found pin for name " << name << std::endl;
+    std::cout << "Found sensor " << (entry->isPort ? "port" : "pin") << " for name " << name << std::endl;
 #endif
-                    return i;
-                }
-            }
-        }
-        i++;
-    }
-    std::cout << "Cannot find non-existing sensor name " << name << std::endl;
-    std::exit(EXIT_FAILURE);
+    return entry->listIndex;
 }
 
 void Manager::updateValuesFromSystem() {
     Vector values;
-    for (auto& sensor : sensorList) {
+    for (auto i : sensorOrder) {
+        if (!scheduler.isDue(sensorTasks[i]) || (parallelPackageIO && sensorList[i]->getPackage() >= 0)) {
+            continue;
+        }
+        auto& sensor = sensorList[i];
         sensor->updateValuesFromSystem();
         values = sensor->out->transmitValues();
 #ifdef DEBUG
         std::cout << sensor->getName() << " " << values;
 #endif
     }
-    for (auto& input : inputList) {
+    for (auto i : inputOrder) {
+        if (!scheduler.isDue(inputTasks[i]) || (parallelPackageIO && inputList[i]->getPackage() >= 0)) {
+            continue;
+        }
+        auto& input = inputList[i];
         input->updateValuesFromSystem();
         values = input->out->transmitValues();
 #ifdef DEBUG
         std::cout << input->getName() << " " << values;
 #endif
     }
+    if (parallelPackageIO) {
+        workerPool->runAll(packageReadTasks, packageWorkers);
+    }
 }
 
 void Manager::updateValuesToSystem() {
-    for (auto& input : inputList) {
-        input->updateValueToSystem();
+    for (auto i : inputOrder) {
+        if (!scheduler.isDue(inputTasks[i])) {
+            continue;
+        }
+        auto package = inputList[i]->getPackage();
+        if (parallelPackageIO && package >= 0) {
+            //the port side stays on this thread, the workers only write to the system
+            if (inputList[i]->hasPendingValue()) {
+                auto& batch = packageBatches[package];
+                batch.inputIndices.push_back(i);
+                batch.values.push_back(0.0);
+                inputList[i]->takePendingValue(&batch.values.back());
+            }
+            continue;
+        }
+        inputList[i]->updateValueToSystem();
+    }
+    if (parallelPackageIO) {
+        workerPool->runAll(packageWriteTasks, packageWorkers);
+    }
+}
+
+void Manager::buildPackageIO() {
+    for (uint32_t p = 0; p < numPackages; p++) {
+        packageReadTasks.push_back([this, p] {
+            readPackage(p);
+        });
+        packageWriteTasks.push_back([this, p] {
+            writePackage(p);
+        });
+        packageWorkers.push_back(getPackageWorker(p, 0));
+    }
+    packageBatches.resize(numPackages);
+    for (auto& batch : packageBatches) {
+        batch.inputIndices.reserve(inputList.size());
+        batch.values.reserve(inputList.size());
+    }
+    parallelPackageIO = true;
+}
+
+void Manager::readPackage(uint32_t package) {
+    for (auto i : sensorOrder) {
+        if (sensorList[i]->getPackage() == (int) package && scheduler.isDue(sensorTasks[i])) {
+            sensorList[i]->updateValuesFromSystem();
+        }
+    }
+    for (auto i : inputOrder) {
+        if (inputList[i]->getPackage() == (int) package && scheduler.isDue(inputTasks[i])) {
+            inputList[i]->updateValuesFromSystem();
+        }
+    }
+}
+
+void Manager::writePackage(uint32_t package) {
+    auto& batch = packageBatches[package];
+    for (uint32_t i = 0; i < batch.inputIndices.size(); i++) {
+        inputList[batch.inputIndices[i]]->applyValueToSystem(&batch.values[i]);
+    }
+    batch.inputIndices.clear();
+    batch.values.clear();
+}
+
+//The workers of package p are p, p + numPackages, ...; the tasks of a package take them in turn
+uint32_t Manager::getPackageWorker(int package, uint32_t taskNum) {
+    if (numPackages < 2 || package < 0 || (uint32_t) package >= numWorkers) {
+        return WorkerPool::anyWorker;
+    }
+    uint32_t numPackageWorkers = (numWorkers - package + numPackages - 1) / numPackages;
+    return package + numPackages * (taskNum % numPackageWorkers);
+}
+
+void Manager::queueValuesToSystem() {
+    //the batch is filled in its slot of the queue, and claimed only if some input has a value
+    ActuationBatch* batch = nullptr;
+    for (auto i : inputOrder) {
+        if (!scheduler.isDue(inputTasks[i]) || !inputList[i]->hasPendingValue()) {
+            continue;
+        }
+        if (batch == nullptr) {
+            batch = claimActuationBatch();
+        }
+        batch->inputIndices.push_back(i);
+        batch->values.push_back(0.0);
+        inputList[i]->takePendingValue(&batch->values.back());
+    }
+    if (batch == nullptr) {
+        return;
+    }
+    actuationQueue->commit();
+    actuatorWakeup.notify_one();
+}
+
+Manager::ActuationBatch* Manager::claimActuationBatch() {
+    auto batch = actuationQueue->claim();
+    if (batch == nullptr) {
+        //the actuator is still busy with older periods; wait for a slot instead of dropping values
+        std::unique_lock<std::mutex> lock(actuatorLock);
+        actuationSpace.wait(lock, [this, &batch] {
+            batch = actuationQueue->claim();
+            return batch != nullptr;
+        });
+    }
+    batch->inputIndices.clear();
+    batch->values.clear();
+    return batch;
+}
+
+void Manager::runActuator() {
+    while (true) {
+        auto batch = actuationQueue->front();
+        if (batch != nullptr) {
+            for (uint32_t i = 0; i < batch->inputIndices.size(); i++) {
+                inputList[batch->inputIndices[i]]->applyValueToSystem(&batch->values[i]);
+            }
+            actuationQueue->release();
+            {
+                //so that the control loop can't miss the wakeup between its check and its wait
+                std::lock_guard<std::mutex> lock(actuatorLock);
+            }
+            actuationSpace.notify_one();
+            continue;
+        }
+        if (stopActuating.load()) {
+            break;
+        }
+        std::unique_lock<std::mutex> lock(actuatorLock);
+        actuatorWakeup.wait_for(lock, std::chrono::milliseconds(samplingIntervalMS), [this] {
+            return !actuationQueue->empty() || stopActuating.load();
+        });
+    }
+}
+
+void Manager::startActuator() {
+    actuationQueue = std::make_unique<RingBuffer < ActuationBatch >> (actuationQueueDepth);
+    actuationQueue->initSlots([this](ActuationBatch & batch) {
+        batch.inputIndices.reserve(inputList.size());
+        batch.values.reserve(inputList.size());
+    });
+    stopActuating.store(false);
+    actuator = std::thread(&Manager::runActuator, this);
+}
+
+void Manager::stopActuator() {
+    {
+        std::lock_guard<std::mutex> lock(actuatorLock);
+        stopActuating.store(true);
+    }
+    actuatorWakeup.notify_one();
+    if (actuator.joinable()) {
+        actuator.join();
     }
 }
 
 void Manager::run() {
+    if (usesVirtualClock && execMode == ExecMode::Pipelined) {
+        //the actuator thread would make the simulated inputs change at arbitrary ticks
+        std::cerr << "Pipelined execution is not supported with virtual time, using Serial" << std::endl;
+        execMode = ExecMode::Serial;
+    }
     completeInit();
-    //run once to initialize readings
+    //run once to initialize readings (every task is due until the first tick)
+    scheduler.start();
     updateValuesFromSystem();
     updateValuesToSystem();
-    std::this_thread::sleep_for(std::chrono::milliseconds(samplingIntervalMS));
+    if (execMode == ExecMode::Pipelined) {
+        startActuator();
+    }
     //continue loop
     while (!stopRunning.load()) {
+        scheduler.waitForNextTick();
+        if (runDurationUS > 0 && scheduler.getElapsedUS() > runDurationUS) {
+            break;
+        }
+        if (stopCondition && stopCondition()) {
+            break;
+        }
+        if (calibrator && calibrator->isDone()) {
+            break;
+        }
 #ifdef DEBUG
         std::cout << "-------------------------------------------Round--------------------------------------" << std::endl;
 #endif
         updateValuesFromSystem();
-        displayValues();
+        if (scheduler.isDue(displayTask)) {
+            displayValues();
+        }
         transferSysReadings();
         switch (mode) {
             case Mode::Sysid:
-                runSysid();
+                if (scheduler.isDue(sysidTask)) {
+                    if (systemId) {
+                        systemId->update(); //before the inputs change
+                    }
+                    runSysid();
+                }
+                break;
+            case Mode::Calibrate:
+                if (scheduler.isDue(sysidTask)) {
+                    runCalibration();
+                }
                 break;
             case Mode::Mask:
-                transferBlockWires();
-                runControl();
+                runEstimators();
+                //block wires are transferred only in ticks where some planner or controller runs, 
+                //so that wire delays are counted in control invocations
+                if (scheduler.isAnyDue(controlTasks)) {
+                    transferBlockWires();
+                    runControl();
+                }
                 break;
         }
         transferSysWrites();
-        updateValuesToSystem();
+        if (execMode == ExecMode::Pipelined) {
+            queueValuesToSystem();
+        } else {
+            updateValuesToSystem();
+        }
 #ifdef DEBUG
         std::cout << "--------------------------------------------------------------------------------------" << std::endl;
 #endif
-        std::this_thread::sleep_for(std::chrono::milliseconds(samplingIntervalMS));
+    }
+    if (execMode == ExecMode::Pipelined) {
+        stopActuator(); //drains what is still queued
     }
     resetInputs();
+    if (systemId) {
+        systemId->report(std::cerr);
+        if (!systemIdModelPrefix.empty()) {
+            systemId->writeModel(systemIdModelPrefix);
+        }
+    }
+    if (calibrator) {
+        calibrator->report(std::cerr);
+        if (calibrator->isDone()) {
+            calibrator->writeScales(calibrationFileNamePrefix);
+        }
+    }
 #ifdef DEBUG
-    std::cout << "Ending" << std::endl;
+    std::cout << "Ending after " << scheduler.getNumOverruns() << " overruns" << std::endl;
 #endif
 }
 
 void Manager::transferBlockWires() {
-    for (auto& wire : blockWires) {
-        wire->transfer();
-    }
+    wiringPlan.transfer(blockRoute);
 }
 
 void Manager::transferSysReadings() {
-    for (auto& wire : sysReadWires) {
-        wire->transfer();
-    }
+    wiringPlan.transfer(sysReadRoute);
 }
 
 void Manager::transferSysWrites() {
-    for (auto& wire : sysWriteWires) {
-        wire->transfer();
+    wiringPlan.transfer(sysWriteRoute);
+}
+
+void Manager::runEstimators() {
+    if (estimatorList.empty()) {
+        return;
     }
+    for (uint32_t i = 0; i < estimatorList.size(); i++) {
+        if (scheduler.isDue(estimatorTasks[i])) {
+            estimatorList[i]->run();
+        }
+    }
+    wiringPlan.transfer(estimateRoute);
+}
+
+void Manager::compileWiringPlan() {
+    std::vector<std::shared_ptr<Port>> ports;
+    for (auto& sensor : sensorList) {
+        ports.push_back(sensor->out);
+    }
+    for (auto& input : inputList) {
+        ports.push_back(input->out);
+        ports.push_back(input->in);
+    }
+    for (auto& planner : plannerList) {
+        ports.push_back(planner->newOutputTargetVals);
+        ports.push_back(planner->currInputVals);
+        ports.push_back(planner->currOutputVals);
+    }
+    for (auto& estimator : estimatorList) {
+        ports.push_back(estimator->measuredVals);
+        ports.push_back(estimator->inputVals);
+        ports.push_back(estimator->estimatedVals);
+    }
+    for (auto& controller : controllerList) {
+        ports.push_back(controller->newInputVals);
+        ports.push_back(controller->currOutputTargetVals);
+        ports.push_back(controller->currInputVals);
+        ports.push_back(controller->outputVals);
+        ports.push_back(controller->outputTargetVals);
+    }
+    ports.insert(ports.end(), schedulePorts.begin(), schedulePorts.end());
+    if (systemId) {
+        ports.push_back(systemId->outputVals);
+        ports.push_back(systemId->inputVals);
+    }
+    if (calibrator) {
+        ports.push_back(calibrator->outputVals);
+    }
+    wiringPlan.compile(ports);
+    sysReadRoute = wiringPlan.addRoute(sysReadWires);
+    blockRoute = wiringPlan.addRoute(blockWires);
+    estimateRoute = wiringPlan.addRoute(estimateWires);
+    sysWriteRoute = wiringPlan.addRoute(sysWriteWires);
 }
 
 void Manager::runControl() {
+    if (workerPool) {
+        for (uint32_t i = 0; i < controlLevels.size(); i++) {
+            workerPool->runAll(controlLevels[i], controlLevelWorkers[i]);
+        }
+        return;
+    }
 #ifdef DEBUG
     std::cout << "Running planners" << std::endl;
 #endif
-    for (auto& planner : plannerList) {
+    for (uint32_t i = 0; i < plannerList.size(); i++) {
+        if (!scheduler.isDue(plannerTasks[i])) {
+            continue;
+        }
 #ifdef DEBUG
-        std::cout << "Running planner " << planner->getName() << std::endl;
+        std::cout << "Running planner " << plannerList[i]->getName() << std::endl;
 #endif
-        planner->run();
+        plannerList[i]->run();
     }
 
 
 #ifdef DEBUG
     std::cout << "Running controllers" << std::endl;
 #endif
-    for (auto& controller : controllerList) {
+    for (uint32_t i = 0; i < controllerList.size(); i++) {
+        if (!scheduler.isDue(controllerTasks[i])) {
+            continue;
+        }
+#ifdef DEBUG
+        std::cout << "Running controller " << controllerList[i]->getName() << std::endl;
+#endif
+        controllerList[i]->run();
+    }
+}
+
+void Manager::buildControlSchedule() {
+    /* Nodes are the planners followed by the controllers. A block wire from a port 
+     * of node u to a port of node v makes v depend on u. Sys read and write wires 
+     * only connect sensors and inputs, which aren't run here, so they add no edges.
+     * Each node only touches its own ports, so nodes of the same level can run 
+     * concurrently and the result is the same as running them one after the other.
+     * A node that isn't due in a tick does nothing.
+     */
+    std::map<Port*, uint32_t> portOwner;
+    std::vector<std::function<void()>> nodes;
+    for (uint32_t i = 0; i < plannerList.size(); i++) {
+        auto& planner = plannerList[i];
+        portOwner[planner->newOutputTargetVals.get()] = nodes.size();
+        portOwner[planner->currInputVals.get()] = nodes.size();
+        portOwner[planner->currOutputVals.get()] = nodes.size();
+        auto plannerPtr = planner.get();
+        auto task = plannerTasks[i];
+        nodes.push_back([this, plannerPtr, task] {
+            if (scheduler.isDue(task)) {
+                plannerPtr->run();
+            }
+        });
+    }
+    for (uint32_t i = 0; i < controllerList.size(); i++) {
+        auto& controller = controllerList[i];
+        portOwner[controller->newInputVals.get()] = nodes.size();
+        portOwner[controller->currOutputTargetVals.get()] = nodes.size();
+        portOwner[controller->currInputVals.get()] = nodes.size();
+        portOwner[controller->outputVals.get()] = nodes.size();
+        portOwner[controller->outputTargetVals.get()] = nodes.size();
+        auto controllerPtr = controller.get();
+        auto task = controllerTasks[i];
+        nodes.push_back([this, controllerPtr, task] {
+            if (scheduler.isDue(task)) {
+                controllerPtr->run();
+            }
+        });
+    }
+
+    /* The package of a node is the one of the sensors and inputs it is wired to, and 
+     * planners get the package of their controller. A node wired to several packages 
+     * (or to none) can run on any worker.
+     */
+    const int unknownPackage = -2;
+    std::map<Port*, int> portPackage;
+    for (auto& sensor : sensorList) {
+        portPackage[sensor->out.get()] = sensor->getPackage();
+    }
+    for (auto& input : inputList) {
+        portPackage[input->out.get()] = input->getPackage();
+        portPackage[input->in.get()] = input->getPackage();
+    }
+    std::vector<int> nodePackages(nodes.size(), unknownPackage);
+    for (auto wires : {&sysReadWires, &sysWriteWires}) {
+        for (auto& wire : *wires) {
+            Port* ports[] = {wire->getSrcPort().get(), wire->getDestPort().get()};
+            auto owner = portOwner.find(ports[0]);
+            auto package = portPackage.find(ports[1]);
+            if (owner == portOwner.end()) {
+                owner = portOwner.find(ports[1]);
+                package = portPackage.find(ports[0]);
+            }
+            if (owner == portOwner.end() || package == portPackage.end() || package->second < 0) {
+                continue;
+            }
+            auto& nodePackage = nodePackages[owner->second];
+            if (nodePackage != package->second) {
+                nodePackage = (nodePackage == unknownPackage) ? package->second : -1;
+            }
+        }
+    }
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (auto& wire : blockWires) {
+            auto src = portOwner.find(wire->getSrcPort().get());
+            auto dest = portOwner.find(wire->getDestPort().get());
+            if (src == portOwner.end() || dest == portOwner.end()) {
+                continue;
+            }
+            for (auto pair : {std::make_pair(src->second, dest->second), std::make_pair(dest->second, src->second)}) {
+                if (nodePackages[pair.first] == unknownPackage && nodePackages[pair.second] != unknownPackage) {
+                    nodePackages[pair.first] = nodePackages[pair.second];
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> successors(nodes.size());
+    std::vector<uint32_t> numPredecessors(nodes.size(), 0);
+    for (auto& wire : blockWires) {
+        auto src = portOwner.find(wire->getSrcPort().get());
+        auto dest = portOwner.find(wire->getDestPort().get());
+        if (src == portOwner.end() || dest == portOwner.end() || src->second == dest->second) {
+            continue;
+        }
+        successors[src->second].push_back(dest->second);
+        numPredecessors[dest->second]++;
+    }
+
+    //Kahn's algorithm, one level at a time
+    controlLevels.clear();
+    controlLevelWorkers.clear();
+    std::vector<uint32_t> currLevel, nextLevel;
+    for (uint32_t node = 0; node < nodes.size(); node++) {
+        if (numPredecessors[node] == 0) {
+            currLevel.push_back(node);
+        }
+    }
+    uint32_t numScheduled = 0;
+    while (!currLevel.empty()) {
+        std::vector<std::function<void()>> levelTasks;
+        std::vector<uint32_t> levelWorkers;
+        std::map<int, uint32_t> numTasksOfPackage;
+        nextLevel.clear();
+        for (auto node : currLevel) {
+            levelTasks.push_back(nodes[node]);
+            levelWorkers.push_back(getPackageWorker(nodePackages[node], numTasksOfPackage[nodePackages[node]]++));
+            for (auto succ : successors[node]) {
+                if (--numPredecessors[succ] == 0) {
+                    nextLevel.push_back(succ);
+                }
+            }
+        }
+        numScheduled += currLevel.size();
+        controlLevels.push_back(std::move(levelTasks));
+        controlLevelWorkers.push_back(std::move(levelWorkers));
+        currLevel = nextLevel;
+    }
+    if (numScheduled != nodes.size()) {
+        std::cout << "Planners and controllers are wired in a loop" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
 #ifdef DEBUG
-        std::cout << "Running controller " << controller->getName() << std::endl;
+    std::cout << "Scheduled " << nodes.size() << " planners and controllers in " <<
+            controlLevels.size() << " levels" << std::endl;
+    for (uint32_t node = 0; node < nodes.size(); node++) {
+        std::cout << "Planner or controller " << node << " is in package " << nodePackages[node] << std::endl;
+    }
 #endif
-        controller->run();
+}
+
+void Manager::buildRateSchedule() {
+    uint32_t samplingIntervalUS = samplingIntervalMS * 1000;
+    auto resolvePeriod = [samplingIntervalUS](uint32_t periodUS) {
+        return (periodUS == 0) ? samplingIntervalUS : periodUS;
+    };
+    for (auto& sensor : sensorList) {
+        sensorTasks.push_back(scheduler.addTask(resolvePeriod(sensor->getPeriodUS())));
+    }
+    for (auto& input : inputList) {
+        inputTasks.push_back(scheduler.addTask(resolvePeriod(input->getPeriodUS())));
+    }
+    for (auto& planner : plannerList) {
+        plannerTasks.push_back(scheduler.addTask(planner->getPeriodUS()));
     }
+    for (auto& controller : controllerList) {
+        controllerTasks.push_back(scheduler.addTask(controller->getPeriodUS()));
+    }
+    for (auto& estimator : estimatorList) {
+        estimatorTasks.push_back(scheduler.addTask(estimator->getPeriodUS()));
+    }
+    controlTasks = plannerTasks;
+    controlTasks.insert(controlTasks.end(), controllerTasks.begin(), controllerTasks.end());
+    displayTask = scheduler.addTask(samplingIntervalUS);
+    sysidTask = scheduler.addTask(samplingIntervalUS);
+
+    sensorOrder = scheduler.getRateMonotonicOrder(sensorTasks);
+    inputOrder = scheduler.getRateMonotonicOrder(inputTasks);
 }
 
 void Manager::runSysid() {
+    if (!excitations.empty()) {
+        for (uint32_t i = 0; i < excitations.size(); i++) {
+            auto value = excitations[i]->next();
+            if (value != excitationValues[i]) {
+                inputList[inputIndicesForSysid[i]]->setNormalizedValue(value);
+                excitationValues[i] = value;
+            }
+        }
+        return;
+    }
     auto i = 0;
     for (auto& holdCounter : holdCounters) {
         holdCounter++;
         if (holdCounter == holdPeriods[i]) {
-            inputList[inputIndicesForSysid[i]]->setRandomValue();
+            inputList[inputIndicesForSysid[i]]->setRandomValue(sysidRandom);
             holdCounter = 0;
-            holdPeriods[i] = minHoldPeriods[i] + rand() % (maxHoldPeriods[i] - minHoldPeriods[i] + 1);
+            holdPeriods[i] = sysidRandom.uniformInt(minHoldPeriods[i], maxHoldPeriods[i]);
 #ifdef DEBUG
             std::cout << "New hold period for input " << inputList[inputIndicesForSysid[i]]->getName()
                     << " is " << holdPeriods[i] << std::endl;
@@ -471,6 +1130,23 @@ void Manager::runSysid() {
     }
 }
 
+void Manager::runCalibration() {
+    if (calibrator->update()) {
+        applyCalibrationSetting();
+    }
+}
+
+void Manager::applyCalibrationSetting() {
+    auto& setting = calibrator->getSetting();
+    for (uint32_t i = 0; i < calibrationInputIndices.size(); i++) {
+        if (setting[i]) {
+            inputList[calibrationInputIndices[i]]->setMaxValue();
+        } else {
+            inputList[calibrationInputIndices[i]]->setMinValue();
+        }
+    }
+}
+
 void Manager::resetInputs() {
     for (auto& input : inputList) {
         input->reset();
@@ -494,11 +1170,16 @@ void Manager::displayHeader() {
 
     if (mode == Mode::Mask) {
         for (auto& ctl : controllerList) {
-            auto targetNames = ctl->currOutputTargetVals->getPinNames();
+            const auto& targetNames = ctl->currOutputTargetVals->getPinNames();
             for (auto& tName : targetNames) {
                 std::cout << "Target@" << tName << " ";
             }
         }
+        for (auto& est : estimatorList) {
+            for (auto& eName : est->getOutputNames()) {
+                std::cout << "Estimate@" << eName << " ";
+            }
+        }
     }
     std::cout << std::endl;
 }
@@ -525,11 +1206,19 @@ void Manager::displayValues() {
                 std::cout << std::setprecision(2) << std::fixed << tValue << " ";
             }
         }
+        for (auto& est : estimatorList) {
+            auto estimates = est->estimatedVals->transmitValues();
+            for (auto& eValue : estimates) {
+                std::cout << std::setprecision(3) << std::fixed << eValue << " ";
+            }
+        }
     }
     std::cout << std::endl;
 }
 
 void Manager::completeInit() {
+    compileWiringPlan();
+    buildRateSchedule();
     if (mode == Mode::Sysid) {
         for (auto& name : sysidInputNameList) {
             inputIndicesForSysid.push_back(getInputIndexInList(name));
@@ -545,6 +1234,13 @@ void Manager::completeInit() {
             input->setMidValue();
         }
     }
+    if (mode == Mode::Calibrate) {
+        if (!calibrator) {
+            std::cout << "Calibrate mode needs a calibrator" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        applyCalibrationSetting();
+    }
     //Initialize numcores and cpu frequency to maximum
     /*
     for (auto& input : inputList) {
@@ -556,6 +1252,26 @@ void Manager::completeInit() {
         }
     }
     */
+    if (mode == Mode::Mask && numWorkers > 0) {
+        for (auto& sensor : sensorList) {
+            numPackages = std::max(numPackages, (uint32_t) (sensor->getPackage() + 1));
+        }
+        for (auto& input : inputList) {
+            numPackages = std::max(numPackages, (uint32_t) (input->getPackage() + 1));
+        }
+        buildControlSchedule();
+        //pin the workers only if the system has the packages that the blocks are for
+        std::vector<std::vector<uint32_t>> workerCPUs;
+        auto packageCPUs = (numPackages > 1) ? getPackageCPUs() : std::vector<std::vector<uint32_t>>();
+        for (uint32_t w = 0; packageCPUs.size() == numPackages && numPackages > 1 && w < numWorkers; w++) {
+            workerCPUs.push_back(packageCPUs[w % numPackages]);
+        }
+        workerPool = std::make_unique<WorkerPool>(numWorkers, workerCPUs);
+        //the simulated plant and the replayed trace are shared by all packages
+        if (numPackages > 1 && !usesVirtualClock) {
+            buildPackageIO();
+        }
+    }
     displayHeader();
 }
 
@@ -0,0 +1,158 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   MarkovChain.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "MarkovChain.h"
+#include "debug.h"
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <cstdlib>
+
+//steps of the chain averaged to find where it starts
+const uint32_t stationarySteps = 200;
+
+MarkovChain::MarkovChain(std::string fileNamePrefix, uint32_t numOutputs, RandomStream random) :
+numOutputs(numOutputs),
+state(0),
+random(random) {
+    means.from_file(fileNamePrefix + "_markovStates.txt");
+    if (numOutputs == 0 || means.size() == 0 || means.size() % numOutputs != 0) {
+        std::cout << fileNamePrefix << "_markovStates.txt must have rows of " << numOutputs << " values" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    numStates = means.size() / numOutputs;
+
+    stddevs = Vector(means.size());
+    if (std::ifstream(fileNamePrefix + "_markovStddev.txt")) {
+        stddevs.from_file(fileNamePrefix + "_markovStddev.txt");
+        if (stddevs.size() != means.size()) {
+            std::cout << fileNamePrefix << "_markovStddev.txt must have " << means.size() << " values" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    Vector transitions(fileNamePrefix + "_markovTransitions.txt");
+    if (transitions.size() != (std::size_t) numStates * numStates) {
+        std::cout << fileNamePrefix << "_markovTransitions.txt must be " << numStates << "x" << numStates << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    aliasProb.resize((std::size_t) (numStates + 1) * numStates);
+    aliasIndex.resize(aliasProb.size());
+    for (uint32_t i = 0; i < numStates; i++) {
+        buildAliasTable(&transitions[(std::size_t) i * numStates], (std::size_t) i * numStates);
+    }
+
+    //start from the stationary distribution, averaged over many steps in case the chain is periodic
+    std::vector<double> dist(numStates, 1.0 / numStates), nextDist(numStates), stationary(numStates, 0.0);
+    for (uint32_t step = 0; step < stationarySteps; step++) {
+        std::fill(nextDist.begin(), nextDist.end(), 0.0);
+        for (uint32_t i = 0; i < numStates; i++) {
+            for (uint32_t j = 0; j < numStates; j++) {
+                nextDist[j] += dist[i] * transitions[(std::size_t) i * numStates + j];
+            }
+        }
+        double total = 0.0;
+        for (auto p : nextDist) {
+            total += p;
+        }
+        for (uint32_t j = 0; j < numStates; j++) {
+            dist[j] = nextDist[j] / total;
+            stationary[j] += dist[j];
+        }
+    }
+    buildAliasTable(stationary.data(), (std::size_t) numStates * numStates);
+    state = sample((std::size_t) numStates * numStates);
+
+#ifdef DEBUG
+    std::cout << "Markov chain with " << numStates << " states starts in state " << state << std::endl;
+#endif
+}
+
+void MarkovChain::buildAliasTable(const double* probs, std::size_t first) {
+    double total = 0.0;
+    for (uint32_t j = 0; j < numStates; j++) {
+        if (probs[j] < 0.0 || std::isnan(probs[j])) {
+            std::cout << "Markov chain probabilities must be >= 0" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        total += probs[j];
+    }
+    if (total <= 0.0) {
+        std::cout << "Every state of a Markov chain must have a next state (a row of transitions is all 0)" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    //Vose: split the states whose scaled probability is below and above 1, and
+    //fill each small one up to 1 with a large one
+    std::vector<double> scaled(numStates);
+    std::vector<uint32_t> small, large;
+    for (uint32_t j = 0; j < numStates; j++) {
+        scaled[j] = probs[j] * numStates / total;
+        if (scaled[j] < 1.0) {
+            small.push_back(j);
+        } else {
+            large.push_back(j);
+        }
+    }
+    while (!small.empty() && !large.empty()) {
+        auto less = small.back(), more = large.back();
+        small.pop_back();
+        aliasProb[first + less] = scaled[less];
+        aliasIndex[first + less] = more;
+        scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+        if (scaled[more] < 1.0) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    //what is left is 1 up to rounding
+    for (auto j : large) {
+        aliasProb[first + j] = 1.0;
+        aliasIndex[first + j] = j;
+    }
+    for (auto j : small) {
+        aliasProb[first + j] = 1.0;
+        aliasIndex[first + j] = j;
+    }
+}
+
+uint32_t MarkovChain::sample(std::size_t first) {
+    auto column = random.uniformInt(0, numStates - 1);
+    return (random.uniform() < aliasProb[first + column]) ? column : aliasIndex[first + column];
+}
+
+void MarkovChain::next(double* values) {
+    state = sample((std::size_t) state * numStates);
+    auto offset = (std::size_t) state * numOutputs;
+    for (uint32_t i = 0; i < numOutputs; i++) {
+        values[i] = means[offset + i];
+        if (stddevs[offset + i] > 0.0) {
+            values[i] += random.normal(0.0, stddevs[offset + i]);
+        }
+    }
+}
+
+uint32_t MarkovChain::getNumStates() {
+    return numStates;
+}
+
+uint32_t MarkovChain::getState() {
+    return state;
+}
@@ -18,6 +18,7 @@
  */
 
 #include "MathSupport.h"
+#include <cmath>
 
 // Operator overloads - declared Non-member Non-friend
 // Vector Operators:
@@ -262,6 +263,87 @@ Vector operator*(const Matrix& m, const Vector& v) {
     return Vector();
 }
 
+// Matrix operators:
+
+Matrix operator*(const Matrix& lhs, const Matrix& rhs) {
+    if (lhs.col() == rhs.row()) {
+        Matrix ret(lhs.row(), rhs.col());
+        for (auto r = 0; r < lhs.row(); r++) {
+            for (auto k = 0; k < lhs.col(); k++) {
+                for (auto c = 0; c < rhs.col(); c++) {
+                    ret[r][c] += lhs[r][k] * rhs[k][c];
+                }
+            }
+        }
+        return ret;
+    }
+    std::cerr << "Mismatched dimensions for matrix-matrix product" << std::endl;
+    return Matrix();
+}
+
+Matrix transpose(const Matrix& m) {
+    Matrix ret(m.col(), m.row());
+    for (auto r = 0; r < m.row(); r++) {
+        for (auto c = 0; c < m.col(); c++) {
+            ret[c][r] = m[r][c];
+        }
+    }
+    return ret;
+}
+
+Matrix inverse(const Matrix& m) {
+    if (m.row() != m.col()) {
+        std::cerr << "Inverse of a non-square matrix" << std::endl;
+        return Matrix();
+    }
+    auto n = m.row();
+    Matrix a(m), ret(n);
+    if (n > 0 && !inverse(ret[0], a[0], n, n)) {
+        return Matrix();
+    }
+    return ret;
+}
+
+//Gauss-Jordan elimination with partial pivoting
+bool inverse(double* out, double* a, std::size_t n, std::size_t stride) {
+    for (std::size_t r = 0; r < n; r++) {
+        for (std::size_t c = 0; c < n; c++) {
+            out[r * stride + c] = (r == c) ? 1.0 : 0.0;
+        }
+    }
+    for (std::size_t c = 0; c < n; c++) {
+        auto pivot = c;
+        for (auto r = c + 1; r < n; r++) {
+            if (std::abs(a[r * stride + c]) > std::abs(a[pivot * stride + c])) {
+                pivot = r;
+            }
+        }
+        if (a[pivot * stride + c] == 0.0) {
+            return false;
+        }
+        if (pivot != c) {
+            std::swap_ranges(a + c * stride, a + c * stride + n, a + pivot * stride);
+            std::swap_ranges(out + c * stride, out + c * stride + n, out + pivot * stride);
+        }
+        auto rowA = a + c * stride, rowOut = out + c * stride;
+        auto scale = 1.0 / rowA[c];
+        for (std::size_t k = 0; k < n; k++) {
+            rowA[k] *= scale;
+            rowOut[k] *= scale;
+        }
+        for (std::size_t r = 0; r < n; r++) {
+            auto factor = a[r * stride + c];
+            if (r != c && factor != 0.0) {
+                for (std::size_t k = 0; k < n; k++) {
+                    a[r * stride + k] -= factor * rowA[k];
+                    out[r * stride + k] -= factor * rowOut[k];
+                }
+            }
+        }
+    }
+    return true;
+}
+
 // IO stream operators
 
 std::ostream& operator<<(std::ostream& os, const Vector& v) {
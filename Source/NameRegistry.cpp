@@ -0,0 +1,57 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/*
+ * File:   NameRegistry.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "NameRegistry.h"
+#include "debug.h"
+
+#include <iostream>
+#include <cstdlib>
+
+const uint32_t NameRegistry::invalidHandle;
+
+uint32_t NameRegistry::intern(const std::string& name) {
+    auto it = handles.find(name);
+    if (it != handles.end()) {
+        return it->second;
+    }
+    uint32_t handle = names.size();
+    handles.emplace(name, handle);
+    names.push_back(name);
+    return handle;
+}
+
+uint32_t NameRegistry::find(const std::string& name) const {
+    auto it = handles.find(name);
+    if (it == handles.end()) {
+        return invalidHandle;
+    }
+    return it->second;
+}
+
+const std::string& NameRegistry::getName(uint32_t handle) const {
+    if (handle >= names.size()) {
+        std::cout << "Invalid name handle " << handle << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return names[handle];
+}
+
+uint32_t NameRegistry::size() const {
+    return names.size();
+}
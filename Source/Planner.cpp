@@ -24,42 +24,111 @@
 #define _USE_MATH_DEFINES
 #include <cmath>
 
-std::random_device randomDevice;
-std::mt19937 randomGen(randomDevice());
-std::uniform_int_distribution<> signalPropHoldDist(12, 125);
+//how many invocations the properties of a mask are held for
+const uint32_t minSignalPropHold = 12, maxSignalPropHold = 125;
+//most rows of targets a mask generator computes at once ahead of the planner
+const uint32_t maskBatchRows = 64;
+
+//Pink noise filter (Paul Kellet's refined method): six first order sections and a 
+//delayed tap on white noise give a 1/f spectrum over about three decades below 
+//the Nyquist frequency. The output of unit variance white noise has a standard 
+//deviation of pinkFilterStddev.
+const double pinkPoles[6] = {0.99886, 0.99332, 0.96900, 0.86650, 0.55000, -0.7616};
+const double pinkGains[6] = {0.0555179, 0.0750759, 0.1538520, 0.3104856, 0.5329522, -0.0168980};
+const double pinkDirectGain = 0.5362, pinkDelayedGain = 0.115926;
+const double pinkFilterStddev = 3.0525;
+
+Oscillator::Oscillator(double phase) :
+phaseCos(cos(phase)),
+phaseSin(sin(phase)),
+stepCos(1.0),
+stepSin(0.0) {
+}
+
+void Oscillator::setFrequency(double freqHz, double sampleFreqHz) {
+    double step = 2.0 * M_PI * freqHz / sampleFreqHz;
+    stepCos = cos(step);
+    stepSin = sin(step);
+}
+
+double Oscillator::next() {
+    double value = phaseSin;
+    double newCos = phaseCos * stepCos - phaseSin * stepSin;
+    double newSin = phaseSin * stepCos + phaseCos * stepSin;
+    //first order correction of the radius, enough because it is applied every sample
+    double scale = 1.5 - 0.5 * (newCos * newCos + newSin * newSin);
+    phaseCos = newCos * scale;
+    phaseSin = newSin * scale;
+    return value;
+}
+
+BandPassFilter::BandPassFilter() :
+b0(0.0),
+a1(0.0),
+a2(0.0),
+gain(1.0),
+z1{0.0, 0.0},
+z2{0.0, 0.0} {
+}
+
+void BandPassFilter::setBand(double centerFreqHz, double bandwidthHz, double sampleFreqHz) {
+    //band-pass biquad with a peak gain of 1 (RBJ audio EQ cookbook), Q = center / bandwidth
+    double w0 = 2.0 * M_PI * centerFreqHz / sampleFreqHz;
+    double alpha = sin(w0) * bandwidthHz / (2.0 * centerFreqHz);
+    double a0 = 1.0 + alpha;
+    b0 = alpha / a0;
+    a1 = -2.0 * cos(w0) / a0;
+    a2 = (1.0 - alpha) / a0;
+
+    //the variance gain for white noise is the energy of the impulse response
+    double energy = 0.0;
+    double s1[2] = {0.0, 0.0}, s2[2] = {0.0, 0.0};
+    for (uint32_t n = 0; n < 65536; n++) {
+        double y = (n == 0) ? 1.0 : 0.0;
+        for (uint32_t k = 0; k < 2; k++) {
+            double x = y;
+            y = b0 * x + s1[k];
+            s1[k] = -a1 * y + s2[k];
+            s2[k] = -b0 * x - a2 * y;
+        }
+        energy += y * y;
+        if (n > 16 && std::fabs(s1[1]) + std::fabs(s2[1]) + std::fabs(s1[0]) + std::fabs(s2[0]) < 1e-12) {
+            break;
+        }
+    }
+    gain = 1.0 / sqrt(energy);
+}
+
+double BandPassFilter::filter(double x) {
+    double y = x;
+    for (uint32_t k = 0; k < 2; k++) {
+        double in = y;
+        y = b0 * in + z1[k];
+        z1[k] = -a1 * y + z2[k];
+        z2[k] = -b0 * in - a2 * y;
+    }
+    return gain * y;
+}
 
-Planner::Planner(std::string name, std::string dirPath, std::string fileName, uint32_t smplInt, bool usePreset) :
+Planner::Planner(std::string name, std::string dirPath, std::string fileName, uint32_t periodUS, bool usePreset) :
 name(name),
 dirPath(dirPath),
 fileName(fileName),
 newOutputTargetVals(std::make_shared<OutputPort>("newOutputTargetVals")),
 currInputVals(std::make_shared<InputPort>("currInputVals")),
 currOutputVals(std::make_shared<InputPort>("currOutputVals")),
-periodInSamples(smplInt),
-cycles(smplInt),
-usePresetTarget(usePreset),
-presetTargetCounter(0) {
+periodUS(periodUS),
+usePresetTarget(usePreset) {
 #ifdef DEBUG
     std::cout << "Creating planner " << name << std::endl;
 #endif
     std::string fileNamePrefix = dirPath + "/" + fileName;
 
-    std::ifstream file;
-    uint64_t presetTargetLen = 0;
-
     maxLimits.from_file(fileNamePrefix + "_maxLimits.txt");
     minLimits.from_file(fileNamePrefix + "_minLimits.txt");
     targets.from_file(fileNamePrefix + "_targets.txt");
     if (usePresetTarget) {
-        file.open(fileNamePrefix + "_presetlen.txt");
-        if (!file) {
-            std::cerr << "Unable to open " << fileNamePrefix << "_presetlen.txt" << std::endl;
-            std::exit(EXIT_FAILURE);
-        }
-        file >> presetTargetLen;
-        file.close();
-        presetTargets = Matrix(presetTargetLen, targets.size());
-        presetTargets.from_file(fileNamePrefix + "_presets.txt");
+        presetTargets = PresetSource::open(fileNamePrefix, targets.size());
     }
 
     //std::cout << minLimits << " " << maxLimits << " " << targets << std::endl;
@@ -70,22 +139,20 @@ std::string Planner::getName() {
     return name;
 }
 
+uint32_t Planner::getPeriodUS() {
+    return periodUS;
+}
+
 void Planner::reset() {
     std::string fileNamePrefix = dirPath + "/" + fileName;
     targets.from_file(fileNamePrefix + "_targets.txt");
-    presetTargetCounter = 0;
+    if (usePresetTarget) {
+        presetTargets->rewind();
+    }
 }
 
 void Planner::run() {
-    bool run = false;
-    if (cycles == periodInSamples) {
-        run = true;
-        cycles = 1;
-    } else {
-        cycles++;
-    }
-
-    auto newValues = computeNewTargets(run);
+    auto newValues = computeNewTargets();
 
 #ifdef DEBUG
     std::vector<std::string> outputNames = newOutputTargetVals->getPinNames();
@@ -98,7 +165,7 @@ void Planner::run() {
     newOutputTargetVals->updateValuesToPort(newValues);
 }
 
-Vector Planner::computeNewTargets(bool run) {
+Vector Planner::computeNewTargets() {
 #ifdef DEBUG
     std::cout << "---------Planner---------" << std::endl;
 #endif
@@ -107,14 +174,11 @@ Vector Planner::computeNewTargets(bool run) {
     auto currIpVals = currInputVals->updateValuesFromPort();
 
     if (usePresetTarget) {
-        targets = Vector(presetTargets[presetTargetCounter], targets.size());
+        auto row = presetTargets->nextRow();
+        std::copy(row, row + targets.size(), targets.begin());
 #ifdef DEBUG
-        std::cout << targets << " " << presetTargetCounter << std::endl;
+        std::cout << targets << std::endl;
 #endif
-        presetTargetCounter++;
-        if (presetTargetCounter == presetTargets.row()) {
-            presetTargetCounter = 0;
-        }
     }
 
 #ifdef DEBUG
@@ -124,7 +188,8 @@ Vector Planner::computeNewTargets(bool run) {
     return targets;
 }
 
-SignalGenerator::SignalGenerator(SignalType sig, double minval, double maxval, double p1, double p2, double p3, double p4) :
+SignalGenerator::SignalGenerator(SignalType sig, double minval, double maxval, double p1, double p2, double p3, double p4,
+        double sampleFreqHz) :
 sigType(sig),
 minVal(minval),
 maxVal(maxval),
@@ -132,53 +197,95 @@ param1(p1),
 param2(p2),
 param3(p3),
 param4(p4),
-time(0.0),
+sineSamplingFreq(sampleFreqHz),
 minSineCycles(4.0),
+pinkState{0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+random(newRandomStream()),
 randomizeParam1(false),
 randomizeParam2(false),
 randomizeParam3(false),
-randomizeParam4(false) {
+randomizeParam4(false),
+param1Range(0.0, 1.0),
+param2Range(0.0, 1.0),
+param3Range(0.0, 1.0),
+param4Range(0.0, 1.0) {
     if (minVal > maxVal) {
         std::cout << "Min " << minVal << " should be smaller than Max " << maxVal << std::endl;
         std::exit(EXIT_FAILURE);
     }
 
-    /* The fastest sine we can produce has 1/3 the frequency of the sampling frequency (i.e., 1/sampling interval).
+    /* The sinusoid is sampled once every time getSignalValue() is called, i.e., once per 
+     * invocation of the mask generator. So, sineSamplingFreq is the rate of the mask generator.
      * Nyquist criterion says that a sinusoid's sampling frequency must be at least twice that of the sinusoid.
-     * For better fidelity, we are limiting the sinusoid's frequency to only 1/3 sampling frequency instead of 1/2
-     * Additioanlly, we will limit the maximum frequency used by a sinusoid (param2) even further, 
+     * For better fidelity, we limit the maximum frequency used by a sinusoid (param2) even further, 
      * because we want to see at least minSineCycles cycles of the sinusoid.
      */
-    sineSamplingFreq = 1000.0 / (3 * (double) samplingIntervalMS);
-
     sanitizeParamValues();
+    if (sigType == SignalType::MultiTone) {
+        //start the tones with random phases so that their peaks don't line up
+        for (uint32_t i = 0; i < multiToneCount; i++) {
+            tones.push_back(Oscillator(random.uniform(0.0, 2.0 * M_PI)));
+        }
+        selectToneFrequencies();
+    }
+    updateFrequencies();
+}
 
-    //Create the required distributions. Note that Sine isn't a distribution
-    if (sigType == SignalType::Normal) {
-        normalDist = std::normal_distribution<double>(param1, param2);
-    } else if (sigType == SignalType::GaussSine) {
-        normalDist = std::normal_distribution<double>(0, param4);
-    } else if (sigType == SignalType::Uniform) {
-        uniformDist.param(std::uniform_real_distribution<>::param_type(param1, param2));
+void SignalGenerator::selectToneFrequencies() {
+    auto minFreq = sineSamplingFreq / (double) maxSignalPropHold;
+    toneFreqs.resize(multiToneCount);
+    random.fillUniform(toneFreqs.data(), toneFreqs.size(), minFreq, std::max(minFreq, param2));
+}
+
+void SignalGenerator::updateFrequencies() {
+    if (sigType == SignalType::Sine || sigType == SignalType::GaussSine) {
+        sine.setFrequency(param2, sineSamplingFreq);
+    } else if (sigType == SignalType::MultiTone) {
+        for (uint32_t i = 0; i < multiToneCount; i++) {
+            tones[i].setFrequency(toneFreqs[i], sineSamplingFreq);
+        }
+    } else if (sigType == SignalType::BandNoise) {
+        bandFilter.setBand(param2, param4, sineSamplingFreq);
     }
 }
 
+double SignalGenerator::nextColoredValue(double white) {
+    if (sigType == SignalType::Pink) {
+        double pink = pinkState[6] + pinkDirectGain * white;
+        for (uint32_t k = 0; k < 6; k++) {
+            pinkState[k] = pinkPoles[k] * pinkState[k] + pinkGains[k] * white;
+            pink += pinkState[k];
+        }
+        pinkState[6] = pinkDelayedGain * white;
+        return param1 + param2 * pink / pinkFilterStddev;
+    }
+    return param1 + param3 * bandFilter.filter(white);
+}
+
 void SignalGenerator::sanitizeParamValues() {
     //Make sure minVal < param1 < maxVal. This is true for all signals
     param1 = std::max(param1, minVal);
     param1 = std::min(param1, maxVal);
 
     //Enforce signal specific rules
-    if (sigType == SignalType::Sine || sigType == SignalType::GaussSine) {
-        //param2 is frequency
+    if (sigType == SignalType::Sine || sigType == SignalType::GaussSine || 
+            sigType == SignalType::BandNoise || sigType == SignalType::MultiTone) {
+        //param2 is frequency (the center frequency for BandNoise, the highest for MultiTone)
         /* Make sure minFreq < param2 < maxFreq 
          * minFreq depends on what is the maximum duration that the signal properties can be unchanged.
-         * This is given by signalPropHoldDist.max()
+         * This is given by maxSignalPropHold
          * maxFreq is sineSamplingFreq / minSineCycles
          */
         param2 = std::min(param2, sineSamplingFreq / minSineCycles);
-        param2 = std::max(param2, sineSamplingFreq / (double) signalPropHoldDist.max());
-
+        param2 = std::max(param2, sineSamplingFreq / (double) maxSignalPropHold);
+    }
+    if (sigType == SignalType::BandNoise) {
+        //param4 is the bandwidth. Keep Q (param2 / param4) in [1,10] so that the band stays 
+        //below the Nyquist frequency and the filter stays short
+        param4 = std::min(param4, param2);
+        param4 = std::max(param4, param2 / 10.0);
+    }
+    if (sigType == SignalType::Sine || sigType == SignalType::GaussSine || sigType == SignalType::MultiTone) {
         //param1 is offset and param3 is amplitude. 
         /* Make sure that the maximum value of the sinusoid (i.e., param1+param3) 
          * does not go above maxVal, and the minimum value of the sinusoid 
@@ -208,20 +315,27 @@ double SignalGenerator::getSignalValue() {
     double newValue = 0.0;
     if (sigType == SignalType::Normal) {
 #ifdef DEBUG
-        std::cout << "Sampling Normal dist with " << normalDist.mean() << "  " << normalDist.stddev() << std::endl;
+        std::cout << "Sampling Normal dist with " << param1 << "  " << param2 << std::endl;
 #endif
-        newValue = normalDist(randomGen);
+        newValue = random.normal(param1, param2);
 #ifdef DEBUG
         std::cout << "Returning Normal " << newValue << std::endl;
 #endif
     } else if (sigType == SignalType::Sine || sigType == SignalType::GaussSine) {
-        newValue = param1 + (param3 * sin(2.0 * M_PI * param2 * time));
-        time = time + (1.0 / sineSamplingFreq);
+        newValue = param1 + (param3 * sine.next());
         if (sigType == SignalType::GaussSine) {
-            newValue += normalDist(randomGen);
+            newValue += random.normal(0.0, param4);
         }
     } else if (sigType == SignalType::Uniform) {
-        newValue = uniformDist(randomGen);
+        newValue = random.uniform(param1, param2);
+    } else if (sigType == SignalType::Pink || sigType == SignalType::BandNoise) {
+        newValue = nextColoredValue(random.normal());
+    } else if (sigType == SignalType::MultiTone) {
+        double sum = 0.0;
+        for (auto& tone : tones) {
+            sum += tone.next();
+        }
+        newValue = param1 + param3 * sum / multiToneCount;
     }
     //Ensure minVal < newValue < maxVal
     newValue = std::min(newValue, maxVal);
@@ -230,6 +344,42 @@ double SignalGenerator::getSignalValue() {
     return newValue;
 }
 
+void SignalGenerator::getSignalValues(double* values, uint32_t count) {
+    //the same random numbers are drawn in the same order as by getSignalValue()
+    if (sigType == SignalType::Normal) {
+        random.fillNormal(values, count, param1, param2);
+    } else if (sigType == SignalType::Sine || sigType == SignalType::GaussSine) {
+        if (sigType == SignalType::GaussSine) {
+            random.fillNormal(values, count, 0.0, param4);
+        } else {
+            std::fill(values, values + count, 0.0);
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            values[i] += param1 + (param3 * sine.next());
+        }
+    } else if (sigType == SignalType::Uniform) {
+        random.fillUniform(values, count, param1, param2);
+    } else if (sigType == SignalType::Pink || sigType == SignalType::BandNoise) {
+        random.fillNormal(values, count);
+        for (uint32_t i = 0; i < count; i++) {
+            values[i] = nextColoredValue(values[i]);
+        }
+    } else if (sigType == SignalType::MultiTone) {
+        std::fill(values, values + count, 0.0);
+        for (auto& tone : tones) {
+            for (uint32_t i = 0; i < count; i++) {
+                values[i] += tone.next();
+            }
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            values[i] = param1 + param3 * values[i] / multiToneCount;
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        values[i] = std::max(std::min(values[i], maxVal), minVal);
+    }
+}
+
 void SignalGenerator::enableRandomizedParam(Param p, std::pair<double, double> range) {
     switch (p) {
         case Param::One:
@@ -259,22 +409,22 @@ void SignalGenerator::setParamRange(Param p, std::pair<double, double> range) {
 #ifdef DEBUG
         std::cout << " for param1" << std::endl;
 #endif
-        param1Dist.param(std::uniform_real_distribution<>::param_type(newRange.first, newRange.second));
+        param1Range = newRange;
     } else if (p == Param::Two) {
 #ifdef DEBUG
         std::cout << " for param2" << std::endl;
 #endif
-        param2Dist.param(std::uniform_real_distribution<>::param_type(newRange.first, newRange.second));
+        param2Range = newRange;
     } else if (p == Param::Three) {
 #ifdef DEBUG
         std::cout << " for param3" << std::endl;
 #endif
-        param3Dist.param(std::uniform_real_distribution<>::param_type(newRange.first, newRange.second));
+        param3Range = newRange;
     } else if (p == Param::Four) {
 #ifdef DEBUG
         std::cout << " for param4" << std::endl;
 #endif
-        param4Dist.param(std::uniform_real_distribution<>::param_type(newRange.first, newRange.second));
+        param4Range = newRange;
     }
 }
 
@@ -287,11 +437,12 @@ std::pair<double, double> SignalGenerator::sanitizeParamRanges(Param p, std::pai
         std::exit(EXIT_FAILURE);
     }
 
-    if (p == Param::One || (p == Param::Two && sigType == SignalType::Uniform) || p == Param::Three) {
+    if (p == Param::One || (p == Param::Two && sigType == SignalType::Uniform) || 
+            (p == Param::Three && sigType != SignalType::BandNoise)) {
         /* In this case, p is either:
          * Param One: {min value for uniform dist, mean of normal dist, offset of sinusoid (in Sine or GaussSine)} or
          * Param Two in Uniform: {max value of uniform dist} or
-         * Param Three: {amplitude of sinusoid (Sine or GaussSine)
+         * Param Three: {amplitude of sinusoid (Sine, GaussSine or MultiTone)
          */
         //The condition to check is: minVal < range_min,range_max < maxVal
         range_min = std::max(range_min, minVal);
@@ -299,11 +450,12 @@ std::pair<double, double> SignalGenerator::sanitizeParamRanges(Param p, std::pai
 
         range_max = std::max(range_max, minVal);
         range_max = std::min(range_max, maxVal);
-    } else if (p == Param::Two && (sigType == SignalType::Sine || sigType == SignalType::GaussSine)) {
-        //In this case, p is Param Two i.e., the frequency parameter in Sine or GaussSine
+    } else if (p == Param::Two && (sigType == SignalType::Sine || sigType == SignalType::GaussSine ||
+            sigType == SignalType::BandNoise || sigType == SignalType::MultiTone)) {
+        //In this case, p is Param Two i.e., the frequency parameter in Sine, GaussSine, BandNoise or MultiTone
         //condition to check is: minFreq < range_min,range_max < maxFreq
 
-        auto minFreq = sineSamplingFreq / (double) signalPropHoldDist.max();
+        auto minFreq = sineSamplingFreq / (double) maxSignalPropHold;
         auto maxFreq = sineSamplingFreq / minSineCycles;
         range_min = std::max(range_min, minFreq);
         range_min = std::min(range_min, maxFreq);
@@ -319,13 +471,13 @@ std::pair<double, double> SignalGenerator::sanitizeParamRanges(Param p, std::pai
 void SignalGenerator::selectNewValForParam(Param p) {
     double val;
     if (p == Param::One) {
-        val = param1Dist(randomGen);
+        val = random.uniform(param1Range.first, param1Range.second);
     } else if (p == Param::Two) {
-        val = param2Dist(randomGen);
+        val = random.uniform(param2Range.first, param2Range.second);
     } else if (p == Param::Three) {
-        val = param3Dist(randomGen);
+        val = random.uniform(param3Range.first, param3Range.second);
     } else if (p == Param::Four) {
-        val = param4Dist(randomGen);
+        val = random.uniform(param4Range.first, param4Range.second);
     }
     setParam(p, val);
 }
@@ -341,39 +493,36 @@ void SignalGenerator::setParam(Param p, double val) {
         param4 = val;
     }
     sanitizeParamValues();
-
-    //Adjust the signal distributions
-    if (sigType == SignalType::Normal) {
-        normalDist.param(std::normal_distribution<double>::param_type(param1, param2));
-    } else if (sigType == SignalType::GaussSine) {
-        normalDist.param(std::normal_distribution<double>::param_type(normalDist.mean(), param4));
-    } else if (sigType == SignalType::Uniform) {
-        uniformDist.param(std::uniform_real_distribution<>::param_type(param1, param2));
+    if (sigType == SignalType::MultiTone && p == Param::Two) {
+        selectToneFrequencies();
+    }
+    if (p == Param::Two || (sigType == SignalType::BandNoise && p == Param::Four)) {
+        updateFrequencies();
     }
 }
 
 std::pair<double, double> SignalGenerator::getParamRange(Param p) {
     if (p == Param::One) {
         if (randomizeParam1) {
-            return std::make_pair(param1Dist.min(), param1Dist.max());
+            return param1Range;
         } else {
             return std::make_pair(param1, param1);
         }
     } else if (p == Param::Two) {
         if (randomizeParam2) {
-            return std::make_pair(param2Dist.min(), param2Dist.max());
+            return param2Range;
         } else {
             return std::make_pair(param2, param2);
         }
     } else if (p == Param::Three) {
         if (randomizeParam3) {
-            return std::make_pair(param3Dist.min(), param3Dist.max());
+            return param3Range;
         } else {
             return std::make_pair(param3, param3);
         }
     } else if (p == Param::Four) {
         if (randomizeParam4) {
-            return std::make_pair(param4Dist.min(), param4Dist.max());
+            return param4Range;
         } else {
             return std::make_pair(param4, param4);
         }
@@ -384,13 +533,18 @@ Vector SignalGenerator::getParams() {
     return Vector({param1, param2, param3, param4});
 }
 
-MaskGenerator::MaskGenerator(std::string name, std::string dirPath, std::string fileName, uint32_t smplInt,
-        SignalType sigType, bool randomMProp) :
-Planner(name, dirPath, fileName, smplInt),
+MaskGenerator::MaskGenerator(std::string name, std::string dirPath, std::string fileName, uint32_t periodUS,
+        SignalType sigType, bool randomMProp, uint32_t lookahead) :
+Planner(name, dirPath, fileName, periodUS),
 signalType(sigType),
+generatedTargets(targets),
 randomizeMaskProps(randomMProp),
 maskPropHoldCounter(0),
-maskPropHoldPeriod(0) {
+maskPropHoldPeriod(0),
+uniformHoldStep(std::max(1u, periodUS / (samplingIntervalMS * 1000))),
+random(newRandomStream()),
+lookahead(lookahead),
+stopGenerator(false) {
     //for a Uniform mask, a new target is not chosen at every invocation because, a given 
     //target is held constant for a period of time. This is a piecewise constant target, 
     //and not a uniformly random target despite its name. So, a new value is sampled 
@@ -399,26 +553,43 @@ maskPropHoldPeriod(0) {
     //To get a uniformly random mask, simply make the SignalType::Uniform change at 
     //every invocation instead of only at maskPropHoldPeriods.
     if (randomizeMaskProps || signalType == SignalType::Uniform) {
-        maskPropHoldPeriod = signalPropHoldDist(randomGen);
+        maskPropHoldPeriod = random.uniformInt(minSignalPropHold, maxSignalPropHold);
     }
 
 #ifdef DEBUG
     std::cout << " Init maskPropHoldPeriod " << maskPropHoldPeriod << std::endl;
 #endif
     auto numOutputs = maxLimits.size();
-    for (auto i = 0; i < numOutputs; i++) {
+    double invocationFreq = 1000000.0 / periodUS; //in Hz
+    auto numSignals = numOutputs;
+    if (signalType == SignalType::Markov) {
+        //one chain gives all the targets, there are no signals and no properties to randomize
+        markovChain = std::make_unique<MarkovChain>(dirPath + "/" + fileName, numOutputs, newRandomStream());
+        numSignals = 0;
+    }
+    for (auto i = 0; i < numSignals; i++) {
         std::shared_ptr<SignalGenerator> signalDist;
         if (signalType == SignalType::Normal) {
             //Normal (min,max, p1:mean,p2:std,_,_)
             //initial stddev of the normal dist is chosen as 1/6 of the range
-            signalDist = std::make_shared<SignalGenerator>(signalType, minLimits[i], maxLimits[i], targets[i], (maxLimits[i] - minLimits[i]) / 6, 0, 0);
+            signalDist = std::make_shared<SignalGenerator>(signalType, minLimits[i], maxLimits[i], targets[i], (maxLimits[i] - minLimits[i]) / 6, 0, 0, invocationFreq);
         } else if (signalType == SignalType::Sine || signalType == SignalType::GaussSine) {
             //GaussSine (min,max, p1:offset,p2:frequency,p3:amplitude,p4: normal_stddev); p4 is ignored if we are only suing sine
             //init freq is sampling freq/5, init amp is 1/6 of range, init normal's stddev is 1/6 of the range
-            signalDist = std::make_shared<SignalGenerator>(signalType, minLimits[i], maxLimits[i], targets[i], 1000 / (5 * periodInSamples * samplingIntervalMS), (maxLimits[i] - minLimits[i]) / 6, (maxLimits[i] - minLimits[i]) / 6);
+            signalDist = std::make_shared<SignalGenerator>(signalType, minLimits[i], maxLimits[i], targets[i], invocationFreq / 5, (maxLimits[i] - minLimits[i]) / 6, (maxLimits[i] - minLimits[i]) / 6, invocationFreq);
         } else if (signalType == SignalType::Uniform) {
             //Uniform(min,max,p1:min, p2:max,_,_)
-            signalDist = std::make_shared<SignalGenerator>(signalType, minLimits[i], maxLimits[i], minLimits[i], maxLimits[i], 0, 0);
+            signalDist = std::make_shared<SignalGenerator>(signalType, minLimits[i], maxLimits[i], minLimits[i], maxLimits[i], 0, 0, invocationFreq);
+        } else if (signalType == SignalType::Pink) {
+            //Pink (min,max, p1:mean,p2:std,_,_), like Normal
+            signalDist = std::make_shared<SignalGenerator>(signalType, minLimits[i], maxLimits[i], targets[i], (maxLimits[i] - minLimits[i]) / 6, 0, 0, invocationFreq);
+        } else if (signalType == SignalType::BandNoise) {
+            //BandNoise (min,max, p1:offset,p2:center frequency,p3:std,p4:bandwidth)
+            //init center freq is sampling freq/5 and bandwidth half of it, init std is 1/6 of the range
+            signalDist = std::make_shared<SignalGenerator>(signalType, minLimits[i], maxLimits[i], targets[i], invocationFreq / 5, (maxLimits[i] - minLimits[i]) / 6, invocationFreq / 10, invocationFreq);
+        } else if (signalType == SignalType::MultiTone) {
+            //MultiTone (min,max, p1:offset,p2:highest frequency,p3:amplitude,_), initialized like Sine
+            signalDist = std::make_shared<SignalGenerator>(signalType, minLimits[i], maxLimits[i], targets[i], invocationFreq / 5, (maxLimits[i] - minLimits[i]) / 6, 0, invocationFreq);
         }
 
         if (randomizeMaskProps) {
@@ -428,15 +599,91 @@ maskPropHoldPeriod(0) {
                 signalDist->enableRandomizedParam(Param::Two, std::make_pair(0, (maxLimits[i] - minLimits[i]) / 6));
             } else if (signalType == SignalType::Sine || signalType == SignalType::GaussSine) {
                 //sinusoid's freq can span minFreq (samplingFreq/maskPropHoldPeriod) to maxFreq (samplingFreq/4)
-                signalDist->enableRandomizedParam(Param::Two, std::make_pair(1000 / (maskPropHoldPeriod * periodInSamples * samplingIntervalMS), 1000 / (4 * periodInSamples * samplingIntervalMS)));
+                signalDist->enableRandomizedParam(Param::Two, std::make_pair(invocationFreq / maskPropHoldPeriod, invocationFreq / 4));
                 //amp can span full range
                 signalDist->enableRandomizedParam(Param::Three, std::make_pair(minLimits[i], maxLimits[i]));
                 //normal's stddev can span some range.
                 signalDist->enableRandomizedParam(Param::Four, std::make_pair(0, (maxLimits[i] - minLimits[i]) / 6));
+            } else if (signalType == SignalType::Pink) {
+                signalDist->enableRandomizedParam(Param::Two, std::make_pair(0, (maxLimits[i] - minLimits[i]) / 6));
+            } else if (signalType == SignalType::BandNoise) {
+                //the band can be anywhere the sinusoids can be, and as narrow as the hold allows
+                signalDist->enableRandomizedParam(Param::Two, std::make_pair(invocationFreq / maskPropHoldPeriod, invocationFreq / 4));
+                signalDist->enableRandomizedParam(Param::Three, std::make_pair(0, (maxLimits[i] - minLimits[i]) / 6));
+                signalDist->enableRandomizedParam(Param::Four, std::make_pair(invocationFreq / maskPropHoldPeriod, invocationFreq / 4));
+            } else if (signalType == SignalType::MultiTone) {
+                signalDist->enableRandomizedParam(Param::Two, std::make_pair(invocationFreq / maskPropHoldPeriod, invocationFreq / 4));
+                signalDist->enableRandomizedParam(Param::Three, std::make_pair(minLimits[i], maxLimits[i]));
             }
         }
         signalDists.push_back(std::move(signalDist));
     }
+
+    if (lookahead > 0) {
+        futureTargets = std::make_unique<RingBuffer<double>>((std::size_t) lookahead * numOutputs);
+        startGenerating();
+    }
+}
+
+MaskGenerator::~MaskGenerator() {
+    stopGenerating();
+}
+
+void MaskGenerator::reset() {
+    stopGenerating();
+    Planner::reset();
+    generatedTargets = targets;
+    if (futureTargets != nullptr) {
+        //drop the targets computed ahead, they continue from the old ones
+        std::vector<double> row(targets.size());
+        while (futureTargets->pop(row.data(), row.size())) {
+        }
+        startGenerating();
+    }
+}
+
+void MaskGenerator::startGenerating() {
+    stopGenerator = false;
+    generatorThread = std::thread(&MaskGenerator::generateLoop, this);
+}
+
+void MaskGenerator::stopGenerating() {
+    {
+        std::lock_guard<std::mutex> lock(generatorLock);
+        stopGenerator = true;
+    }
+    generatorWakeup.notify_one();
+    if (generatorThread.joinable()) {
+        generatorThread.join();
+    }
+}
+
+void MaskGenerator::wakeGenerator() {
+    //taking the lock makes sure that the helper thread is either refilling or waiting
+    std::lock_guard<std::mutex> lock(generatorLock);
+    generatorWakeup.notify_one();
+}
+
+void MaskGenerator::generateLoop() {
+    auto rowSize = generatedTargets.size();
+    auto refillLevel = (std::size_t) (lookahead / 2) * rowSize;
+    std::vector<double> rows((std::size_t) maskBatchRows * rowSize);
+    while (true) {
+        std::size_t freeRows;
+        while ((freeRows = (futureTargets->capacity() - futureTargets->size()) / rowSize) > 0) {
+            auto numRows = (uint32_t) std::min<std::size_t>(freeRows, maskBatchRows);
+            generateNextTargets(rows.data(), numRows);
+            futureTargets->push(rows.data(), (std::size_t) numRows * rowSize);
+        }
+
+        std::unique_lock<std::mutex> lock(generatorLock);
+        generatorWakeup.wait(lock, [&]() {
+            return stopGenerator || futureTargets->size() <= refillLevel;
+        });
+        if (stopGenerator) {
+            return;
+        }
+    }
 }
 
 bool MaskGenerator::shouldMaskPropChange() {
@@ -451,7 +698,7 @@ bool MaskGenerator::shouldMaskPropChange() {
     return false;
 }
 
-Vector MaskGenerator::computeNewTargets(bool run) {
+Vector MaskGenerator::computeNewTargets() {
 #ifdef DEBUG
     std::cout << "---------RandomPlanner: " << name << "---------" << std::endl;
 #endif
@@ -459,48 +706,102 @@ Vector MaskGenerator::computeNewTargets(bool run) {
     auto numOutputs = targets.size();
     outputs = currOutputVals->updateValuesFromPort();
 
-    //Use this if you want piecewise uniformly constant, and remove if you need uniformly random
-    if (signalType == SignalType::Uniform) {
-        if (maskPropHoldCounter == maskPropHoldPeriod) {
-            maskPropHoldCounter = 0;
-            maskPropHoldPeriod = signalPropHoldDist(randomGen);
-            run = true;
-        } else {
-            run = false;
-            maskPropHoldCounter++;
+#ifdef DEBUG
+    auto currTargets = targets;
+#endif
+    if (futureTargets == nullptr) {
+        generateNextTargets(&targets[0]);
+    } else {
+        while (!futureTargets->pop(&targets[0], numOutputs)) {
+            //the helper thread is behind, e.g., on the first invocation
+            wakeGenerator();
+            std::this_thread::yield();
+        }
+        //the ring is popped one row at a time, so it passes through the refill level
+        if (futureTargets->size() == (std::size_t) (lookahead / 2) * numOutputs) {
+            wakeGenerator();
         }
     }
-
-    if (run) {
-        Vector newTargets(numOutputs);
-        bool getNewProps = shouldMaskPropChange();
-        if (getNewProps) {
-            maskPropHoldPeriod = signalPropHoldDist(randomGen);
 #ifdef DEBUG
-            std::cout << "Creating new mask properties for period " << maskPropHoldPeriod << std::endl;
+    std::cout << "currOps " << outputs << "currTargets " << currTargets << "newTargets " << targets;
 #endif
-        }
+    return targets;
+}
 
-        for (auto i = 0; i < numOutputs; i++) {
-            auto signalDist = signalDists[i];
-            if (getNewProps) {
-                signalDist->selectNewValForParam(Param::One);
-                signalDist->selectNewValForParam(Param::Two);
-                signalDist->selectNewValForParam(Param::Three);
-                signalDist->selectNewValForParam(Param::Four);
+void MaskGenerator::generateNextTargets(double* newTargets, uint32_t numRows) {
+    auto numOutputs = generatedTargets.size();
+    if (signalValues.size() < numRows) {
+        signalValues.resize(numRows);
+    }
+
+    if (markovChain != nullptr) {
+        for (uint32_t row = 0; row < numRows; row++) {
+            auto rowTargets = newTargets + (std::size_t) row * numOutputs;
+            markovChain->next(rowTargets);
+            for (auto i = 0; i < numOutputs; i++) {
+                rowTargets[i] = std::max(std::min(rowTargets[i], maxLimits[i]), minLimits[i]);
             }
+        }
+        std::copy(newTargets + (std::size_t) (numRows - 1) * numOutputs, newTargets + (std::size_t) numRows * numOutputs,
+                generatedTargets.begin());
+        return;
+    }
 
-            newTargets[i] = signalDist->getSignalValue();
+    uint32_t row = 0;
+    while (row < numRows) {
+        //Use this if you want piecewise uniformly constant, and remove if you need uniformly random
+        bool run = true;
+        if (signalType == SignalType::Uniform) {
+            if (maskPropHoldCounter >= maskPropHoldPeriod) {
+                maskPropHoldCounter = 0;
+                maskPropHoldPeriod = random.uniformInt(minSignalPropHold, maxSignalPropHold);
+            } else {
+                run = false;
+                maskPropHoldCounter += uniformHoldStep;
+            }
         }
+
+        //The rows until the properties change next are generated as one batch. 
+        //A uniform mask is generated one row at a time because of its hold.
+        uint32_t batchRows = 1;
+        if (run) {
+            bool getNewProps = shouldMaskPropChange();
+            if (getNewProps) {
+                maskPropHoldPeriod = random.uniformInt(minSignalPropHold, maxSignalPropHold);
 #ifdef DEBUG
-        std::cout << "currOps " << outputs << "currTargets " << targets << "newTargets " << newTargets;
+                std::cout << "Creating new mask properties for period " << maskPropHoldPeriod << std::endl;
 #endif
-        targets = newTargets;
-        return newTargets;
-    }
-    
+            }
+            if (signalType != SignalType::Uniform) {
+                batchRows = numRows - row;
+                if (randomizeMaskProps) {
+                    //shouldMaskPropChange() would return false for the next (period - counter) rows
+                    batchRows = std::min(batchRows, maskPropHoldPeriod - maskPropHoldCounter + 1);
+                    maskPropHoldCounter += batchRows - 1;
+                }
+            }
+
+            for (auto i = 0; i < numOutputs; i++) {
+                auto& signalDist = signalDists[i];
+                if (getNewProps) {
+                    signalDist->selectNewValForParam(Param::One);
+                    signalDist->selectNewValForParam(Param::Two);
+                    signalDist->selectNewValForParam(Param::Three);
+                    signalDist->selectNewValForParam(Param::Four);
+                }
+
+                signalDist->getSignalValues(signalValues.data(), batchRows);
+                for (uint32_t r = 0; r < batchRows; r++) {
+                    newTargets[(std::size_t) (row + r) * numOutputs + i] = signalValues[r];
+                }
+                generatedTargets[i] = signalValues[batchRows - 1];
+            }
+        } else {
 #ifdef DEBUG
-    std::cout << "Skipping" << std::endl;
+            std::cout << "Skipping" << std::endl;
 #endif
-    return targets;
+            std::copy(generatedTargets.begin(), generatedTargets.end(), newTargets + (std::size_t) row * numOutputs);
+        }
+        row += batchRows;
+    }
 }
@@ -0,0 +1,299 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   PresetSource.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "PresetSource.h"
+#include "debug.h"
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+//pages of a binary preset are prefetched and released in chunks of this size
+const std::size_t chunkBytes = 8 * 1024 * 1024;
+
+//a text preset is parsed ahead into this many blocks of this many rows
+const uint32_t numTextBlocks = 3;
+const uint32_t rowsPerTextBlock = 4096;
+
+//0 if there is no _presetlen.txt (use every row)
+uint64_t readMaxRows(std::string fileNamePrefix) {
+    std::ifstream file(fileNamePrefix + "_presetlen.txt");
+    uint64_t maxRows = 0;
+    if (file) {
+        file >> maxRows;
+    }
+    return maxRows;
+}
+
+class BinaryPresetSource : public PresetSource {
+public:
+
+    BinaryPresetSource(std::string fileName, uint32_t width, uint64_t maxRows) :
+    width(width),
+    currentRow(0),
+    released(0),
+    nextChunk(0) {
+        int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Unable to open " << fileName << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        struct stat fileStat;
+        fstat(fd, &fileStat);
+        size = fileStat.st_size;
+        auto rowBytes = sizeof (double) * width;
+        if (width == 0 || size == 0 || size % rowBytes != 0) {
+            close(fd);
+            std::cout << fileName << " must hold whole rows of " << width << " doubles" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        numRows = size / rowBytes;
+        if (maxRows > 0) {
+            numRows = std::min(numRows, maxRows);
+        }
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            std::cerr << "Unable to map " << fileName << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        data = static_cast<const char*> (mapping);
+        rows = static_cast<const double*> (mapping);
+        madvise(mapping, size, MADV_SEQUENTIAL);
+#ifdef DEBUG
+        std::cout << "Mapped " << numRows << " preset rows from " << fileName << std::endl;
+#endif
+    }
+
+    ~BinaryPresetSource() override {
+        munmap(const_cast<char*> (data), size);
+    }
+
+    const double* nextRow() override {
+        if (currentRow == numRows) {
+            rewind();
+        }
+        auto offset = currentRow * width * sizeof (double);
+        if (offset >= nextChunk) {
+            moveToChunk(offset);
+        }
+        return rows + (currentRow++) * width;
+    }
+
+    void rewind() override {
+        releaseUpTo(size);
+        released = 0;
+        nextChunk = 0;
+        currentRow = 0;
+    }
+
+private:
+
+    //prefetch the chunk with this offset and the next one, and release what is behind
+    void moveToChunk(std::size_t offset) {
+        auto chunkBegin = (offset / chunkBytes) * chunkBytes;
+        releaseUpTo(chunkBegin);
+        madvise(const_cast<char*> (data + chunkBegin), std::min(2 * chunkBytes, size - chunkBegin), MADV_WILLNEED);
+        nextChunk = chunkBegin + chunkBytes;
+    }
+
+    void releaseUpTo(std::size_t end) {
+        if (end > released) {
+            madvise(const_cast<char*> (data + released), end - released, MADV_DONTNEED);
+            released = end;
+        }
+    }
+
+    uint32_t width;
+    const char* data;
+    const double* rows;
+    std::size_t size;
+    uint64_t numRows, currentRow;
+    std::size_t released, nextChunk;
+};
+
+class TextPresetSource : public PresetSource {
+public:
+
+    TextPresetSource(std::string fileName, uint32_t width, uint64_t maxRows) :
+    fileName(fileName),
+    width(width),
+    maxRows(maxRows),
+    stopReading(false),
+    rowInBlock(0) {
+        //fail here rather than on the helper thread
+        std::ifstream file(fileName);
+        double value;
+        if (!file || !(file >> value)) {
+            std::cerr << "Unable to read presets from " << fileName << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        for (uint32_t i = 0; i < numTextBlocks; i++) {
+            auto block = std::make_unique<Block>();
+            block->values.resize((std::size_t) rowsPerTextBlock * width);
+            freeBlocks.push_back(std::move(block));
+        }
+        startReader();
+    }
+
+    ~TextPresetSource() override {
+        stopReader();
+    }
+
+    const double* nextRow() override {
+        if (current == nullptr || rowInBlock == current->numRows) {
+            std::unique_lock<std::mutex> lock(blockLock);
+            if (current != nullptr) {
+                freeBlocks.push_back(std::move(current));
+                blocksChanged.notify_all();
+            }
+            //only waits if the planner has caught up with the reader (e.g., the first row)
+            blocksChanged.wait(lock, [this]() {
+                return !readyBlocks.empty();
+            });
+            current = std::move(readyBlocks.front());
+            readyBlocks.pop_front();
+            rowInBlock = 0;
+        }
+        return current->values.data() + (std::size_t) (rowInBlock++) * width;
+    }
+
+    void rewind() override {
+        stopReader();
+        if (current != nullptr) {
+            freeBlocks.push_back(std::move(current));
+        }
+        while (!readyBlocks.empty()) {
+            freeBlocks.push_back(std::move(readyBlocks.front()));
+            readyBlocks.pop_front();
+        }
+        rowInBlock = 0;
+        startReader();
+    }
+
+private:
+
+    struct Block {
+        std::vector<double> values;
+        uint32_t numRows = 0;
+    };
+
+    void startReader() {
+        stopReading = false;
+        reader = std::thread(&TextPresetSource::readLoop, this);
+    }
+
+    void stopReader() {
+        {
+            std::lock_guard<std::mutex> lock(blockLock);
+            stopReading = true;
+        }
+        blocksChanged.notify_all();
+        if (reader.joinable()) {
+            reader.join();
+        }
+    }
+
+    //fills free blocks with the next rows, starting over after the last one
+    void readLoop() {
+        std::ifstream file(fileName);
+        uint64_t rowsRead = 0;
+        while (true) {
+            std::unique_ptr<Block> block;
+            {
+                std::unique_lock<std::mutex> lock(blockLock);
+                blocksChanged.wait(lock, [this]() {
+                    return stopReading || !freeBlocks.empty();
+                });
+                if (stopReading) {
+                    return;
+                }
+                block = std::move(freeBlocks.front());
+                freeBlocks.pop_front();
+            }
+
+            block->numRows = 0;
+            while (block->numRows < rowsPerTextBlock) {
+                bool rowComplete = (maxRows == 0 || rowsRead < maxRows);
+                double* row = block->values.data() + (std::size_t) block->numRows * width;
+                for (uint32_t i = 0; rowComplete && i < width; i++) {
+                    rowComplete = static_cast<bool> (file >> row[i]);
+                }
+                if (rowComplete) {
+                    block->numRows++;
+                    rowsRead++;
+                } else if (rowsRead > 0) {
+                    //end of the preset: hand out what we have and start over
+                    file.clear();
+                    file.seekg(0);
+                    rowsRead = 0;
+                    if (block->numRows > 0) {
+                        break;
+                    }
+                } else {
+                    std::cerr << fileName << " has no complete row of " << width << " values" << std::endl;
+                    std::exit(EXIT_FAILURE);
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(blockLock);
+                readyBlocks.push_back(std::move(block));
+            }
+            blocksChanged.notify_all();
+        }
+    }
+
+    std::string fileName;
+    uint32_t width;
+    uint64_t maxRows;
+
+    std::thread reader;
+    std::mutex blockLock; //guards the two lists of blocks and stopReading
+    std::condition_variable blocksChanged;
+    std::deque<std::unique_ptr<Block>> freeBlocks, readyBlocks;
+    bool stopReading;
+
+    //owned by the planner's thread
+    std::unique_ptr<Block> current;
+    uint32_t rowInBlock;
+};
+
+}
+
+std::unique_ptr<PresetSource> PresetSource::open(std::string fileNamePrefix, uint32_t width) {
+    auto maxRows = readMaxRows(fileNamePrefix);
+    auto binaryFileName = fileNamePrefix + "_presets.bin";
+    if (access(binaryFileName.c_str(), F_OK) == 0) {
+        return std::unique_ptr<PresetSource>(new BinaryPresetSource(binaryFileName, width, maxRows));
+    }
+    return std::unique_ptr<PresetSource>(new TextPresetSource(fileNamePrefix + "_presets.txt", width, maxRows));
+}
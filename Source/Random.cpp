@@ -0,0 +1,203 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   Random.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "Random.h"
+#include <atomic>
+#include <cmath>
+
+namespace {
+
+//Philox4x32 multipliers and key increments (Salmon et al., SC'11)
+const uint32_t philoxM0 = 0xD2511F53, philoxM1 = 0xCD9E8D57;
+const uint32_t philoxW0 = 0x9E3779B9, philoxW1 = 0xBB67AE85;
+const uint32_t philoxRounds = 10;
+
+const double twoPowMinus53 = 1.0 / 9007199254740992.0;
+
+//Ziggurat with 128 layers for the standard normal (Marsaglia and Tsang, as formulated by Doornik)
+const uint32_t zigguratLayers = 128;
+const double zigguratR = 3.442619855899; //start of the tail
+const double zigguratV = 9.91256303526217e-3; //area of each layer
+
+struct ZigguratTables {
+    double x[zigguratLayers + 1]; //right edges of the layers
+    double ratio[zigguratLayers]; //x[i+1] / x[i], below which a point is inside the density
+
+    ZigguratTables() {
+        double f = std::exp(-0.5 * zigguratR * zigguratR);
+        x[0] = zigguratV / f;
+        x[1] = zigguratR;
+        x[zigguratLayers] = 0.0;
+        for (uint32_t i = 2; i < zigguratLayers; i++) {
+            x[i] = std::sqrt(-2.0 * std::log(zigguratV / x[i - 1] + f));
+            f = std::exp(-0.5 * x[i] * x[i]);
+        }
+        for (uint32_t i = 0; i < zigguratLayers; i++) {
+            ratio[i] = x[i + 1] / x[i];
+        }
+    }
+};
+
+const ZigguratTables ziggurat;
+
+//spreads the bits of the seed so that close seeds give unrelated keys
+uint64_t splitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+uint64_t randomSeed = 1;
+std::atomic<uint64_t> nextStreamId(0);
+
+}
+
+RandomStream::RandomStream(uint64_t seed, uint64_t streamId) :
+counter(0),
+streamId(streamId),
+bufferPos(bufferSize) {
+    auto mixedSeed = splitMix64(seed);
+    key[0] = (uint32_t) mixedSeed;
+    key[1] = (uint32_t) (mixedSeed >> 32);
+}
+
+void RandomStream::refill() {
+    //one lane per block, so the rounds of different blocks are independent
+    uint32_t c0[blocksPerRefill], c1[blocksPerRefill], c2[blocksPerRefill], c3[blocksPerRefill];
+    for (uint32_t b = 0; b < blocksPerRefill; b++) {
+        uint64_t blockIndex = counter + b;
+        c0[b] = (uint32_t) blockIndex;
+        c1[b] = (uint32_t) (blockIndex >> 32);
+        c2[b] = (uint32_t) streamId;
+        c3[b] = (uint32_t) (streamId >> 32);
+    }
+
+    uint32_t k0 = key[0], k1 = key[1];
+    for (uint32_t round = 0; round < philoxRounds; round++) {
+        for (uint32_t b = 0; b < blocksPerRefill; b++) {
+            uint64_t product0 = (uint64_t) philoxM0 * c0[b];
+            uint64_t product1 = (uint64_t) philoxM1 * c2[b];
+            uint32_t n0 = (uint32_t) (product1 >> 32) ^ c1[b] ^ k0;
+            uint32_t n2 = (uint32_t) (product0 >> 32) ^ c3[b] ^ k1;
+            c1[b] = (uint32_t) product1;
+            c3[b] = (uint32_t) product0;
+            c0[b] = n0;
+            c2[b] = n2;
+        }
+        k0 += philoxW0;
+        k1 += philoxW1;
+    }
+
+    for (uint32_t b = 0; b < blocksPerRefill; b++) {
+        buffer[4 * b] = c0[b];
+        buffer[4 * b + 1] = c1[b];
+        buffer[4 * b + 2] = c2[b];
+        buffer[4 * b + 3] = c3[b];
+    }
+    counter += blocksPerRefill;
+    bufferPos = 0;
+}
+
+double RandomStream::uniform() {
+    return (nextUInt64() >> 11) * twoPowMinus53;
+}
+
+double RandomStream::uniform(double min, double max) {
+    return min + (max - min) * uniform();
+}
+
+double RandomStream::openUniform() {
+    return ((nextUInt64() >> 11) + 0.5) * twoPowMinus53;
+}
+
+uint32_t RandomStream::uniformInt(uint32_t min, uint32_t max) {
+    //Lemire's multiply and reject: the high word of value * range is uniform after rejecting the few biased values
+    uint64_t range = (uint64_t) max - min + 1;
+    if (range > UINT32_MAX) {
+        return nextUInt32();
+    }
+    uint64_t product = (uint64_t) nextUInt32() * range;
+    if ((uint32_t) product < range) {
+        uint32_t threshold = (uint32_t) ((UINT32_MAX + 1ULL - range) % range);
+        while ((uint32_t) product < threshold) {
+            product = (uint64_t) nextUInt32() * range;
+        }
+    }
+    return min + (uint32_t) (product >> 32);
+}
+
+double RandomStream::normal() {
+    while (true) {
+        auto bits = nextUInt64();
+        uint32_t layer = bits & (zigguratLayers - 1);
+        double u = 2.0 * ((bits >> 11) * twoPowMinus53) - 1.0;
+        //almost always inside the rectangle under the density
+        if (std::fabs(u) < ziggurat.ratio[layer]) {
+            return u * ziggurat.x[layer];
+        }
+        if (layer == 0) {
+            return normalTail(u < 0.0);
+        }
+        double x = u * ziggurat.x[layer];
+        double f0 = std::exp(-0.5 * (ziggurat.x[layer] * ziggurat.x[layer] - x * x));
+        double f1 = std::exp(-0.5 * (ziggurat.x[layer + 1] * ziggurat.x[layer + 1] - x * x));
+        if (f1 + uniform() * (f0 - f1) < 1.0) {
+            return x;
+        }
+    }
+}
+
+double RandomStream::normalTail(bool negative) {
+    double x, y;
+    do {
+        x = std::log(openUniform()) / zigguratR;
+        y = std::log(openUniform());
+    } while (-2.0 * y < x * x);
+    return negative ? x - zigguratR : zigguratR - x;
+}
+
+double RandomStream::normal(double mean, double stddev) {
+    return mean + stddev * normal();
+}
+
+void RandomStream::fillUniform(double* values, std::size_t count, double min, double max) {
+    for (std::size_t i = 0; i < count; i++) {
+        values[i] = min + (max - min) * uniform();
+    }
+}
+
+void RandomStream::fillNormal(double* values, std::size_t count, double mean, double stddev) {
+    for (std::size_t i = 0; i < count; i++) {
+        values[i] = mean + stddev * normal();
+    }
+}
+
+void setRandomSeed(uint64_t seed) {
+    randomSeed = seed;
+    nextStreamId = 0;
+}
+
+uint64_t getRandomSeed() {
+    return randomSeed;
+}
+
+RandomStream newRandomStream() {
+    return RandomStream(randomSeed, nextStreamId++);
+}
@@ -0,0 +1,253 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/*
+ * File:   Replay.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "Replay.h"
+#include "LogHeader.h"
+#include "debug.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+//replayed pages are given back to the kernel in chunks of this size
+const std::size_t releaseChunkBytes = 64 * 1024 * 1024;
+
+}
+
+ReplayTrace::ReplayTrace(std::string fileName, std::shared_ptr<VirtualClock> clock, uint64_t intervalUS) :
+fileName(fileName),
+clock(clock),
+intervalUS(intervalUS),
+data(nullptr),
+size(0),
+cursor(0),
+released(0),
+numColumns(0),
+currentRowIndex(0),
+nextRowValid(false),
+finished(false) {
+    if (intervalUS == 0) {
+        std::cout << "Rows of the trace " << fileName << " must be > 0 us apart" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Unable to open " << fileName << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+        std::cout << "Trace " << fileName << " is empty" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    size = fileStat.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Unable to map " << fileName << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    data = static_cast<const char*> (mapping);
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    LogHeader logHeader;
+    const char *begin, *end;
+    auto lineStart = cursor;
+    while (nextLine(begin, end)) {
+        if (logHeader.addLine(splitLogLine(begin, end))) {
+            cursor = lineStart; //the first row is parsed below
+            break;
+        }
+        lineStart = cursor;
+    }
+    auto& header = logHeader.getNames();
+    for (uint32_t i = 0; i < header.size(); i++) {
+        auto handle = columnNames.intern(header[i]);
+        if (handle == columnIndices.size()) {
+            columnIndices.push_back(i); //the first column with a name wins
+        }
+    }
+    numColumns = header.size();
+    if (numColumns == 0) {
+        std::cout << "Trace " << fileName << " has no header line with the pin names" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    if (!parseNextRow(currentRow)) {
+        std::cout << "Trace " << fileName << " has no rows with " << numColumns << " values" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    nextRowValid = parseNextRow(nextRow);
+#ifdef DEBUG
+    std::cout << "Replaying " << fileName << " (" << size << " bytes, " << numColumns <<
+            " columns), one row every " << intervalUS << " us" << std::endl;
+#endif
+}
+
+ReplayTrace::~ReplayTrace() {
+    if (data != nullptr) {
+        munmap(const_cast<char*> (data), size);
+    }
+}
+
+uint32_t ReplayTrace::getColumn(std::string name) {
+    auto handle = columnNames.find(name);
+    if (handle == NameRegistry::invalidHandle) {
+        return UINT32_MAX;
+    }
+    return columnIndices[handle];
+}
+
+double ReplayTrace::getValue(uint32_t column) {
+    advance();
+    return currentRow[column];
+}
+
+bool ReplayTrace::isFinished() {
+    advance();
+    return finished;
+}
+
+uint64_t ReplayTrace::getRowsReplayed() {
+    return currentRowIndex + 1;
+}
+
+std::shared_ptr<VirtualClock> ReplayTrace::getClock() {
+    return clock;
+}
+
+void ReplayTrace::advance() {
+    //Maya prints its first row one interval after it starts, so that is when row 0 is replayed
+    auto intervals = clock->getTimeUS() / intervalUS;
+    auto targetRowIndex = (intervals > 0) ? intervals - 1 : 0;
+    while (currentRowIndex < targetRowIndex) {
+        if (!nextRowValid) {
+            //hold the last row; the Manager stops when it sees that the trace is finished
+            finished = true;
+            return;
+        }
+        std::swap(currentRow, nextRow);
+        currentRowIndex++;
+        nextRowValid = parseNextRow(nextRow);
+    }
+}
+
+bool ReplayTrace::parseNextRow(std::vector<double>& row) {
+    const char *begin, *end;
+    while (nextLine(begin, end)) {
+        //copied so that strtod stops at the end of the line even at the end of the mapping
+        lineBuffer.assign(begin, end);
+        row.clear();
+        const char* p = lineBuffer.c_str();
+        char* next;
+        bool isRow = true;
+        while (true) {
+            while (std::isspace((unsigned char) *p)) {
+                p++;
+            }
+            if (*p == '\0') {
+                break;
+            }
+            double value = std::strtod(p, &next);
+            if (next == p || (*next != '\0' && !std::isspace((unsigned char) *next))) {
+                isRow = false;
+                break;
+            }
+            row.push_back(value);
+            p = next;
+        }
+        if (isRow && row.size() == numColumns) {
+            releaseReplayedPages();
+            return true;
+        }
+#ifdef DEBUG
+        std::cout << "Skipping trace line: " << lineBuffer << std::endl;
+#endif
+    }
+    return false;
+}
+
+bool ReplayTrace::nextLine(const char*& begin, const char*& end) {
+    if (cursor >= size) {
+        return false;
+    }
+    begin = data + cursor;
+    auto newline = static_cast<const char*> (std::memchr(begin, '\n', size - cursor));
+    end = (newline != nullptr) ? newline : data + size;
+    cursor = (end - data) + 1;
+    if (end > begin && *(end - 1) == '\r') {
+        end--;
+    }
+    return true;
+}
+
+void ReplayTrace::releaseReplayedPages() {
+    if (cursor - released < releaseChunkBytes) {
+        return;
+    }
+    std::size_t pageSize = sysconf(_SC_PAGESIZE);
+    std::size_t releaseEnd = (std::min(cursor, size) / pageSize) * pageSize;
+    madvise(const_cast<char*> (data + released), releaseEnd - released, MADV_DONTNEED);
+    released = releaseEnd;
+}
+
+ReplaySensor::ReplaySensor(std::string name, std::shared_ptr<ReplayTrace> trace) :
+Sensor(name),
+trace(trace),
+column(trace->getColumn(name)) {
+    if (column == UINT32_MAX) {
+        std::cout << "The trace has no column named " << name << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    readFromSystem();
+}
+
+void ReplaySensor::readFromSystem() {
+    values[0] = trace->getValue(column);
+}
+
+ReplayInput::ReplayInput(std::string name, std::shared_ptr<ReplayTrace> trace, std::vector<double> allowed) :
+Input(name),
+trace(trace),
+column(trace->getColumn(name)),
+written(false) {
+    if (column == UINT32_MAX) {
+        std::cout << "The trace has no column named " << name << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    allowedValues = allowed;
+    updateMinMaxMid();
+    actualWriteValue = trace->getValue(column);
+    readFromSystem();
+}
+
+void ReplayInput::writeToSystem() {
+    written = true;
+}
+
+void ReplayInput::readFromSystem() {
+    values[0] = written ? actualWriteValue : trace->getValue(column);
+}
@@ -0,0 +1,155 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/*
+ * File:   Scheduler.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "Scheduler.h"
+#include "debug.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        auto r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+}
+
+uint64_t VirtualClock::getTimeUS() {
+    return timeUS.load();
+}
+
+void VirtualClock::setTimeUS(uint64_t newTimeUS) {
+    timeUS.store(newTimeUS);
+}
+
+void RateScheduler::useVirtualClock(std::shared_ptr<VirtualClock> clock_) {
+    clock = clock_;
+}
+
+uint32_t RateScheduler::addTask(uint32_t periodUS) {
+    if (periodUS == 0) {
+        std::cout << "Period of a task must be > 0" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    periodsUS.push_back(periodUS);
+    return periodsUS.size() - 1;
+}
+
+void RateScheduler::start() {
+    if (periodsUS.empty()) {
+        std::cout << "Nothing to schedule" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    baseTickUS = 0;
+    for (auto periodUS : periodsUS) {
+        baseTickUS = gcd(baseTickUS, periodUS);
+    }
+    ticksPerPeriod.clear();
+    for (auto periodUS : periodsUS) {
+        ticksPerPeriod.push_back(periodUS / baseTickUS);
+    }
+    nextDueTicks = std::vector<uint64_t>(periodsUS.size(), 0);
+    due = std::vector<bool>(periodsUS.size(), true);
+    tick = 0;
+    numOverruns = 0;
+    nextDeadline = Clock::now() + std::chrono::microseconds(baseTickUS);
+    if (clock) {
+        clock->setTimeUS(0);
+    }
+#ifdef DEBUG
+    std::cout << "Base tick is " << baseTickUS << " us for " << periodsUS.size() << " tasks" << std::endl;
+#endif
+}
+
+void RateScheduler::waitForNextTick() {
+    auto baseTick = std::chrono::microseconds(baseTickUS);
+    if (clock) {
+        clock->setTimeUS((tick + 1) * baseTickUS);
+    } else {
+        std::this_thread::sleep_until(nextDeadline);
+    }
+
+    auto now = Clock::now();
+    if (!clock && now >= nextDeadline + baseTick) {
+        //overran by at least one full tick; skip the ticks that were missed
+        uint64_t missed = (now - nextDeadline) / baseTick;
+        tick += missed;
+        nextDeadline += missed * baseTick;
+        numOverruns++;
+    }
+
+    for (uint32_t task = 0; task < periodsUS.size(); task++) {
+        due[task] = (tick >= nextDueTicks[task]);
+        if (due[task]) {
+            while (nextDueTicks[task] <= tick) {
+                nextDueTicks[task] += ticksPerPeriod[task];
+            }
+        }
+    }
+    tick++;
+    nextDeadline += baseTick;
+}
+
+bool RateScheduler::isDue(uint32_t task) const {
+    return due[task];
+}
+
+bool RateScheduler::isAnyDue(const std::vector<uint32_t>& tasks) const {
+    for (auto task : tasks) {
+        if (due[task]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<uint32_t> RateScheduler::getRateMonotonicOrder(const std::vector<uint32_t>& tasks) const {
+    std::vector<uint32_t> order(tasks.size());
+    for (uint32_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return periodsUS[tasks[a]] < periodsUS[tasks[b]];
+    });
+    return order;
+}
+
+uint32_t RateScheduler::getPeriodUS(uint32_t task) const {
+    return periodsUS[task];
+}
+
+uint32_t RateScheduler::getBaseTickUS() const {
+    return baseTickUS;
+}
+
+uint64_t RateScheduler::getNumOverruns() const {
+    return numOverruns;
+}
+
+uint64_t RateScheduler::getElapsedUS() const {
+    return tick * baseTickUS;
+}
@@ -19,6 +19,7 @@
 
 
 #include "Sensors.h"
+#include "Topology.h"
 #include "debug.h"
 #include <fstream>
 #include <iostream>
@@ -35,6 +36,7 @@
 #include <errno.h>
 #include <cstring>
 #include <dirent.h>
+#include <fcntl.h>
 #include <vector>
 
 Sensor::Sensor(std::string sname) :
@@ -65,6 +67,36 @@ std::string Sensor::getName() {
     return name;
 }
 
+void Sensor::setPeriodUS(uint32_t periodUS_) {
+    periodUS = periodUS_;
+}
+
+uint32_t Sensor::getPeriodUS() {
+    return periodUS;
+}
+
+void Sensor::setPackage(int package_) {
+    package = package_;
+}
+
+int Sensor::getPackage() {
+    return package;
+}
+
+std::string Sensor::systemRoot = "";
+
+void Sensor::setSystemRoot(std::string root) {
+    //drop trailing slashes so that the root can be put in front of absolute paths
+    while (root.size() > 1 && root.back() == '/') {
+        root.pop_back();
+    }
+    systemRoot = (root == "/") ? "" : root;
+}
+
+std::string Sensor::systemPath(std::string path) {
+    return systemRoot + path;
+}
+
 void Sensor::updateValuesFromSystem() {
     prevValues = values;
     readFromSystem();
@@ -100,13 +132,36 @@ void Time::readFromSystem() {
 #endif
 }
 
-CPUPowerSensor::CPUPowerSensor(std::string name) : Sensor(name),
+CPUPowerSensor::CPUPowerSensor(std::string name, int package_) : Sensor(name),
 energyCtr(0) {
     values[0] = 0.0;
+    package = package_;
+    findEnergyFiles();
+}
+
+CPUPowerSensor::CPUPowerSensor(std::string name, std::initializer_list<std::string> pNames, int package_) :
+Sensor(name, pNames),
+energyCtr(0) {
+    package = package_;
+    findEnergyFiles();
+}
+
+void CPUPowerSensor::findEnergyFiles() {
     std::string fileName;
     std::string raplName;
     std::ifstream raplFile;
 
+    if (package >= 0) {
+        //only the domains of this package
+        pkgEnergyDirName1 = raplDirName + std::to_string(package) + "/";
+        coreEnergyDirName = pkgEnergyDirName1 + "intel-rapl:" + std::to_string(package) + ":0/";
+        std::ifstream pkgFile(pkgEnergyDirName1 + energyFilePrefix);
+        if (!pkgFile) {
+            std::cout << "Sensor " << name << " has no RAPL domain for package " << package << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
     raplFile.open(coreEnergyDirName + "name");
     raplFile >> raplName;
     raplFile.close();
@@ -116,6 +171,11 @@ energyCtr(0) {
         energyFileNames.push_back(coreEnergyDirName + energyFilePrefix);
 #ifdef DEBUG
        	std::cout << "Pushing " << coreEnergyDirName+energyFilePrefix << std::endl;
+#endif
+    } else if (package >= 0) {
+        energyFileNames.push_back(pkgEnergyDirName1 + energyFilePrefix);
+#ifdef DEBUG
+        std::cout << "Pushing " << pkgEnergyDirName1+energyFilePrefix << std::endl;
 #endif
     } else {
         //we have rapl for each of the two packages
@@ -154,3 +214,150 @@ void CPUPowerSensor::readFromSystem() {
             deltaTime << " power is " << values[0] << std::endl;
 #endif
 }
+
+SampledCPUPowerSensor::SampledCPUPowerSensor(std::string name, std::string pinPrefix,
+        uint32_t smplIntUS, double filterCutoffHz, uint32_t ringCapacity, int package) :
+CPUPowerSensor(name,{pinPrefix, pinPrefix + "Peak", pinPrefix + "Var", pinPrefix + "LPF"}, package),
+sampleIntervalUS(smplIntUS),
+filteredPower(0.0),
+filterPrimed(false),
+samples(ringCapacity),
+stopSampling(false),
+overflowCount(0) {
+    if (name.compare(pinPrefix) == 0) {
+        std::cout << "Sensor " << name << " must have a port name different from its pin prefix" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    if (sampleIntervalUS == 0) {
+        std::cout << "Sampling interval for " << name << " must be > 0 us" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    //alpha for a first-order low pass filter applied once per sample
+    double dt = (double) sampleIntervalUS * 1e-6;
+    filterAlpha = 1.0 - std::exp(-2.0 * M_PI * filterCutoffHz * dt);
+
+    //keep the energy files open so that the sampler only needs a pread for each reading
+    for (auto& energyFileName : energyFileNames) {
+        int fd = open(energyFileName.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cout << "Unable to open " << energyFileName << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        energyFds.push_back(fd);
+
+        //the counters wrap around at max_energy_range_uj
+        double maxRange = 0.0;
+        auto rangeFileName = energyFileName;
+        rangeFileName.replace(rangeFileName.rfind(energyFilePrefix), energyFilePrefix.size(), "max_energy_range_uj");
+        std::ifstream rangeFile(rangeFileName);
+        rangeFile >> maxRange;
+        maxEnergyRanges.push_back(maxRange);
+        lastEnergyReadings.push_back(0.0);
+    }
+    readEnergy();
+
+    sampler = std::thread(&SampledCPUPowerSensor::sampleLoop, this);
+    if (package >= 0) {
+        //keep the reads of the counters local to the package
+        auto packageCPUs = getPackageCPUs();
+        if ((uint32_t) package < packageCPUs.size()) {
+            pinThreadToCPUs(sampler, packageCPUs[package]);
+        }
+    }
+}
+
+SampledCPUPowerSensor::~SampledCPUPowerSensor() {
+    stopSampling.store(true);
+    if (sampler.joinable()) {
+        sampler.join();
+    }
+    for (auto fd : energyFds) {
+        close(fd);
+    }
+}
+
+double SampledCPUPowerSensor::readEnergy() {
+    char buf[32];
+    double total = 0.0;
+    for (uint32_t i = 0; i < energyFds.size(); i++) {
+        auto len = pread(energyFds[i], buf, sizeof (buf) - 1, 0);
+        if (len <= 0) {
+            continue;
+        }
+        buf[len] = '\0';
+        double reading = std::strtod(buf, nullptr);
+        double delta = reading - lastEnergyReadings[i];
+        if (delta < 0 && maxEnergyRanges[i] > 0) {
+            delta += maxEnergyRanges[i];
+        }
+        lastEnergyReadings[i] = reading;
+        total += delta;
+    }
+    energyCtr += total;
+    return energyCtr;
+}
+
+void SampledCPUPowerSensor::sampleLoop() {
+    auto interval = MicroSec(sampleIntervalUS);
+    auto prevTime = Clock::now();
+    auto nextWakeup = prevTime + interval;
+    double prevEnergy = energyCtr;
+
+    while (!stopSampling.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_until(nextWakeup);
+        nextWakeup += interval;
+
+        double energy = readEnergy();
+        auto now = Clock::now();
+        auto deltaTime = std::chrono::duration_cast<MicroSec>(now - prevTime).count();
+        if (deltaTime <= 0) {
+            continue;
+        }
+        if (!samples.push((energy - prevEnergy) / (double) deltaTime)) {
+            overflowCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        prevEnergy = energy;
+        prevTime = now;
+    }
+}
+
+void SampledCPUPowerSensor::readFromSystem() {
+    double sample, peak = 0.0, mean = 0.0, m2 = 0.0;
+    uint64_t count = 0;
+
+    //drain everything sampled since the previous period (Welford's algorithm for the variance)
+    while (samples.pop(sample)) {
+        count++;
+        double delta = sample - mean;
+        mean += delta / (double) count;
+        m2 += delta * (sample - mean);
+        peak = (count == 1) ? sample : std::max(peak, sample);
+
+        if (!filterPrimed) {
+            filteredPower = sample;
+            filterPrimed = true;
+        } else {
+            filteredPower += filterAlpha * (sample - filteredPower);
+        }
+    }
+
+    sampleTime = Clock::now();
+    prevSampleTime = sampleTime;
+    if (count == 0) {
+        //nothing new was sampled; hold the previous values
+#ifdef DEBUG
+        std::cout << name << " has no new samples" << std::endl;
+#endif
+        return;
+    }
+    values[0] = mean;
+    values[1] = peak;
+    values[2] = m2 / (double) count;
+    values[3] = filteredPower;
+#ifdef DEBUG
+    std::cout << name << " drained " << count << " samples (" << overflowCount.load() <<
+            " dropped so far) mean " << values[0] << " peak " << values[1] << " var " <<
+            values[2] << " lpf " << values[3] << std::endl;
+#endif
+}
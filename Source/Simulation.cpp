@@ -0,0 +1,242 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/*
+ * File:   Simulation.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "Simulation.h"
+#include "debug.h"
+
+#include <fstream>
+#include <iostream>
+#include <cstdlib>
+
+ModelShape readModelShape(std::string fileNamePrefix, uint32_t maxSize) {
+    ModelShape shape;
+    shape.dimension = readModelCount(fileNamePrefix + "_dimension.txt", maxSize);
+    shape.numInputs = readModelCount(fileNamePrefix + "_numInputs.txt", maxSize);
+    shape.numOutputs = readModelCount(fileNamePrefix + "_numOutputs.txt", maxSize);
+    shape.inputNames = readModelNames(fileNamePrefix + "_inputNames.txt", shape.numInputs);
+    shape.outputNames = readModelNames(fileNamePrefix + "_outputNames.txt", shape.numOutputs);
+    return shape;
+}
+
+uint32_t readModelCount(std::string fileName, uint32_t maxCount) {
+    std::ifstream file(fileName);
+    if (!file) {
+        std::cerr << "Unable to open " << fileName << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    uint64_t count = 0;
+    file >> count;
+    if (count == 0 || count > maxCount) {
+        if (maxCount == UINT32_MAX) {
+            std::cout << fileName << " must be > 0" << std::endl;
+        } else {
+            std::cout << fileName << " must be between 1 and " << maxCount << std::endl;
+        }
+        std::exit(EXIT_FAILURE);
+    }
+    return count;
+}
+
+std::vector<std::string> readModelNames(std::string fileName, uint32_t numNames) {
+    std::ifstream file(fileName);
+    if (!file) {
+        std::cerr << "Unable to open " << fileName << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    std::vector<std::string> names;
+    std::string name;
+    while (file >> name) {
+        names.push_back(name);
+    }
+    if (names.size() != numNames) {
+        std::cout << fileName << " must have " << numNames << " names" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return names;
+}
+
+void readModelValues(double* values, std::string fileName, uint32_t rows, uint32_t cols, uint32_t stride) {
+    Vector v(fileName);
+    if (v.size() != rows * cols) {
+        std::cout << fileName << " must have " << rows * cols << " values" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    for (uint32_t r = 0; r < rows; r++) {
+        std::copy(v.begin() + r * cols, v.begin() + (r + 1) * cols, values + r * stride);
+    }
+}
+
+Vector readModelVector(std::string fileName, uint32_t size) {
+    Vector v(size);
+    readModelValues(&v[0], fileName, 1, size, size);
+    return v;
+}
+
+Matrix readModelMatrix(std::string fileName, uint32_t rows, uint32_t cols) {
+    Matrix m(rows, cols);
+    readModelValues(&m[0][0], fileName, rows, cols, cols);
+    return m;
+}
+
+PlantModel::PlantModel(std::string fileNamePrefix, std::shared_ptr<VirtualClock> clock) :
+clock(clock),
+lastStepTimeUS(0),
+noise(newRandomStream()) {
+    auto shape = readModelShape(fileNamePrefix);
+    auto dimension = shape.dimension, numInputs = shape.numInputs, numOutputs = shape.numOutputs;
+    inputNames = shape.inputNames;
+    outputNames = shape.outputNames;
+    periodUS = readModelCount(fileNamePrefix + "_periodUS.txt");
+
+    A = readModelMatrix(fileNamePrefix + "_A.txt", dimension, dimension);
+    B = readModelMatrix(fileNamePrefix + "_B.txt", dimension, numInputs);
+    C = readModelMatrix(fileNamePrefix + "_C.txt", numOutputs, dimension);
+    D = readModelMatrix(fileNamePrefix + "_D.txt", numOutputs, numInputs);
+
+    inputOffsets = readModelVector(fileNamePrefix + "_inputOffsets.txt", numInputs);
+    outputOffsets = readModelVector(fileNamePrefix + "_outputOffsets.txt", numOutputs);
+    inputMin = readModelVector(fileNamePrefix + "_inputMin.txt", numInputs);
+    inputMax = readModelVector(fileNamePrefix + "_inputMax.txt", numInputs);
+    inputLevels = readModelVector(fileNamePrefix + "_inputLevels.txt", numInputs);
+    noiseStddev = readModelVector(fileNamePrefix + "_noise.txt", numOutputs);
+    noiseSamples = Vector(numOutputs);
+
+    state = Vector(dimension);
+    inputs = inputOffsets;
+    outputs = outputOffsets;
+#ifdef DEBUG
+    std::cout << "Plant model " << fileNamePrefix << " with " << dimension << " states, " << numInputs <<
+            " inputs and " << numOutputs << " outputs, stepping every " << periodUS << " us" << std::endl;
+#endif
+}
+
+uint32_t PlantModel::getInputIndex(std::string name) {
+    for (uint32_t i = 0; i < inputNames.size(); i++) {
+        if (name.compare(inputNames[i]) == 0) {
+            return i;
+        }
+    }
+    return UINT32_MAX;
+}
+
+uint32_t PlantModel::getOutputIndex(std::string name) {
+    for (uint32_t i = 0; i < outputNames.size(); i++) {
+        if (name.compare(outputNames[i]) == 0) {
+            return i;
+        }
+    }
+    return UINT32_MAX;
+}
+
+std::vector<double> PlantModel::getAllowedInputValues(uint32_t index) {
+    std::vector<double> allowedValues;
+    uint32_t numLevels = inputLevels[index];
+    if (numLevels < 2) {
+        allowedValues.push_back(inputMin[index]);
+        return allowedValues;
+    }
+    for (uint32_t i = 0; i < numLevels; i++) {
+        allowedValues.push_back(inputMin[index] + (inputMax[index] - inputMin[index]) * i / (numLevels - 1));
+    }
+    return allowedValues;
+}
+
+void PlantModel::setInput(uint32_t index, double value) {
+    //the new value applies from the next step of the model
+    advance();
+    inputs[index] = value;
+}
+
+double PlantModel::getInput(uint32_t index) {
+    return inputs[index];
+}
+
+double PlantModel::getOutput(uint32_t index) {
+    advance();
+    return outputs[index];
+}
+
+std::shared_ptr<VirtualClock> PlantModel::getClock() {
+    return clock;
+}
+
+void PlantModel::advance() {
+    auto nowUS = clock->getTimeUS();
+    while (lastStepTimeUS + periodUS <= nowUS) {
+        step();
+        lastStepTimeUS += periodUS;
+    }
+}
+
+void PlantModel::step() {
+    auto deltaInputs = inputs - inputOffsets;
+    state = A * state + B * deltaInputs;
+    outputs = C * state + D * deltaInputs + outputOffsets;
+    noise.fillNormal(&noiseSamples[0], noiseSamples.size());
+    for (uint32_t i = 0; i < outputs.size(); i++) {
+        outputs[i] += noiseStddev[i] * noiseSamples[i];
+    }
+}
+
+SimulatedTime::SimulatedTime(std::string name, std::shared_ptr<VirtualClock> clock) :
+Sensor(name),
+clock(clock) {
+    readFromSystem();
+}
+
+void SimulatedTime::readFromSystem() {
+    values[0] = clock->getTimeUS() * 1e-6;
+}
+
+SimulatedSensor::SimulatedSensor(std::string name, std::shared_ptr<PlantModel> plant) :
+Sensor(name),
+plant(plant),
+outputIndex(plant->getOutputIndex(name)) {
+    if (outputIndex == UINT32_MAX) {
+        std::cout << "The plant model has no output named " << name << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    readFromSystem();
+}
+
+void SimulatedSensor::readFromSystem() {
+    values[0] = plant->getOutput(outputIndex);
+}
+
+SimulatedInput::SimulatedInput(std::string name, std::shared_ptr<PlantModel> plant) :
+Input(name),
+plant(plant),
+inputIndex(plant->getInputIndex(name)) {
+    if (inputIndex == UINT32_MAX) {
+        std::cout << "The plant model has no input named " << name << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    allowedValues = plant->getAllowedInputValues(inputIndex);
+    updateMinMaxMid();
+    actualWriteValue = plant->getInput(inputIndex);
+    readFromSystem();
+}
+
+void SimulatedInput::writeToSystem() {
+    plant->setInput(inputIndex, actualWriteValue);
+}
+
+void SimulatedInput::readFromSystem() {
+    values[0] = plant->getInput(inputIndex);
+}
@@ -0,0 +1,289 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   SystemId.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "SystemId.h"
+#include "MathSupport.h"
+#include "debug.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+
+const double initialCovariance = 1e4; //large: the first periods move the parameters freely
+const uint32_t warmupFactor = 10; //periods per regressor before the fit is counted
+
+void writeRows(std::string fileName, const std::vector<std::vector<double>>& rows) {
+    std::ofstream file(fileName);
+    if (!file) {
+        std::cerr << "Unable to open " << fileName << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    file << std::setprecision(10);
+    for (auto& row : rows) {
+        for (uint32_t i = 0; i < row.size(); i++) {
+            file << (i > 0 ? " " : "") << row[i];
+        }
+        file << std::endl;
+    }
+}
+
+template <typename T>
+void writeRow(std::string fileName, const std::vector<T>& row) {
+    std::ofstream file(fileName);
+    if (!file) {
+        std::cerr << "Unable to open " << fileName << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    file << std::setprecision(10);
+    for (uint32_t i = 0; i < row.size(); i++) {
+        file << (i > 0 ? " " : "") << row[i];
+    }
+    file << std::endl;
+}
+
+}
+
+SystemIdentifier::SystemIdentifier(std::vector<std::string> outputNames, std::vector<std::string> inputNames,
+        std::vector<double> inputMinVals, std::vector<double> inputMaxVals, std::vector<uint32_t> inputLevels,
+        uint32_t periodUS, uint32_t na, uint32_t nb, double forgetting) :
+outputVals(std::make_shared<InputPort>("outputVals")),
+inputVals(std::make_shared<InputPort>("inputVals")),
+numOutputs(outputNames.size()),
+numInputs(inputNames.size()),
+na(na),
+nb(nb),
+outputNames(outputNames),
+inputNames(inputNames),
+inputMinVals(inputMinVals),
+inputMaxVals(inputMaxVals),
+inputLevels(inputLevels),
+periodUS(periodUS),
+forgetting(forgetting),
+numUpdates(0),
+numSamples(0) {
+    if (numOutputs == 0 || numInputs == 0) {
+        std::cout << "System identification needs at least one output and one input" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    //the state of the written model starts with the na last outputs, so C needs na >= 1
+    if (na == 0 || na > maxSystemIdLags || nb == 0 || nb > maxSystemIdLags) {
+        std::cout << "System identification needs 1 <= na <= " << maxSystemIdLags << " and 1 <= nb <= " <<
+                maxSystemIdLags << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    if (forgetting <= 0.0 || forgetting > 1.0) {
+        std::cout << "The forgetting factor of system identification must be in (0, 1]" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    for (uint32_t j = 0; j < numInputs; j++) {
+        inputMids.push_back((inputMinVals[j] + inputMaxVals[j]) / 2.0);
+        inputHalfRanges.push_back((inputMaxVals[j] > inputMinVals[j]) ? (inputMaxVals[j] - inputMinVals[j]) / 2.0 : 1.0);
+    }
+    outputVals->addPin(outputNames);
+    inputVals->addPin(inputNames);
+
+    numRegressors = na * numOutputs + nb * numInputs + 1;
+    P.assign(numRegressors * numRegressors, 0.0);
+    for (uint32_t r = 0; r < numRegressors; r++) {
+        P[r * numRegressors + r] = initialCovariance;
+    }
+    theta.assign(numOutputs * numRegressors, 0.0);
+    regressor.assign(numRegressors, 0.0);
+    gain.assign(numRegressors, 0.0);
+    Pphi.assign(numRegressors, 0.0);
+    pastOutputs.assign(na * numOutputs, 0.0);
+    pastInputs.assign(nb * numInputs, 0.0);
+    outputs.assign(numOutputs, 0.0);
+    inputs.assign(numInputs, 0.0);
+    sumErrors2.assign(numOutputs, 0.0);
+    sumOutputs.assign(numOutputs, 0.0);
+    sumOutputs2.assign(numOutputs, 0.0);
+#ifdef DEBUG
+    std::cout << "Identifying an ARX model with " << na << " output and " << nb << " input lags, " <<
+            numRegressors << " regressors" << std::endl;
+#endif
+}
+
+void SystemIdentifier::update() {
+    outputVals->updateValuesFromPort(outputs.data());
+    inputVals->updateValuesFromPort(inputs.data());
+    numSamples++;
+    std::copy_backward(pastInputs.begin(), pastInputs.end() - numInputs, pastInputs.end());
+    for (uint32_t j = 0; j < numInputs; j++) {
+        pastInputs[j] = (inputs[j] - inputMids[j]) / inputHalfRanges[j];
+    }
+
+    //the regressor needs na earlier outputs and nb inputs
+    if (numSamples > na && numSamples >= nb) {
+        auto n = numRegressors;
+        std::copy(pastOutputs.begin(), pastOutputs.end(), regressor.begin());
+        std::copy(pastInputs.begin(), pastInputs.end(), regressor.begin() + na * numOutputs);
+        regressor[n - 1] = 1.0;
+
+        double denominator = forgetting;
+        for (uint32_t r = 0; r < n; r++) {
+            double sum = 0.0;
+            for (uint32_t c = 0; c < n; c++) {
+                sum += P[r * n + c] * regressor[c];
+            }
+            Pphi[r] = sum;
+            denominator += regressor[r] * sum;
+        }
+        for (uint32_t r = 0; r < n; r++) {
+            gain[r] = Pphi[r] / denominator;
+        }
+        bool counted = numUpdates >= (uint64_t) warmupFactor * n;
+        for (uint32_t o = 0; o < numOutputs; o++) {
+            auto parameters = &theta[o * n];
+            double error = outputs[o];
+            for (uint32_t r = 0; r < n; r++) {
+                error -= parameters[r] * regressor[r];
+            }
+            for (uint32_t r = 0; r < n; r++) {
+                parameters[r] += gain[r] * error;
+            }
+            if (counted) {
+                sumErrors2[o] += error * error;
+                sumOutputs[o] += outputs[o];
+                sumOutputs2[o] += outputs[o] * outputs[o];
+            }
+        }
+        //P = (P - gain Pphi') / forgetting, a rank-1 update
+        for (uint32_t r = 0; r < n; r++) {
+            for (uint32_t c = 0; c < n; c++) {
+                P[r * n + c] = (P[r * n + c] - gain[r] * Pphi[c]) / forgetting;
+            }
+        }
+        numUpdates++;
+    }
+
+    std::copy_backward(pastOutputs.begin(), pastOutputs.end() - numOutputs, pastOutputs.end());
+    std::copy(outputs.begin(), outputs.end(), pastOutputs.begin());
+}
+
+uint64_t SystemIdentifier::getNumSamples() {
+    return numSamples;
+}
+
+double SystemIdentifier::getFit(uint32_t output) {
+    auto count = numUpdates - std::min(numUpdates, (uint64_t) warmupFactor * numRegressors);
+    if (count < 2) {
+        return 0.0;
+    }
+    auto mean = sumOutputs[output] / count;
+    auto variation = sumOutputs2[output] - count * mean * mean;
+    if (variation <= 0.0) {
+        return 0.0;
+    }
+    return 100.0 * (1.0 - std::sqrt(sumErrors2[output] / variation));
+}
+
+void SystemIdentifier::report(std::ostream& out) {
+    auto count = numUpdates - std::min(numUpdates, (uint64_t) warmupFactor * numRegressors);
+    out << "Sysid: ARX model with na " << na << ", nb " << nb << " from " << numUpdates << " periods" << std::endl;
+    for (uint32_t o = 0; o < numOutputs; o++) {
+        out << "Sysid fit of " << outputNames[o] << ": " << std::setprecision(1) << std::fixed << getFit(o) <<
+                "% one step ahead, residual stddev " << std::setprecision(3) <<
+                ((count > 0) ? std::sqrt(sumErrors2[o] / count) : 0.0) << std::endl;
+    }
+}
+
+bool SystemIdentifier::writeModel(std::string fileNamePrefix) {
+    auto n = numRegressors, p = numOutputs, m = numInputs;
+    auto dimension = na * p + (nb - 1) * m;
+
+    //y0 = (I - A1 - ... - Ana)^-1 c, the outputs at the middle of the input ranges
+    Matrix IminusA(p, p);
+    Vector c(p);
+    for (uint32_t o = 0; o < p; o++) {
+        IminusA[o][o] = 1.0;
+        for (uint32_t i = 0; i < na; i++) {
+            for (uint32_t q = 0; q < p; q++) {
+                IminusA[o][q] -= theta[o * n + i * p + q];
+            }
+        }
+        c[o] = theta[o * n + n - 1];
+    }
+    auto inv = inverse(IminusA);
+    if (inv.row() == 0) {
+        std::cerr << "Sysid: the model has an integrator (I - sum of A is singular); not writing it" << std::endl;
+        return false;
+    }
+    auto outputOffsets = inv * c;
+
+    //state: y[k]..y[k-na+1], u[k]..u[k-nb+2], relative to y0 and u0; x[k] = A x[k-1] + B (u[k] - u0)
+    std::vector<std::vector<double>> A(dimension, std::vector<double>(dimension, 0.0));
+    std::vector<std::vector<double>> B(dimension, std::vector<double>(m, 0.0));
+    std::vector<std::vector<double>> C(p, std::vector<double>(dimension, 0.0));
+    std::vector<std::vector<double>> D(p, std::vector<double>(m, 0.0));
+    auto inputStates = na * p;
+    for (uint32_t o = 0; o < p; o++) {
+        auto parameters = &theta[o * n];
+        for (uint32_t i = 0; i < na * p; i++) {
+            A[o][i] = parameters[i];
+        }
+        for (uint32_t j = 0; j < m; j++) {
+            B[o][j] = parameters[na * p + j] / inputHalfRanges[j];
+            for (uint32_t i = 1; i < nb; i++) {
+                A[o][inputStates + (i - 1) * m + j] = parameters[na * p + i * m + j] / inputHalfRanges[j];
+            }
+        }
+        C[o][o] = 1.0;
+    }
+    for (uint32_t r = p; r < na * p; r++) {
+        A[r][r - p] = 1.0;
+    }
+    if (nb > 1) {
+        for (uint32_t j = 0; j < m; j++) {
+            B[inputStates + j][j] = 1.0;
+        }
+        for (uint32_t r = inputStates + m; r < dimension; r++) {
+            A[r][r - m] = 1.0;
+        }
+    }
+
+    std::vector<double> noise(p);
+    auto count = numUpdates - std::min(numUpdates, (uint64_t) warmupFactor * numRegressors);
+    for (uint32_t o = 0; o < p; o++) {
+        noise[o] = (count > 0) ? std::sqrt(sumErrors2[o] / count) : 0.0;
+    }
+    std::vector<double> offsets(outputOffsets.begin(), outputOffsets.end());
+    writeRow(fileNamePrefix + "_dimension.txt", std::vector<uint32_t>{dimension});
+    writeRow(fileNamePrefix + "_numInputs.txt", std::vector<uint32_t>{m});
+    writeRow(fileNamePrefix + "_numOutputs.txt", std::vector<uint32_t>{p});
+    writeRows(fileNamePrefix + "_A.txt", A);
+    writeRows(fileNamePrefix + "_B.txt", B);
+    writeRows(fileNamePrefix + "_C.txt", C);
+    writeRows(fileNamePrefix + "_D.txt", D);
+    writeRow(fileNamePrefix + "_periodUS.txt", std::vector<uint32_t>{periodUS});
+    writeRow(fileNamePrefix + "_inputNames.txt", inputNames);
+    writeRow(fileNamePrefix + "_outputNames.txt", outputNames);
+    writeRow(fileNamePrefix + "_inputOffsets.txt", inputMids);
+    writeRow(fileNamePrefix + "_outputOffsets.txt", offsets);
+    writeRow(fileNamePrefix + "_inputMin.txt", inputMinVals);
+    writeRow(fileNamePrefix + "_inputMax.txt", inputMaxVals);
+    writeRow(fileNamePrefix + "_inputLevels.txt", inputLevels);
+    writeRow(fileNamePrefix + "_noise.txt", noise);
+    std::cerr << "Sysid: wrote the model to " << fileNamePrefix << "_*.txt" << std::endl;
+    return true;
+}
@@ -0,0 +1,99 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   Topology.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "Topology.h"
+#include "Sensors.h"
+#include "debug.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <map>
+#include <pthread.h>
+#include <sched.h>
+
+std::vector<uint32_t> parseCPUList(std::string list) {
+    std::vector<uint32_t> cpus;
+    std::istringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        try {
+            auto delimPos = range.find("-");
+            uint32_t first = std::stoul(range.substr(0, delimPos));
+            uint32_t last = (delimPos == std::string::npos) ? first : std::stoul(range.substr(delimPos + 1));
+            for (auto cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        } catch (...) {
+            std::cout << "Invalid CPU list " << list << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    return cpus;
+}
+
+std::vector<std::vector<uint32_t>> getPackageCPUs() {
+    std::string presentList;
+    std::ifstream presentFile(Sensor::systemPath("/sys/devices/system/cpu/present"));
+    presentFile >> presentList;
+    auto cpus = parseCPUList(presentList.empty() ? "0" : presentList);
+
+    //package id -> CPUs; a CPU without a readable id is in the first package
+    std::map<uint32_t, std::vector<uint32_t>> cpusOfId;
+    for (auto cpu : cpus) {
+        uint32_t packageId = 0;
+        std::ifstream idFile(Sensor::systemPath("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                "/topology/physical_package_id"));
+        idFile >> packageId;
+        cpusOfId[packageId].push_back(cpu);
+    }
+    std::vector<std::vector<uint32_t>> packageCPUs;
+    for (auto& package : cpusOfId) {
+        packageCPUs.push_back(package.second);
+    }
+#ifdef DEBUG
+    for (uint32_t p = 0; p < packageCPUs.size(); p++) {
+        std::cout << "Package " << p << " has " << packageCPUs[p].size() << " CPUs" << std::endl;
+    }
+#endif
+    return packageCPUs;
+}
+
+uint32_t getNumPackages() {
+    return getPackageCPUs().size();
+}
+
+bool pinThreadToCPUs(std::thread& thread, const std::vector<uint32_t>& cpus) {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (auto cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+    auto result = pthread_setaffinity_np(thread.native_handle(), sizeof (cpuSet), &cpuSet);
+#ifdef DEBUG
+    if (result != 0) {
+        std::cout << "Unable to pin a thread to " << cpus.size() << " CPUs" << std::endl;
+    }
+#endif
+    return result == 0;
+}
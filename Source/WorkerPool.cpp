@@ -0,0 +1,141 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License 
+ * (the "License"). You may not use this file except in compliance with the License. 
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+ * See the License for the specific language governing permissions and limitations 
+ * under the License. 
+ * ================================================================================
+ */
+
+/* 
+ * File:   WorkerPool.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+#include "WorkerPool.h"
+#include "Topology.h"
+#include "debug.h"
+#include <iostream>
+
+WorkerPool::WorkerPool(uint32_t numWorkers, std::vector<std::vector<uint32_t>> workerCPUs) :
+pendingTasks(0),
+batchNum(0),
+stopping(false) {
+    for (uint32_t i = 0; i <= numWorkers; i++) {
+        queues.push_back(std::make_unique<TaskQueue>());
+    }
+    for (uint32_t i = 0; i < numWorkers; i++) {
+        workers.push_back(std::thread(&WorkerPool::workerLoop, this, i));
+        if (i < workerCPUs.size() && !workerCPUs[i].empty()) {
+            pinThreadToCPUs(workers.back(), workerCPUs[i]);
+        }
+    }
+#ifdef DEBUG
+    std::cout << "Created worker pool with " << numWorkers << " workers" << std::endl;
+#endif
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(wakeupLock);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+uint32_t WorkerPool::getNumWorkers() {
+    return workers.size();
+}
+
+void WorkerPool::runAll(std::vector<std::function<void()>>& tasks) {
+    runAll(tasks, std::vector<uint32_t>());
+}
+
+void WorkerPool::runAll(std::vector<std::function<void()>>& tasks, const std::vector<uint32_t>& workerIds) {
+    if (tasks.empty()) {
+        return;
+    }
+    //spread the tasks round-robin; stealing balances whatever is left uneven
+    pendingTasks.store(tasks.size());
+    uint32_t numSpread = 0;
+    for (uint32_t i = 0; i < tasks.size(); i++) {
+        auto workerId = (i < workerIds.size()) ? workerIds[i] : anyWorker;
+        if (workerId < workers.size()) {
+            auto& queue = queues[workerId];
+            std::lock_guard<std::mutex> lock(queue->lock);
+            queue->pinnedTasks.push_back(&tasks[i]);
+            continue;
+        }
+        auto& queue = queues[numSpread++ % queues.size()];
+        std::lock_guard<std::mutex> lock(queue->lock);
+        queue->tasks.push_back(&tasks[i]);
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeupLock);
+        batchNum++;
+    }
+    wakeup.notify_all();
+
+    //the calling thread works too, and then waits for tasks still running elsewhere
+    auto callerQueueId = queues.size() - 1;
+    while (pendingTasks.load() > 0) {
+        if (!runOneTask(callerQueueId)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool WorkerPool::runOneTask(uint32_t queueId) {
+    std::function<void()>* task = nullptr;
+    {
+        auto& queue = queues[queueId];
+        std::lock_guard<std::mutex> lock(queue->lock);
+        if (!queue->pinnedTasks.empty()) {
+            task = queue->pinnedTasks.front();
+            queue->pinnedTasks.pop_front();
+        } else if (!queue->tasks.empty()) {
+            task = queue->tasks.back();
+            queue->tasks.pop_back();
+        }
+    }
+    for (uint32_t i = 1; task == nullptr && i < queues.size(); i++) {
+        auto& victim = queues[(queueId + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim->lock);
+        if (!victim->tasks.empty()) {
+            task = victim->tasks.front();
+            victim->tasks.pop_front();
+        }
+    }
+    if (task == nullptr) {
+        return false;
+    }
+    (*task)();
+    pendingTasks.fetch_sub(1);
+    return true;
+}
+
+void WorkerPool::workerLoop(uint32_t queueId) {
+    uint64_t seenBatchNum = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wakeupLock);
+            wakeup.wait(lock, [&] {
+                return stopping || batchNum != seenBatchNum;
+            });
+            if (stopping) {
+                return;
+            }
+            seenBatchNum = batchNum;
+        }
+        while (runOneTask(queueId)) {
+        }
+    }
+}
@@ -21,12 +21,17 @@
 #include "Abstractions.h"
 #include "Sensors.h"
 #include "Manager.h"
+#include "Config.h"
 #include "debug.h"
+#include "Random.h"
+#include "Topology.h"
 #include <iostream>
 #include <vector>
 #include <map>
-#include <sys/time.h>
 #include <sstream>
+#include <random>
+#include <climits>
+#include <unistd.h>
 
 std::map<std::string, std::string> parseArgs(int argc, char **argv) {
     std::map<std::string, std::string> args;
@@ -63,74 +68,52 @@ std::map<std::string, std::string> parseArgs(int argc, char **argv) {
     }
     if (error) {
         std::cout << "Usage: " << argv[0] <<
-                " --mode <Mode> [--idips <Sysid inputs>][--mask <mask name> --ctldir <dir> --ctlfile <fileprefix>]"
+                " [--config <config file>] --mode <Mode> [--idips <Sysid inputs>][--mask <mask name> --ctldir <dir> --ctlfile <fileprefix>]"
+                " [--psample <power sampling interval in us>] [--exec <Serial|Pipelined>]"
+                " [--workers <threads for planners and controllers>]"
+                " [--backend <System|Simulate|Replay> --plant <plant file prefix> --trace <trace file>]"
+                " [--duration <seconds>] [--sysroot <root of a fake sysfs tree>] [--seed <random seed>]"
+                " [--packages <auto|number of packages>]"
                 << std::endl;
         std::exit(EXIT_FAILURE);
     }
     return args;
 }
 
-Mode getMode(std::map<std::string, std::string> args) {
-    if (args.find("mode") == args.end()) {
-        std::cout << "No --mode specified. --mode should be one of Baseline, Sysid, Mask" << std::endl;
+Mode getMode(std::map<std::string, std::string> args, ConfigSection* managerSection) {
+    std::string modeName;
+    if (args.find("mode") != args.end()) {
+        modeName = args["mode"];
+    } else if (managerSection != nullptr && managerSection->has("mode")) {
+        modeName = managerSection->getString("mode");
+    } else {
+        std::cout << "No --mode specified. --mode should be one of Baseline, Sysid, Mask, Calibrate" << std::endl;
         std::exit(EXIT_FAILURE);
     }
-
-    std::string modeName = args["mode"];
 #ifdef DEBUG
     std::cout << "Mode is " << modeName << std::endl;
 #endif
-    if (modeName.compare("Baseline") == 0) {
-        return Mode::Baseline;
-    } else if (modeName.compare("Sysid") == 0) {
-        return Mode::Sysid;
-    } else if (modeName.compare("Mask") == 0) {
-        return Mode::Mask;
-    } else {
-        std::cout << "Mode " << modeName << " is invalid. It should be one of Baseline, Sysid, Mask" << std::endl;
-        std::exit(EXIT_FAILURE);
-    }
+    return getModeFromName(modeName);
 }
 
-std::vector<std::string> getSysidNames(std::map<std::string, std::string> args) {
+std::string getSysidNames(std::map<std::string, std::string> args) {
     if (args.find("idips") == args.end()) {
         std::cout << "No --idips specified. --idips should have a list of input names" << std::endl;
         std::exit(EXIT_FAILURE);
     }
-    std::istringstream idips(args["idips"]);
-    std::string idip;
-    std::vector<std::string> idNames;
-    while (idips >> idip) {
-        idNames.push_back(idip);
-    }
-    return idNames;
+    return args["idips"];
 }
 
-MaskGenType getMaskType(std::map<std::string, std::string> args) {
+std::string getMaskName(std::map<std::string, std::string> args) {
     if (args.find("mask") == args.end()) {
-        std::cout << "No --mask specified. --mask should be one of Constant, Uniform, Gauss, GaussSine, Sine, Preset" << std::endl;
+        std::cout << "No --mask specified. --mask should be one of Constant, Uniform, Gauss, GaussSine, Sine, "
+                "Pink, BandNoise, MultiTone, Markov, Preset" << std::endl;
         std::exit(EXIT_FAILURE);
     }
-    std::string maskName(args["mask"]);
 #ifdef DEBUG
-    std::cout << "Mask type is " << maskName << std::endl;
+    std::cout << "Mask type is " << args["mask"] << std::endl;
 #endif
-    if (maskName.compare("Constant") == 0) {
-        return MaskGenType::Constant;
-    } else if (maskName.compare("Uniform") == 0) {
-        return MaskGenType::Uniform;
-    } else if (maskName.compare("Gauss") == 0) {
-        return MaskGenType::Gauss;
-    } else if (maskName.compare("GaussSine") == 0) {
-        return MaskGenType::GaussSine;
-    } else if (maskName.compare("Sine") == 0) {
-        return MaskGenType::Sine;
-    } else if (maskName.compare("Preset") == 0) {
-        return MaskGenType::Preset;
-    } else {
-        std::cout << "Mask name " << maskName << " is invalid. It should be one of Constant, Uniform, Gauss, GaussSine, Sine, Preset" << std::endl;
-        std::exit(EXIT_FAILURE);
-    }
+    return args["mask"];
 }
 
 std::string getCtlDir(std::map<std::string, std::string> args) {
@@ -154,56 +137,278 @@ std::string getCtlFilePrefix(std::map<std::string, std::string> args) {
 #endif
     return args["ctlfile"];
 }
+
+ExecMode getExecMode(std::map<std::string, std::string> args, ConfigSection* managerSection) {
+    std::string execName = "Serial";
+    if (args.find("exec") != args.end()) {
+        execName = args["exec"];
+    } else if (managerSection != nullptr) {
+        execName = managerSection->getString("exec", execName);
+    }
+#ifdef DEBUG
+    std::cout << "Execution mode is " << execName << std::endl;
+#endif
+    return getExecModeFromName(execName);
+}
+
+//returns 0 if planners and controllers should run on the main thread
+uint32_t getNumWorkers(std::map<std::string, std::string> args, ConfigSection* managerSection) {
+    uint32_t numWorkers = 0;
+    if (args.find("workers") != args.end()) {
+        numWorkers = std::stoul(args["workers"]);
+    } else if (managerSection != nullptr) {
+        numWorkers = managerSection->getUInt("workers", numWorkers);
+    }
+#ifdef DEBUG
+    std::cout << "number of workers is " << numWorkers << std::endl;
+#endif
+    return numWorkers;
+}
+
+//A command line option if it is given, else the value in the [manager] section of the config
+std::string getSetting(std::map<std::string, std::string> args, std::string argName,
+        ConfigSection* managerSection, std::string key, std::string defaultValue) {
+    if (args.find(argName) != args.end()) {
+        return args[argName];
+    }
+    if (managerSection != nullptr) {
+        return managerSection->getString(key, defaultValue);
+    }
+    return defaultValue;
+}
+
+Backend getBackend(std::map<std::string, std::string> args, ConfigSection* managerSection) {
+    auto backendName = getSetting(args, "backend", managerSection, "backend", "System");
+#ifdef DEBUG
+    std::cout << "Backend is " << backendName << std::endl;
+#endif
+    return getBackendFromName(backendName);
+}
+
+std::string getPlantFilePrefix(std::map<std::string, std::string> args, ConfigSection* managerSection) {
+    auto prefix = getSetting(args, "plant", managerSection, "plant", "");
+    if (prefix.empty()) {
+        std::cout << "No --plant specified. The Simulate backend needs the prefix of the plant model files" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return prefix;
+}
+
+std::string getTraceFileName(std::map<std::string, std::string> args, ConfigSection* managerSection) {
+    auto fileName = getSetting(args, "trace", managerSection, "trace", "");
+    if (fileName.empty()) {
+        std::cout << "No --trace specified. The Replay backend needs a log recorded by Maya" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return fileName;
+}
+
+//returns 0 if Maya should run until it is stopped
+uint64_t getRunDurationUS(std::map<std::string, std::string> args, ConfigSection* managerSection, double defaultDurationS) {
+    auto duration = getSetting(args, "duration", managerSection, "durationS", std::to_string(defaultDurationS));
+    return (uint64_t) (std::stod(duration) * 1e6);
+}
+
+//empty to use the real /sys and /dev
+std::string getSystemRoot(std::map<std::string, std::string> args, ConfigSection* managerSection) {
+    auto root = getSetting(args, "sysroot", managerSection, "sysroot", "");
+#ifdef DEBUG
+    std::cout << "System root is " << (root.empty() ? "/" : root) << std::endl;
+#endif
+    return root;
+}
+
+//The seed of every random stream (masks, sysid, plant noise). Without one, a run on the 
+//system is seeded from the system, and simulated and replayed runs use a fixed seed 
+//so that they are reproducible.
+uint64_t getSeed(std::map<std::string, std::string> args, ConfigSection* managerSection, Backend backend) {
+    std::string defaultSeed = "1";
+    if (backend == Backend::System) {
+        std::random_device randomDevice;
+        defaultSeed = std::to_string(randomDevice());
+    }
+    uint64_t seed = std::stoull(getSetting(args, "seed", managerSection, "seed", defaultSeed));
+#ifdef DEBUG
+    std::cout << "Random seed is " << seed << std::endl;
+#endif
+    return seed;
+}
+
+//The number of packages that perPackage blocks are replicated for. auto reads the topology 
+//of the system; a simulated or replayed run has no system, so it has 1 package unless it is given.
+uint32_t getNumPackages(std::map<std::string, std::string> args, ConfigSection* managerSection, Backend backend) {
+    auto packages = getSetting(args, "packages", managerSection, "packages", "auto");
+    uint32_t numPackages = 1;
+    if (packages.compare("auto") == 0) {
+        numPackages = (backend == Backend::System) ? getNumPackages() : 1;
+    } else {
+        try {
+            numPackages = std::stoul(packages);
+        } catch (...) {
+            numPackages = 0;
+        }
+        if (numPackages == 0) {
+            std::cout << "packages must be auto or a number > 0" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+#ifdef DEBUG
+    std::cout << "Number of packages is " << numPackages << std::endl;
+#endif
+    return numPackages;
+}
+
+//returns 0 if the power sensor should not be oversampled
+uint32_t getPowerSampleInterval(std::map<std::string, std::string> args) {
+    if (args.find("psample") == args.end()) {
+        return 0;
+    }
+    uint32_t intervalUS = std::stoul(args["psample"]);
+#ifdef DEBUG
+    std::cout << "power sampling interval is " << intervalUS << " us" << std::endl;
+#endif
+    return intervalUS;
+}
     
-const uint32_t samplingIntervalMS = 20; //20 is default
+//Apply the command line options that change the blocks declared in the config
+void applyArgsToConfig(std::map<std::string, std::string> args, Config& config, Mode mode, Backend backend) {
+    auto powerSampleIntervalUS = getPowerSampleInterval(args);
+    //a simulated plant only has the mean power
+    if (powerSampleIntervalUS > 0 && backend == Backend::System) {
+        //the mean power is still available as a pin with the name of the power sensor
+        for (auto section : config.getSections("sensor")) {
+            if (section->getString("type").compare("CPUPower") == 0) {
+                section->set("type", "SampledCPUPower");
+                section->set("pinPrefix", section->getName());
+                section->set("sampleIntervalUS", std::to_string(powerSampleIntervalUS));
+                section->rename(section->getName() + "Stats");
+            }
+        }
+    }
 
-//Usage: ./maya --mode <Mode> [--idips <Sysid inputs>][--mask <mask name> --ctldir <dir> --ctlfile <file prefix>]
+    if (mode == Mode::Sysid) {
+        auto section = config.getSection("sysid");
+        if (section == nullptr) {
+            section = &config.addSection("sysid");
+        }
+        if (args.find("idips") != args.end() || !section->has("inputs")) {
+            section->set("inputs", getSysidNames(args));
+        }
+    } else if (mode == Mode::Calibrate) {
+        //the scales are for the first controller, with its inputs in its order, unless the options say otherwise
+        auto section = config.getSection("calibrate");
+        if (section == nullptr) {
+            section = &config.addSection("calibrate");
+        }
+        auto controllers = config.getSections("controller");
+        ConfigSection* controller = controllers.empty() ? nullptr : controllers[0];
+        if (args.find("idips") != args.end()) {
+            section->set("inputs", getSysidNames(args));
+        } else if (!section->has("inputs")) {
+            section->set("inputs", (controller != nullptr && controller->has("inputs")) ?
+                    controller->getString("inputs") : getSysidNames(args));
+        }
+        if (args.find("ctldir") != args.end() || !section->has("dir")) {
+            section->set("dir", (args.find("ctldir") == args.end() && controller != nullptr && controller->has("dir")) ?
+                    controller->getString("dir") : getCtlDir(args));
+        }
+        if (args.find("ctlfile") != args.end() || !section->has("file")) {
+            section->set("file", (args.find("ctlfile") == args.end() && controller != nullptr && controller->has("file")) ?
+                    controller->getString("file") : getCtlFilePrefix(args));
+        }
+    } else if (mode == Mode::Mask) {
+        for (auto section : config.getSections("controller")) {
+            if (args.find("ctldir") != args.end() || !section->has("dir")) {
+                section->set("dir", getCtlDir(args));
+            }
+            if (args.find("ctlfile") != args.end() || !section->has("file")) {
+                section->set("file", getCtlFilePrefix(args));
+            }
+        }
+        for (auto section : config.getSections("planner")) {
+            if (args.find("mask") != args.end() || !section->has("type")) {
+                section->set("type", getMaskName(args));
+            }
+        }
+    }
+}
+
+uint32_t samplingIntervalMS = 20; //20 is default, the config can change it
+const std::string defaultConfigFileName = "Config/maya.ini";
+const double defaultSimulationDurationS = 60.0;
+
+//The default config of the tree that the executable was built in (Dist/<CONF>/Maya), 
+//so that it is found from any current directory
+std::string getDefaultConfigFileName() {
+    char exePath[PATH_MAX];
+    auto length = readlink("/proc/self/exe", exePath, sizeof (exePath) - 1);
+    if (length <= 0) {
+        return defaultConfigFileName;
+    }
+    std::string exeName(exePath, length);
+    return exeName.substr(0, exeName.rfind('/') + 1) + "../../" + defaultConfigFileName;
+}
+
+//Usage: ./maya [--config <config file>] --mode <Mode> [--idips <Sysid inputs>]
+//              [--mask <mask name> --ctldir <dir> --ctlfile <file prefix>]
+//              [--psample <power sampling interval in us>] [--exec <Serial|Pipelined>]
+//              [--workers <threads for planners and controllers>]
+//              [--backend <System|Simulate|Replay> --plant <plant file prefix> --trace <trace file>]
+//              [--duration <seconds>] [--sysroot <root of a fake sysfs tree>] [--seed <random seed>]
+//              [--packages <auto|number of packages>]
 
 int main(int argc, char** argv) {
     auto args = parseArgs(argc, argv);
-    auto mode = getMode(args);
+    std::string configFileName = getDefaultConfigFileName();
+    if (args.find("config") != args.end()) {
+        configFileName = args["config"];
+    }
+    Config config(configFileName);
+    auto managerSection = config.getSection("manager");
+    auto mode = getMode(args, managerSection);
+    auto backend = getBackend(args, managerSection);
 
-    //random seed
-    struct timeval time;
-    gettimeofday(&time, NULL);
-    srand((time.tv_sec * 1000) + (time.tv_usec / 1000));
+    //sysfs and devfs paths are resolved when the sensors and inputs are created, and the topology before that
+    Sensor::setSystemRoot(getSystemRoot(args, managerSection));
+
+    //one replica of each perPackage block per package, before the options refer to them
+    config.expandPerPackage(getNumPackages(args, managerSection, backend));
+    applyArgsToConfig(args, config, mode, backend);
+
+    //random seed, before any block takes a random stream
+    setRandomSeed(getSeed(args, managerSection, backend));
 
     //Create manager
+    if (managerSection != nullptr) {
+        samplingIntervalMS = managerSection->getUInt("samplingIntervalMS", samplingIntervalMS);
+    }
     Manager manager(samplingIntervalMS, mode);
- 
-    //add sensors
-    manager.addSensor(std::make_unique<Time>("Time"));
-    manager.addSensor(std::make_unique<CPUPowerSensor>("CPUPower"));
+    manager.setExecMode(getExecMode(args, managerSection));
+    manager.setNumWorkers(getNumWorkers(args, managerSection));
 
-    //add inputs
-    manager.addInput(std::make_unique<CPUFrequency>("CPUFreq"));
-    manager.addInput(std::make_unique<IdleInject>("IdlePct"));
-    manager.addInput(std::make_unique<PowerBalloon>("PBalloon"));
-
-    if (mode == Mode::Sysid) {
-        manager.addSysIdParams(getSysidNames(args));
-    } else if (mode == Mode::Mask) {
-        std::string ctlFileName(getCtlFilePrefix(args));
-        std::string dirPath(getCtlDir(args));
-        auto maskName = getMaskType(args);
-        uint32_t ctlPeriod = 1; //invoke controller at every sampling interval
-        uint32_t maskGenPeriod = 3; //invoke mask gen for every 3 invocations of the controller so that controller can converge.
-        manager.addController("MayaController",{"CPUPower"},
-        {
-            "CPUFreq", "IdlePct", "PBalloon"
-        },
-        ControllerType::SSV, dirPath, ctlFileName, ctlPeriod);
-
-        if (maskName == MaskGenType::Uniform) {
-            manager.addMaskGenerator("MayaMaskGenerator", "MayaController", maskName, 
-                    dirPath, ctlFileName,  maskGenPeriod * ctlPeriod, false);
-        } else {
-            manager.addMaskGenerator("MayaMaskGenerator", "MayaController", maskName, 
-                    dirPath, ctlFileName,  maskGenPeriod * ctlPeriod, true);
-        }
+    std::shared_ptr<PlantModel> plant;
+    std::shared_ptr<ReplayTrace> trace;
+    if (backend == Backend::Simulate) {
+        auto clock = std::make_shared<VirtualClock>();
+        plant = std::make_shared<PlantModel>(getPlantFilePrefix(args, managerSection), clock);
+        manager.useVirtualClock(clock);
+        manager.setRunDurationUS(getRunDurationUS(args, managerSection, defaultSimulationDurationS));
+    } else if (backend == Backend::Replay) {
+        //one row of the trace per sampling interval, until the trace ends
+        auto clock = std::make_shared<VirtualClock>();
+        trace = std::make_shared<ReplayTrace>(getTraceFileName(args, managerSection), clock, samplingIntervalMS * 1000);
+        manager.useVirtualClock(clock);
+        manager.setRunDurationUS(getRunDurationUS(args, managerSection, 0.0));
+        manager.setStopCondition([trace]() {
+            return trace->isFinished();
+        });
+    } else {
+        manager.setRunDurationUS(getRunDurationUS(args, managerSection, 0.0));
     }
 
+    //add sensors, inputs, controllers and planners
+    populateManager(manager, config, mode, plant, trace);
+
     manager.run();
     return 0;
 }
-
@@ -0,0 +1,153 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   ReplayTest.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * Checks that ReplayTrace finds the header of a log and replays its rows.
+ * Each case writes a log to a temporary directory. Some logs have messages
+ * before the header, such as the status line that Manager::run prints to
+ * stderr and that 2>&1 captures. The case then replays the log on a virtual
+ * clock and compares every column of every row with what was written.
+ *
+ * Run from anywhere. Prints one line per case and returns a failure if any
+ * case fails.
+ */
+
+#include "Replay.h"
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <unistd.h>
+
+uint32_t samplingIntervalMS = 20; //the planners read it, like in main
+
+namespace {
+
+const uint64_t intervalUS = 20000;
+
+struct LogCase {
+    std::string name;
+    std::vector<std::string> before; //lines written before the header
+    std::vector<std::string> columns;
+    std::vector<std::vector<double>> rows;
+    std::vector<std::string> between; //lines written after the first row
+};
+
+std::vector<double> makeRow(uint32_t k, uint32_t numColumns) {
+    std::vector<double> row;
+    for (uint32_t c = 0; c < numColumns; c++) {
+        row.push_back((k + 1) * 0.02 + 10.0 * c);
+    }
+    return row;
+}
+
+LogCase makeCase(std::string name, std::vector<std::string> before, std::vector<std::string> columns,
+        std::vector<std::string> between) {
+    LogCase log{name, before, columns, {}, between};
+    for (uint32_t k = 0; k < 5; k++) {
+        log.rows.push_back(makeRow(k, columns.size()));
+    }
+    return log;
+}
+
+void writeLog(const LogCase& log, std::string fileName) {
+    std::ofstream file(fileName);
+    for (auto& line : log.before) {
+        file << line << std::endl;
+    }
+    for (auto& column : log.columns) {
+        file << column << " ";
+    }
+    file << std::endl;
+    for (uint32_t k = 0; k < log.rows.size(); k++) {
+        for (auto value : log.rows[k]) {
+            file << value << " ";
+        }
+        file << std::endl;
+        if (k == 0) {
+            for (auto& line : log.between) {
+                file << line << std::endl;
+            }
+        }
+    }
+}
+
+//Returns an empty string if the log replays as written, else what went wrong
+std::string runCase(const LogCase& log, std::string dir) {
+    auto fileName = dir + "/" + log.name + ".log";
+    writeLog(log, fileName);
+    auto clock = std::make_shared<VirtualClock>();
+    ReplayTrace trace(fileName, clock, intervalUS);
+    std::vector<uint32_t> columns;
+    for (auto& name : log.columns) {
+        columns.push_back(trace.getColumn(name));
+        if (columns.back() == UINT32_MAX) {
+            return "no column " + name;
+        }
+    }
+    for (uint32_t k = 0; k < log.rows.size(); k++) {
+        clock->setTimeUS((k + 1) * intervalUS);
+        for (uint32_t c = 0; c < columns.size(); c++) {
+            if (std::fabs(trace.getValue(columns[c]) - log.rows[k][c]) > 1e-9) {
+                return "wrong value in row " + std::to_string(k) + ", column " + log.columns[c];
+            }
+        }
+        if (trace.isFinished()) {
+            return "finished at row " + std::to_string(k);
+        }
+    }
+    clock->setTimeUS((log.rows.size() + 1) * intervalUS);
+    if (!trace.isFinished()) {
+        return "not finished after the last row";
+    }
+    return "";
+}
+
+}
+
+int main() {
+    char dirTemplate[] = "/tmp/ReplayTestXXXXXX";
+    if (mkdtemp(dirTemplate) == nullptr) {
+        std::cerr << "Unable to create a temporary directory" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string dir(dirTemplate);
+
+    std::vector<std::string> tenColumns = {"Time", "CPUPower", "CPUFreq", "IdlePct", "PBalloon",
+        "CPUPower1", "CPUFreq1", "IdlePct1", "PBalloon1", "Target"};
+    std::vector<LogCase> logs = {
+        makeCase("HeaderFirst", {}, {"Time", "CPUPower", "CPUFreq"}, {}),
+        //the status line of Manager::run has as many words as this header has names
+        makeCase("StatusLine", {"Pipelined execution is not supported with virtual time, using Serial"}, tenColumns, {}),
+        makeCase("MixedLines", {"Starting", "1 2", "Using the Simulate backend"}, {"Time", "CPUPower", "CPUFreq"},
+            {"Maya wrote a message", "1 2 x"})
+    };
+
+    bool failed = false;
+    for (auto& log : logs) {
+        auto error = runCase(log, dir);
+        failed = failed || !error.empty();
+        std::cout << (error.empty() ? "PASS " : "FAIL ") << log.name << (error.empty() ? "" : ": " + error) << std::endl;
+    }
+    std::system(("rm -rf " + dir).c_str());
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,230 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   SystemIdTest.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * Checks that the model written by the system identifier means what the ARX
+ * model it fitted means. Noise-free data from a known ARX system is fed to the
+ * SystemIdentifier, the model is written to plant files, reloaded through
+ * PlantModel and simulated for a step of each input from the operating point.
+ * The response must follow the ARX recursion of the known system, step by step,
+ * for each output. Cases cover several outputs and inputs and several output
+ * and input lags, so that every block of A, B and C is used.
+ *
+ * Run from anywhere; the model files go to a temporary directory. Prints one
+ * line per case and returns a failure if any case fails.
+ */
+
+#include "SystemId.h"
+#include "Simulation.h"
+#include "Random.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <unistd.h>
+
+uint32_t samplingIntervalMS = 20; //the planners read it, like in main
+
+namespace {
+
+const uint32_t periodUS = 20000;
+const uint32_t trainingPeriods = 4000;
+const uint32_t responsePeriods = 40;
+const double tolerance = 1e-3; //of the size of the largest step response
+
+//y[k] = sum of a[i] y[k-1-i] + sum of b[i] u[k-i] + c, with a[i] numOutputs x numOutputs and b[i] numOutputs x numInputs
+struct ARXSystem {
+    std::string name;
+    uint32_t numOutputs, numInputs, na, nb;
+    std::vector<std::vector<double>> a, b; //a[i][o * numOutputs + q], b[i][o * numInputs + j]
+    std::vector<double> c, inputMin, inputMax;
+};
+
+class ARXRecursion {
+public:
+    ARXRecursion(const ARXSystem& system) : system(system),
+    pastOutputs(system.na, std::vector<double>(system.numOutputs, 0.0)),
+    pastInputs(system.nb, std::vector<double>(system.numInputs, 0.0)) {
+    }
+
+    //fill the past with a steady state at the inputs u
+    void settle(const std::vector<double>& u) {
+        for (uint32_t k = 0; k < 100 * (system.na + system.nb); k++) {
+            step(u);
+        }
+    }
+
+    std::vector<double> step(const std::vector<double>& u) {
+        pastInputs.insert(pastInputs.begin(), u);
+        pastInputs.pop_back();
+        std::vector<double> y(system.c);
+        for (uint32_t o = 0; o < system.numOutputs; o++) {
+            for (uint32_t i = 0; i < system.na; i++) {
+                for (uint32_t q = 0; q < system.numOutputs; q++) {
+                    y[o] += system.a[i][o * system.numOutputs + q] * pastOutputs[i][q];
+                }
+            }
+            for (uint32_t i = 0; i < system.nb; i++) {
+                for (uint32_t j = 0; j < system.numInputs; j++) {
+                    y[o] += system.b[i][o * system.numInputs + j] * pastInputs[i][j];
+                }
+            }
+        }
+        pastOutputs.insert(pastOutputs.begin(), y);
+        pastOutputs.pop_back();
+        return y;
+    }
+
+private:
+    const ARXSystem& system;
+    std::vector<std::vector<double>> pastOutputs, pastInputs; //newest first
+};
+
+std::vector<std::string> makeNames(std::string prefix, uint32_t count) {
+    std::vector<std::string> names;
+    for (uint32_t i = 0; i < count; i++) {
+        names.push_back(prefix + std::to_string(i));
+    }
+    return names;
+}
+
+std::vector<double> middle(const ARXSystem& system) {
+    std::vector<double> u;
+    for (uint32_t j = 0; j < system.numInputs; j++) {
+        u.push_back((system.inputMin[j] + system.inputMax[j]) / 2.0);
+    }
+    return u;
+}
+
+//Identify the system, write its model and compare the step responses. Returns the largest error, 
+//relative to the largest response
+double runCase(const ARXSystem& system, std::string dir) {
+    auto outputNames = makeNames("Output", system.numOutputs);
+    auto inputNames = makeNames("Input", system.numInputs);
+    std::vector<uint32_t> inputLevels(system.numInputs, 0);
+    SystemIdentifier identifier(outputNames, inputNames, system.inputMin, system.inputMax, inputLevels, periodUS,
+            system.na, system.nb);
+
+    //random inputs held for random periods, like the Random excitation
+    std::mt19937 random(1);
+    ARXRecursion training(system);
+    auto u = middle(system);
+    training.settle(u);
+    std::vector<uint32_t> hold(system.numInputs, 0);
+    for (uint32_t k = 0; k < trainingPeriods; k++) {
+        for (uint32_t j = 0; j < system.numInputs; j++) {
+            if (hold[j] == 0) {
+                u[j] = std::uniform_real_distribution<double>(system.inputMin[j], system.inputMax[j])(random);
+                hold[j] = std::uniform_int_distribution<uint32_t>(1, 8)(random);
+            }
+            hold[j]--;
+        }
+        auto y = training.step(u);
+        identifier.outputVals->receiveValues(Vector(y));
+        identifier.inputVals->receiveValues(Vector(u));
+        identifier.update();
+    }
+    auto prefix = dir + "/" + system.name;
+    if (!identifier.writeModel(prefix)) {
+        return INFINITY;
+    }
+
+    //a step of each input from the operating point (the middle of the ranges) in turn
+    double maxError = 0.0, maxResponse = 0.0;
+    for (uint32_t stepInput = 0; stepInput < system.numInputs; stepInput++) {
+        auto clock = std::make_shared<VirtualClock>();
+        PlantModel plant(prefix, clock);
+        ARXRecursion reference(system);
+        auto u0 = middle(system);
+        reference.settle(u0);
+        auto y0 = reference.step(u0);
+        auto stepped = u0;
+        stepped[stepInput] += 0.25 * (system.inputMax[stepInput] - system.inputMin[stepInput]);
+        plant.setInput(plant.getInputIndex(inputNames[stepInput]), stepped[stepInput]);
+        for (uint32_t k = 1; k <= responsePeriods; k++) {
+            clock->setTimeUS(k * periodUS);
+            auto expected = reference.step(stepped);
+            for (uint32_t o = 0; o < system.numOutputs; o++) {
+                auto simulated = plant.getOutput(plant.getOutputIndex(outputNames[o]));
+                maxError = std::max(maxError, std::fabs(simulated - expected[o]));
+                maxResponse = std::max(maxResponse, std::fabs(expected[o] - y0[o]));
+            }
+        }
+    }
+    return maxError / maxResponse;
+}
+
+}
+
+int main() {
+    setRandomSeed(1);
+    char dirTemplate[] = "/tmp/SystemIdTestXXXXXX";
+    if (mkdtemp(dirTemplate) == nullptr) {
+        std::cerr << "Unable to create a temporary directory" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string dir(dirTemplate);
+
+    std::vector<ARXSystem> systems = {
+        //like the example plant: power from frequency and idle injection
+        {"MISOLags", 1, 2, 2, 2,
+            {
+                {0.5}, {0.2}
+            },
+            {
+                {1.0e-5, -0.05}, {0.4e-5, -0.02}
+            },
+            {2.0},
+            {1.2e6, 0.0}, {2.4e6, 48.0}},
+        //coupled outputs and three input lags
+        {"MIMO", 2, 1, 1, 3,
+            {
+                {0.6, 0.1, -0.2, 0.3}
+            },
+            {
+                {0.5, -0.1}, {0.2, 0.3}, {0.1, 0.05}
+            },
+            {1.0, -3.0},
+            {0.0}, {20.0}},
+        //no input lags: the state is the outputs alone and D carries the inputs
+        {"OutputsOnly", 3, 2, 1, 1,
+            {
+                {0.5, 0.0, 0.1, 0.0, 0.4, 0.0, 0.2, 0.0, 0.3}
+            },
+            {
+                {1.0, 0.0, 0.0, 2.0, 0.5, -0.5}
+            },
+            {0.0, 1.0, 2.0},
+            {0.0, 0.0}, {10.0, 10.0}}
+    };
+
+    bool failed = false;
+    for (auto& system : systems) {
+        auto error = runCase(system, dir);
+        bool passed = error < tolerance;
+        failed = failed || !passed;
+        std::cout << (passed ? "PASS " : "FAIL ") << system.name << ": na " << system.na << ", nb " << system.nb <<
+                ", relative step response error " << error << std::endl;
+    }
+    std::system(("rm -rf " + dir).c_str());
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
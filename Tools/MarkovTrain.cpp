@@ -0,0 +1,256 @@
+/*
+ * ================================================================================
+ * Copyright 2021 University of Illinois Board of Trustees. All Rights Reserved.
+ * Licensed under the terms of the University of Illinois/NCSA Open Source License
+ * (the "License"). You may not use this file except in compliance with the License.
+ * The License is included in the distribution as License.txt file.
+ *
+ * Software distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations
+ * under the License.
+ * ================================================================================
+ */
+
+/*
+ * File:   MarkovTrain.cpp
+ * Author: Raghavendra Pradyumna Pothukuchi and Sweta Yamini Pothukuchi
+ */
+
+/*
+ * Learns the Markov chain of a Markov mask (see Include/MarkovChain.h) from
+ * Maya logs of real applications, e.g., recorded with --mode Baseline.
+ *
+ * The chosen columns (one per output of the controller, in its order) are
+ * averaged over blocks of --step rows (the period of the mask generator in
+ * sampling intervals) and every column is quantized into --levels levels with
+ * equal numbers of samples. Each combination of levels that occurs is a state;
+ * its targets are the mean and standard deviation of the samples in it, and
+ * the transitions are counted between consecutive blocks. The last block of a
+ * log goes back to its first one so that every state has a next state.
+ *
+ * Usage: ./MarkovTrain --log <log file>[,<log file>...] --columns <column>[,<column>...]
+ *                      --out <controller dir>/<controller file prefix>
+ *                      [--levels <levels per column, default 8>] [--step <rows, default 1>]
+ *                      [--skip <rows to drop at the start of each log, default 0>]
+ */
+
+#include "LogHeader.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+void usage(char* program) {
+    std::cout << "Usage: " << program << " --log <log file>[,<log file>...] --columns <column>[,<column>...]"
+            " --out <file prefix> [--levels <levels per column>] [--step <rows>] [--skip <rows>]" << std::endl;
+    std::exit(EXIT_FAILURE);
+}
+
+std::map<std::string, std::string> parseArgs(int argc, char **argv) {
+    std::map<std::string, std::string> args;
+    if (argc == 1) {
+        usage(argv[0]);
+    }
+    for (auto i = 1; i < argc; i++) {
+        std::string word(argv[i]);
+        if (word.compare(0, 2, "--") != 0 || i + 1 >= argc) {
+            usage(argv[0]);
+        }
+        args[word.substr(2)] = argv[++i];
+    }
+    return args;
+}
+
+std::vector<std::string> splitList(std::string list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+std::string getArg(std::map<std::string, std::string>& args, std::string name) {
+    if (args.find(name) == args.end()) {
+        std::cout << "--" << name << " is required" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return args[name];
+}
+
+//Reads the given columns of a Maya log, averaged over blocks of step rows.
+//The header is found by LogHeader; lines that are not rows of numbers are skipped.
+std::vector<std::vector<double>> readLog(std::string fileName, std::vector<std::string> columns, uint32_t step, uint32_t skip) {
+    std::ifstream file(fileName);
+    if (!file) {
+        std::cerr << "Unable to open " << fileName << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    LogHeader logHeader;
+    std::vector<std::string> header;
+    std::vector<uint32_t> columnIndices;
+    std::vector<std::vector<double>> blocks;
+    std::vector<double> sums(columns.size(), 0.0);
+    uint32_t rowsInBlock = 0, rowsSeen = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        auto tokens = splitLogLine(line.data(), line.data() + line.size());
+        if (header.empty()) {
+            if (!logHeader.addLine(tokens)) {
+                continue;
+            }
+            //this line is the first row
+            header = logHeader.getNames();
+            for (auto& column : columns) {
+                auto it = std::find(header.begin(), header.end(), column);
+                if (it == header.end()) {
+                    std::cout << fileName << " has no column " << column << std::endl;
+                    std::exit(EXIT_FAILURE);
+                }
+                columnIndices.push_back(it - header.begin());
+            }
+        }
+        if (tokens.size() != header.size() || !std::all_of(tokens.begin(), tokens.end(), isLogNumber)) {
+            continue;
+        }
+        if (rowsSeen++ < skip) {
+            continue;
+        }
+        for (uint32_t c = 0; c < columns.size(); c++) {
+            sums[c] += std::stod(tokens[columnIndices[c]]);
+        }
+        if (++rowsInBlock == step) {
+            std::vector<double> block(columns.size());
+            for (uint32_t c = 0; c < columns.size(); c++) {
+                block[c] = sums[c] / step;
+                sums[c] = 0.0;
+            }
+            blocks.push_back(block);
+            rowsInBlock = 0;
+        }
+    }
+    if (header.empty()) {
+        std::cout << fileName << " has no header line followed by rows of numbers" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return blocks;
+}
+
+void writeRows(std::string fileName, const std::vector<std::vector<double>>& rows) {
+    std::ofstream file(fileName);
+    if (!file) {
+        std::cerr << "Unable to open " << fileName << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    file << std::setprecision(10);
+    for (auto& row : rows) {
+        for (uint32_t i = 0; i < row.size(); i++) {
+            file << (i > 0 ? " " : "") << row[i];
+        }
+        file << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    auto args = parseArgs(argc, argv);
+    auto logs = splitList(getArg(args, "log"));
+    auto columns = splitList(getArg(args, "columns"));
+    auto outPrefix = getArg(args, "out");
+    uint32_t levels = std::stoul(args.count("levels") ? args["levels"] : "8");
+    uint32_t step = std::stoul(args.count("step") ? args["step"] : "1");
+    uint32_t skip = std::stoul(args.count("skip") ? args["skip"] : "0");
+    if (logs.empty() || columns.empty() || levels == 0 || step == 0) {
+        std::cout << "Give at least one log and column, and levels and step > 0" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::vector<std::vector<std::vector<double>>> logBlocks;
+    std::vector<std::vector<double>> columnValues(columns.size());
+    for (auto& log : logs) {
+        logBlocks.push_back(readLog(log, columns, step, skip));
+        for (auto& block : logBlocks.back()) {
+            for (uint32_t c = 0; c < columns.size(); c++) {
+                columnValues[c].push_back(block[c]);
+            }
+        }
+    }
+    if (columnValues[0].size() < 2) {
+        std::cout << "The logs have fewer than 2 blocks of " << step << " rows" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    //upper edges of the levels of each column, at its quantiles
+    std::vector<std::vector<double>> edges(columns.size());
+    for (uint32_t c = 0; c < columns.size(); c++) {
+        auto sorted = columnValues[c];
+        std::sort(sorted.begin(), sorted.end());
+        for (uint32_t l = 1; l < levels; l++) {
+            edges[c].push_back(sorted[(sorted.size() * l) / levels]);
+        }
+    }
+
+    //states are numbered in the order they first occur
+    std::map<std::vector<uint32_t>, uint32_t> stateIds;
+    std::vector<std::vector<uint32_t>> logStates(logBlocks.size());
+    for (uint32_t log = 0; log < logBlocks.size(); log++) {
+        for (auto& block : logBlocks[log]) {
+            std::vector<uint32_t> key(columns.size());
+            for (uint32_t c = 0; c < columns.size(); c++) {
+                key[c] = std::upper_bound(edges[c].begin(), edges[c].end(), block[c]) - edges[c].begin();
+            }
+            auto it = stateIds.find(key);
+            if (it == stateIds.end()) {
+                it = stateIds.emplace(key, stateIds.size()).first;
+            }
+            logStates[log].push_back(it->second);
+        }
+    }
+
+    auto numStates = stateIds.size();
+    std::vector<std::vector<double>> means(numStates, std::vector<double>(columns.size(), 0.0));
+    std::vector<std::vector<double>> stddevs(numStates, std::vector<double>(columns.size(), 0.0));
+    std::vector<std::vector<double>> transitions(numStates, std::vector<double>(numStates, 0.0));
+    std::vector<uint64_t> visits(numStates, 0);
+    for (uint32_t log = 0; log < logBlocks.size(); log++) {
+        auto& states = logStates[log];
+        for (uint32_t b = 0; b < states.size(); b++) {
+            visits[states[b]]++;
+            for (uint32_t c = 0; c < columns.size(); c++) {
+                means[states[b]][c] += logBlocks[log][b][c];
+                stddevs[states[b]][c] += logBlocks[log][b][c] * logBlocks[log][b][c];
+            }
+            transitions[states[b]][states[(b + 1) % states.size()]] += 1.0;
+        }
+    }
+    for (uint32_t s = 0; s < numStates; s++) {
+        double total = 0.0;
+        for (auto count : transitions[s]) {
+            total += count;
+        }
+        for (auto& count : transitions[s]) {
+            count /= total;
+        }
+        for (uint32_t c = 0; c < columns.size(); c++) {
+            means[s][c] /= visits[s];
+            stddevs[s][c] = std::sqrt(std::max(0.0, stddevs[s][c] / visits[s] - means[s][c] * means[s][c]));
+        }
+    }
+
+    writeRows(outPrefix + "_markovStates.txt", means);
+    writeRows(outPrefix + "_markovStddev.txt", stddevs);
+    writeRows(outPrefix + "_markovTransitions.txt", transitions);
+    std::cout << "Learned " << numStates << " states from " << columnValues[0].size() << " blocks of "
+            << step << " rows in " << logs.size() << " log(s)" << std::endl;
+    return 0;
+}